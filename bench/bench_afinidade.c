@@ -0,0 +1,265 @@
+/*
+ * bench_afinidade.c - Latencia de atendimento com e sem afinidade de CPU
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_afinidade [taxa=2000] [segundos=2] [ruido=numero de CPUs]
+ *
+ * A thread principal faz o papel do mural: publica modulos com
+ * tempo_resolucao 0 em prazos absolutos a 'taxa' modulos/s, e MAX_TEDAX_MENU
+ * tedax autonomos os atendem. Enquanto isso, 'ruido' threads giram sem
+ * parar, como os outros usuarios de uma maquina compartilhada. Mede os
+ * percentis da espera na fila (entrada -> tedax assume).
+ *
+ *   livre    nenhuma thread fixada
+ *   fixado   mural e tedax fixados (--afinidade); o ruido continua livre
+ *   isolado  como fixado, e o ruido fica restrito as outras CPUs (cpuset)
+ *
+ * O motor usa as ultimas CPUs do processo: a primeira delas para o mural,
+ * as demais para os tedax. Com uma so CPU todos os modos dividem a mesma.
+ */
+
+#define _GNU_SOURCE
+#include "../include/tipos.h"
+#include "../include/jogo.h"
+#include "../include/modulos.h"
+#include "../include/tedax.h"
+#include "../include/bancada.h"
+#include "../include/pool_modulos.h"
+#include "../include/aleatorio.h"
+#include "../include/metricas.h"
+#include "../include/afinidade.h"
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define TAXA_PADRAO 2000.0
+#define SEGUNDOS_PADRAO 2
+#define MAX_RUIDO 256
+#define CAPACIDADE_BENCH (1 << 16)
+#define TIMEOUT_ESVAZIAR_NS 10000000000LL
+
+typedef enum { MODO_LIVRE = 0, MODO_FIXADO, MODO_ISOLADO } ModoBench;
+static const char* nomes_modos[] = { "livre", "fixado", "isolado" };
+
+static EstadoJogoCompleto estado;
+static GeradorAleatorio gerador;
+static atomic_bool ruido_ativo;
+
+typedef struct {
+    long modulos;
+    long long p50, p90, p99, p999, max;
+} Resultado;
+
+/* Gira sem ceder a CPU ate o fim da medicao */
+static void* thread_ruido(void* arg) {
+    (void)arg;
+    while (atomic_load_explicit(&ruido_ativo, memory_order_relaxed)) {
+    }
+    return NULL;
+}
+
+static uint64_t cpus_do_processo(void) {
+    cpu_set_t conjunto;
+    uint64_t mascara = 0;
+    if (sched_getaffinity(0, sizeof(conjunto), &conjunto) != 0) return 1;
+    for (int cpu = 0; cpu < 64; cpu++) {
+        if (CPU_ISSET(cpu, &conjunto)) mascara |= 1ULL << cpu;
+    }
+    return mascara;
+}
+
+/* Ultimas CPUs para o motor: mural na primeira delas, tedax nas seguintes */
+static void dividir_cpus(uint64_t processo, uint64_t* mural, uint64_t* tedax, uint64_t* ruido) {
+    int cpus[64], n = 0;
+    for (int cpu = 0; cpu < 64; cpu++) {
+        if (processo & (1ULL << cpu)) cpus[n++] = cpu;
+    }
+    int motor = n / 2;
+    if (motor > MAX_TEDAX_MENU + 1) motor = MAX_TEDAX_MENU + 1;
+    if (motor < 1) motor = 1;
+
+    *mural = *tedax = *ruido = 0;
+    *mural = 1ULL << cpus[n - motor];
+    for (int i = n - motor + 1; i < n; i++) *tedax |= 1ULL << cpus[i];
+    if (*tedax == 0) *tedax = *mural;
+    for (int i = 0; i < n - motor; i++) *ruido |= 1ULL << cpus[i];
+    if (*ruido == 0) *ruido = processo;
+}
+
+static void listar(uint64_t mascara, char* texto, size_t tam) {
+    size_t pos = 0;
+    texto[0] = '\0';
+    for (int cpu = 0; cpu < 64 && pos < tam; cpu++) {
+        if (mascara & (1ULL << cpu)) pos += snprintf(texto + pos, tam - pos, "%s%d", pos ? "," : "", cpu);
+    }
+}
+
+/* Posicionamento real de uma thread (nome e mascara lidos de volta) */
+static void relatar_thread(pthread_t thread) {
+    char nome[16] = "?", lista[256];
+    cpu_set_t conjunto;
+    uint64_t mascara = 0;
+    pthread_getname_np(thread, nome, sizeof(nome));
+    if (pthread_getaffinity_np(thread, sizeof(conjunto), &conjunto) == 0) {
+        for (int cpu = 0; cpu < 64; cpu++) {
+            if (CPU_ISSET(cpu, &conjunto)) mascara |= 1ULL << cpu;
+        }
+    }
+    listar(mascara, lista, sizeof(lista));
+    printf("  %-15s CPUs %s\n", nome, lista);
+}
+
+static bool publicar_modulo(void) {
+    ModuloHandle h = pool_modulos_alocar();
+    if (h == MODULO_HANDLE_NULO) return false;
+    Modulo* m = pool_modulos_obter(h);
+    gerar_modulo_aleatorio(&gerador, m, estado.proximo_id_modulo++, 1);
+    m->tempo_resolucao = 0;
+    if (!fila_modulos_adicionar(&estado.fila_modulos, h)) {
+        pool_modulos_liberar(h);
+        return false;
+    }
+    return true;
+}
+
+static int desarmados(void) {
+    Estatisticas stats;
+    jogo_somar_contadores(&estado, &stats);
+    return stats.modulos_desarmados;
+}
+
+static Resultado medir(ModoBench modo, double taxa, int segundos, int num_ruido, bool relatar) {
+    uint64_t processo = cpus_do_processo();
+    uint64_t cpus_mural, cpus_tedax, cpus_ruido;
+    dividir_cpus(processo, &cpus_mural, &cpus_tedax, &cpus_ruido);
+
+    ConfigJogo config = config_padrao();
+    config.num_tedax = MAX_TEDAX_MENU;
+    config.num_bancadas = MAX_TEDAX_MENU;
+    config.capacidade_fila = CAPACIDADE_BENCH;
+    config.tedax_autonomos = true;
+    if (modo != MODO_LIVRE) {
+        config.afinidade[PAPEL_MURAL] = cpus_mural;
+        config.afinidade[PAPEL_TEDAX] = cpus_tedax;
+    }
+    if (jogo_init(&estado, &config) != 0) {
+        fprintf(stderr, "Falha ao iniciar o jogo\n");
+        exit(1);
+    }
+    jogo = &estado;
+    estado.estado = JOGO_RODANDO;
+    aleatorio_semear(&gerador, 42, FLUXO_MURAL);
+
+    /* Ruido: threads com a mascara do processo ou, isolado, so com as outras CPUs */
+    pthread_t ruido[MAX_RUIDO];
+    pthread_attr_t attr;
+    cpu_set_t conjunto;
+    CPU_ZERO(&conjunto);
+    uint64_t mascara_ruido = modo == MODO_ISOLADO ? cpus_ruido : processo;
+    for (int cpu = 0; cpu < 64; cpu++) {
+        if (mascara_ruido & (1ULL << cpu)) CPU_SET(cpu, &conjunto);
+    }
+    pthread_attr_init(&attr);
+    pthread_attr_setaffinity_np(&attr, sizeof(conjunto), &conjunto);
+    atomic_store(&ruido_ativo, true);
+    for (int i = 0; i < num_ruido; i++) pthread_create(&ruido[i], &attr, thread_ruido, NULL);
+    pthread_attr_destroy(&attr);
+
+    /* A principal e o mural; fora do modo livre volta a todas as CPUs se nao fixada */
+    afinidade_aplicar(pthread_self(), &config, PAPEL_MURAL, NULL);
+    for (int i = 0; i < MAX_TEDAX_MENU; i++) tedax_iniciar_thread(&estado.tedax[i]);
+
+    if (relatar) {
+        printf("%s:\n", nomes_modos[modo]);
+        relatar_thread(pthread_self());
+        for (int i = 0; i < MAX_TEDAX_MENU; i++) relatar_thread(estado.tedax[i].thread);
+        if (num_ruido > 0) {
+            char lista[256];
+            listar(mascara_ruido, lista, sizeof(lista));
+            printf("  %-15s CPUs %s (%d threads)\n", "ruido", lista, num_ruido);
+        }
+    }
+
+    long long intervalo = (long long)(1e9 / taxa);
+    long long inicio = relogio_ns();
+    int gerados = 0;
+    for (long long prazo = inicio; prazo < inicio + segundos * 1000000000LL; prazo += intervalo) {
+        struct timespec ts = timespec_de_ns(prazo);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        if (publicar_modulo()) gerados++;
+    }
+    long long limite = relogio_ns() + TIMEOUT_ESVAZIAR_NS;
+    while (desarmados() < gerados && relogio_ns() < limite) usleep(1000);
+
+    atomic_store(&ruido_ativo, false);
+    for (int i = 0; i < num_ruido; i++) pthread_join(ruido[i], NULL);
+
+    pthread_mutex_lock(&estado.mutex_estado);
+    estado.executando = false;
+    pthread_cond_broadcast(&estado.cond_estado);
+    pthread_mutex_unlock(&estado.mutex_estado);
+    fila_modulos_despertar(&estado.fila_modulos);
+
+    HistogramaLatencia total;
+    histograma_zerar(&total);
+    for (int i = 0; i < MAX_TEDAX_MENU; i++) {
+        tedax_parar_thread(&estado.tedax[i]);
+        histograma_somar(&total, &estado.tedax[i].latencia_fila);
+    }
+    Resultado r;
+    r.modulos = total.total;
+    r.p50 = histograma_percentil(&total, 50);
+    r.p90 = histograma_percentil(&total, 90);
+    r.p99 = histograma_percentil(&total, 99);
+    r.p999 = histograma_percentil(&total, 99.9);
+    r.max = histograma_percentil(&total, 100);
+
+    fila_modulos_limpar(&estado.fila_modulos);
+    jogo_liberar_elementos(&estado);
+    fila_modulos_destroy(&estado.fila_modulos);
+    pool_modulos_devolver_cache();
+    pool_modulos_destroy();
+    pthread_mutex_destroy(&estado.mutex_estado);
+    pthread_mutex_destroy(&estado.mutex_display);
+    pthread_mutex_destroy(&estado.mutex_comando);
+    pthread_cond_destroy(&estado.cond_fim_jogo);
+    pthread_cond_destroy(&estado.cond_estado);
+    jogo = NULL;
+    return r;
+}
+
+int main(int argc, char* argv[]) {
+    double taxa = argc > 1 ? atof(argv[1]) : TAXA_PADRAO;
+    int segundos = argc > 2 ? atoi(argv[2]) : SEGUNDOS_PADRAO;
+    int num_ruido = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (taxa <= 0) taxa = TAXA_PADRAO;
+    if (segundos < 1) segundos = SEGUNDOS_PADRAO;
+    if (num_ruido < 0 || num_ruido > MAX_RUIDO) num_ruido = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    ConfigJogo exemplo = config_padrao();
+    uint64_t mural, tedax, ruido;
+    dividir_cpus(cpus_do_processo(), &mural, &tedax, &ruido);
+    exemplo.afinidade[PAPEL_MURAL] = mural;
+    exemplo.afinidade[PAPEL_TEDAX] = tedax;
+    afinidade_relatorio(stdout, &exemplo);
+
+    printf("\n=== %d tedax autonomos, %.0f modulos/s por %d s, %d threads de ruido ===\n",
+           MAX_TEDAX_MENU, taxa, segundos, num_ruido);
+    Resultado resultados[3];
+    for (int modo = MODO_LIVRE; modo <= MODO_ISOLADO; modo++) {
+        resultados[modo] = medir((ModoBench)modo, taxa, segundos, num_ruido, true);
+    }
+
+    printf("\n%-8s %9s %10s %10s %10s %11s %10s\n", "modo", "modulos", "p50 (us)", "p90 (us)",
+           "p99 (us)", "p99.9 (us)", "max (us)");
+    for (int modo = MODO_LIVRE; modo <= MODO_ISOLADO; modo++) {
+        Resultado* r = &resultados[modo];
+        printf("%-8s %9ld %10.1f %10.1f %10.1f %11.1f %10.1f\n", nomes_modos[modo], r->modulos,
+               r->p50 / 1e3, r->p90 / 1e3, r->p99 / 1e3, r->p999 / 1e3, r->max / 1e3);
+    }
+    return 0;
+}
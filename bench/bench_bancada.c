@@ -0,0 +1,199 @@
+/*
+ * bench_bancada.c - Espera por bancada: laco antigo x fila com entrega direta
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_bancada [threads=8] [segundos=2]
+ *
+ * Varias threads disputam uma unica bancada: ocupam, seguram por
+ * POSSE_NS, liberam e pensam por PENSAR_NS antes de tentar de novo.
+ *
+ *   antiga  bancada_ocupar; se falhar, bancada_aguardar_livre(500 ms) e
+ *           usleep(50 ms), como o tedax fazia antes da fila
+ *   fila    bancada_entrar_fila + bancada_aguardar_vez (entrega direta)
+ *
+ * Reporta o intervalo ocioso (liberacao com alguem esperando -> proximo
+ * dono comeca), a espera de cada aquisicao e a justica (menor e maior
+ * numero de aquisicoes por thread).
+ */
+
+#include "../include/tipos.h"
+#include "../include/bancada.h"
+#include "../include/metricas.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define THREADS_PADRAO 8
+#define SEGUNDOS_PADRAO 2
+#define MAX_THREADS 64
+#define POSSE_NS 1000000LL      /* 1 ms com a bancada */
+#define PENSAR_NS 200000LL      /* 0,2 ms entre uma posse e a proxima */
+
+typedef struct {
+    int id;
+    bool fila;                  /* Estrategia: fila ou laco antigo */
+    long aquisicoes;
+    HistogramaLatencia espera;
+    HistogramaLatencia ocioso;
+    EsperaBancada lugar;
+} Participante;
+
+typedef struct {
+    long aquisicoes;
+    long min_thread, max_thread;
+    HistogramaLatencia espera;
+    HistogramaLatencia ocioso;
+} Resultado;
+
+static Bancada bancada;
+static atomic_bool rodando;
+static atomic_int querendo;     /* Threads tentando ocupar a bancada */
+
+/* Escritos so pelo dono da bancada; o mutex da bancada ordena os acessos */
+static long long liberada_ns;
+static bool liberada_com_espera;
+
+static void dormir_ns(long long ns) {
+    long long prazo = relogio_ns() + ns;
+    struct timespec ts = { prazo / 1000000000LL, prazo % 1000000000LL };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static bool ocupar_antiga(Participante* p) {
+    while (atomic_load(&rodando)) {
+        if (bancada_ocupar(&bancada, p->id, MODULO_HANDLE_NULO)) return true;
+        bancada_aguardar_livre(&bancada, 500);
+        usleep(50000); /* Pausa para evitar starvation */
+    }
+    return false;
+}
+
+static bool ocupar_fila(Participante* p) {
+    bancada_entrar_fila(&bancada, &p->lugar);
+    while (atomic_load(&rodando)) {
+        if (bancada_aguardar_vez(&bancada, &p->lugar, 50)) break;
+    }
+    return bancada_sair_fila(&bancada, &p->lugar);
+}
+
+static void* thread_participante(void* arg) {
+    Participante* p = (Participante*)arg;
+
+    while (atomic_load(&rodando)) {
+        long long inicio = relogio_ns();
+        atomic_fetch_add(&querendo, 1);
+        bool ok = p->fila ? ocupar_fila(p) : ocupar_antiga(p);
+        atomic_fetch_sub(&querendo, 1);
+
+        long long agora = relogio_ns();
+        if (ok) {
+            histograma_registrar(&p->espera, agora - inicio);
+            if (liberada_com_espera) histograma_registrar(&p->ocioso, agora - liberada_ns);
+            p->aquisicoes++;
+
+            dormir_ns(POSSE_NS);
+
+            liberada_com_espera = atomic_load(&querendo) > 0;
+            liberada_ns = relogio_ns();
+            bancada_liberar(&bancada, p->id);
+        }
+        dormir_ns(PENSAR_NS);
+    }
+    return NULL;
+}
+
+static Resultado medir(bool fila, int num_threads, int segundos) {
+    static Participante participantes[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    Resultado r = { 0 };
+
+    bancada_init(&bancada, 0);
+    liberada_ns = 0;
+    liberada_com_espera = false;
+    atomic_store(&querendo, 0);
+    atomic_store(&rodando, true);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    for (int i = 0; i < num_threads; i++) {
+        Participante* p = &participantes[i];
+        p->id = i;
+        p->fila = fila;
+        p->aquisicoes = 0;
+        histograma_zerar(&p->espera);
+        histograma_zerar(&p->ocioso);
+        p->lugar.tedax_id = i;
+        p->lugar.modulo = MODULO_HANDLE_NULO;
+        p->lugar.executor = NULL;
+        p->lugar.tarefa = NULL;
+        p->lugar.prox = NULL;
+        pthread_cond_init(&p->lugar.cond, &attr);
+    }
+    pthread_condattr_destroy(&attr);
+
+    for (int i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, thread_participante, &participantes[i]);
+    }
+    sleep(segundos);
+    atomic_store(&rodando, false);
+
+    /* Acorda quem esta em bancada_aguardar_livre */
+    pthread_mutex_lock(&bancada.mutex);
+    pthread_cond_broadcast(&bancada.cond_livre);
+    pthread_mutex_unlock(&bancada.mutex);
+
+    histograma_zerar(&r.espera);
+    histograma_zerar(&r.ocioso);
+    r.min_thread = -1;
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+        Participante* p = &participantes[i];
+        histograma_somar(&r.espera, &p->espera);
+        histograma_somar(&r.ocioso, &p->ocioso);
+        r.aquisicoes += p->aquisicoes;
+        if (r.min_thread < 0 || p->aquisicoes < r.min_thread) r.min_thread = p->aquisicoes;
+        if (p->aquisicoes > r.max_thread) r.max_thread = p->aquisicoes;
+        pthread_cond_destroy(&p->lugar.cond);
+    }
+    bancada_destroy(&bancada);
+    return r;
+}
+
+static void imprimir(const char* modo, const char* medida, const HistogramaLatencia* h) {
+    printf("%-7s %-8s %9ld %10.1f %10.1f %10.1f %10.1f\n", modo, medida, h->total,
+           histograma_percentil(h, 50) / 1e3, histograma_percentil(h, 90) / 1e3,
+           histograma_percentil(h, 99) / 1e3, histograma_percentil(h, 100) / 1e3);
+}
+
+int main(int argc, char* argv[]) {
+    int num_threads = argc > 1 ? atoi(argv[1]) : THREADS_PADRAO;
+    int segundos = argc > 2 ? atoi(argv[2]) : SEGUNDOS_PADRAO;
+    if (num_threads < 1 || num_threads > MAX_THREADS) num_threads = THREADS_PADRAO;
+    if (segundos < 1) segundos = SEGUNDOS_PADRAO;
+
+    printf("=== %d threads, 1 bancada, posse %.1f ms, pensar %.1f ms, %d s ===\n",
+           num_threads, POSSE_NS / 1e6, PENSAR_NS / 1e6, segundos);
+
+    Resultado antiga = medir(false, num_threads, segundos);
+    Resultado fila = medir(true, num_threads, segundos);
+
+    printf("%-7s %-8s %9s %10s %10s %10s %10s\n", "modo", "medida", "amostras",
+           "p50 (us)", "p90 (us)", "p99 (us)", "max (us)");
+    imprimir("antiga", "ocioso", &antiga.ocioso);
+    imprimir("antiga", "espera", &antiga.espera);
+    imprimir("fila", "ocioso", &fila.ocioso);
+    imprimir("fila", "espera", &fila.espera);
+
+    printf("\n%-7s %11s %14s %14s %10s\n", "modo", "aquisicoes", "min/thread", "max/thread", "uso");
+    long long posse_total = (long long)segundos * 1000000000LL;
+    printf("%-7s %11ld %14ld %14ld %9.1f%%\n", "antiga", antiga.aquisicoes, antiga.min_thread,
+           antiga.max_thread, 100.0 * antiga.aquisicoes * POSSE_NS / posse_total);
+    printf("%-7s %11ld %14ld %14ld %9.1f%%\n", "fila", fila.aquisicoes, fila.min_thread,
+           fila.max_thread, 100.0 * fila.aquisicoes * POSSE_NS / posse_total);
+    return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * bench_caixa.c - Ociosidade dos tedax: uma designacao por vez x caixa de tarefas
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_caixa [tarefas_por_tedax=3]
+ *
+ * Cada tedax tem a sua bancada e a fila comeca com todas as tarefas
+ * (tempo_resolucao de 1 s). Um coordenador automatico acorda a cada
+ * 150 ou 400 ms, como o jogador ou o piloto automatico olhando a tela:
+ *
+ *   uma    so designa a um tedax ocioso (o protocolo de uma tarefa pendente)
+ *   caixa  designa enquanto houver espaco na caixa do tedax
+ *
+ * Mede o tempo ate desarmar tudo, a espera media de um tedax entre o fim
+ * de uma tarefa e o inicio da seguinte, e a fracao do tempo trabalhando.
+ */
+
+#include "../include/tipos.h"
+#include "../include/jogo.h"
+#include "../include/modulos.h"
+#include "../include/tedax.h"
+#include "../include/bancada.h"
+#include "../include/pool_modulos.h"
+#include "../include/aleatorio.h"
+#include "../include/metricas.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define TAREFAS_PADRAO 3
+#define NUM_TEDAX_BENCH 3
+#define TEMPO_RESOLUCAO_BENCH 1
+#define TIMEOUT_NS 120000000000LL
+
+static EstadoJogoCompleto estado;
+static GeradorAleatorio gerador;
+
+typedef struct {
+    double segundos;                    /* Ate desarmar tudo */
+    double ocioso_ms;                   /* Espera media entre tarefas */
+    double utilizacao;                  /* Fracao do tempo trabalhando */
+    long trocas;
+} Resultado;
+
+static void preparar(int tarefas) {
+    ConfigJogo config = config_padrao();
+    config.num_tedax = NUM_TEDAX_BENCH;
+    config.num_bancadas = NUM_TEDAX_BENCH;
+    config.capacidade_fila = tarefas * NUM_TEDAX_BENCH;
+    if (jogo_init(&estado, &config) != 0) {
+        fprintf(stderr, "Falha ao iniciar o jogo\n");
+        exit(1);
+    }
+    jogo = &estado;
+    estado.estado = JOGO_RODANDO;
+    aleatorio_semear(&gerador, 42, FLUXO_MURAL);
+
+    for (int i = 0; i < tarefas * NUM_TEDAX_BENCH; i++) {
+        ModuloHandle h = pool_modulos_alocar();
+        Modulo* m = pool_modulos_obter(h);
+        gerar_modulo_aleatorio(&gerador, m, estado.proximo_id_modulo++, 1);
+        m->tempo_resolucao = TEMPO_RESOLUCAO_BENCH;
+        fila_modulos_adicionar(&estado.fila_modulos, h);
+    }
+    for (int i = 0; i < NUM_TEDAX_BENCH; i++) tedax_iniciar_thread(&estado.tedax[i]);
+}
+
+static int desarmados(void) {
+    Estatisticas stats;
+    jogo_somar_contadores(&estado, &stats);
+    return stats.modulos_desarmados;
+}
+
+/*
+ * Uma rodada do coordenador: designa o que a politica permitir, um modulo
+ * por tedax a cada volta para repartir a fila por igual.
+ */
+static void coordenar(bool usar_caixa) {
+    bool designou = true;
+    while (designou) {
+        designou = false;
+        for (int i = 0; i < NUM_TEDAX_BENCH; i++) {
+            Tedax* t = &estado.tedax[i];
+            bool aceita = usar_caixa ? tedax_quantidade_caixa(t) < CAPACIDADE_CAIXA_TEDAX : tedax_disponivel(t);
+            if (!aceita) continue;
+
+            ModuloHandle h;
+            if (!fila_modulos_remover(&estado.fila_modulos, &h)) return;
+            Modulo* m = pool_modulos_obter(h);
+            if (!tedax_designar_modulo(t, h, i, &m->instrucao)) {
+                fila_modulos_adicionar(&estado.fila_modulos, h);
+                continue;
+            }
+            designou = usar_caixa;
+        }
+    }
+}
+
+static Resultado encerrar(void) {
+    Resultado r = { 0 };
+
+    pthread_mutex_lock(&estado.mutex_estado);
+    estado.executando = false;
+    pthread_cond_broadcast(&estado.cond_estado);
+    pthread_mutex_unlock(&estado.mutex_estado);
+
+    long long ocioso = 0;
+    for (int i = 0; i < NUM_TEDAX_BENCH; i++) {
+        tedax_parar_thread(&estado.tedax[i]);
+        ocioso += estado.tedax[i].ocioso_ns;
+        r.trocas += estado.tedax[i].trocas;
+    }
+    r.ocioso_ms = r.trocas > 0 ? ocioso / 1e6 / r.trocas : 0.0;
+
+    fila_modulos_limpar(&estado.fila_modulos);
+    jogo_liberar_elementos(&estado);
+    fila_modulos_destroy(&estado.fila_modulos);
+    pool_modulos_devolver_cache();
+    pool_modulos_destroy();
+    pthread_mutex_destroy(&estado.mutex_estado);
+    pthread_mutex_destroy(&estado.mutex_display);
+    pthread_mutex_destroy(&estado.mutex_comando);
+    pthread_cond_destroy(&estado.cond_fim_jogo);
+    pthread_cond_destroy(&estado.cond_estado);
+    jogo = NULL;
+    return r;
+}
+
+static Resultado medir(bool usar_caixa, int tarefas, int intervalo_ms) {
+    preparar(tarefas);
+    int total = tarefas * NUM_TEDAX_BENCH;
+
+    long long inicio = relogio_ns();
+    long long limite = inicio + TIMEOUT_NS;
+    long long proxima_rodada = inicio;
+    /* O fim e conferido a cada 1 ms para nao somar o ciclo do coordenador */
+    while (desarmados() < total && relogio_ns() < limite) {
+        if (relogio_ns() >= proxima_rodada) {
+            coordenar(usar_caixa);
+            proxima_rodada += intervalo_ms * 1000000LL;
+        }
+        usleep(1000);
+    }
+    long long fim = relogio_ns();
+
+    Resultado r = encerrar();
+    r.segundos = (fim - inicio) / 1e9;
+    r.utilizacao = (double)tarefas * TEMPO_RESOLUCAO_BENCH / r.segundos;
+    return r;
+}
+
+int main(int argc, char* argv[]) {
+    int tarefas = argc > 1 ? atoi(argv[1]) : TAREFAS_PADRAO;
+    if (tarefas < 1) tarefas = TAREFAS_PADRAO;
+
+    printf("=== %d tedax, %d tarefas de %d s cada, caixa com %d lugares ===\n", NUM_TEDAX_BENCH, tarefas,
+           TEMPO_RESOLUCAO_BENCH, CAPACIDADE_CAIXA_TEDAX);
+    printf("%-6s %9s %10s %14s %11s\n", "modo", "ciclo ms", "total (s)", "ocioso/tarefa", "utilizacao");
+
+    int intervalos[] = { 150, 400 };
+    for (size_t k = 0; k < sizeof(intervalos) / sizeof(intervalos[0]); k++) {
+        Resultado uma = medir(false, tarefas, intervalos[k]);
+        Resultado caixa = medir(true, tarefas, intervalos[k]);
+        printf("%-6s %9d %10.2f %11.2f ms %10.1f%%\n", "uma", intervalos[k], uma.segundos, uma.ocioso_ms,
+               uma.utilizacao * 100);
+        printf("%-6s %9d %10.2f %11.2f ms %10.1f%%\n", "caixa", intervalos[k], caixa.segundos, caixa.ocioso_ms,
+               caixa.utilizacao * 100);
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * bench_chegadas.c - Capacidade de tedax/bancadas sob cada modelo de chegada
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_chegadas [semente] [arquivo_trace]
+ *
+ * Simula em tempo virtual uma hora de chegadas de cada modelo e atende os
+ * modulos em ordem de chegada com 1 a MAX_TEDAX_MENU tecnicos (cada um com a
+ * sua bancada), usando o tempo_resolucao dos modulos gerados. Reporta a
+ * fila media e maxima, a fracao do tempo com a fila na capacidade padrao
+ * (derrota no jogo) e quando isso aconteceu pela primeira vez.
+ */
+
+#include "../include/tipos.h"
+#include "../include/jogo.h"
+#include "../include/modulos.h"
+#include "../include/chegadas.h"
+#include "../include/aleatorio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define HORIZONTE_SEG 3600.0
+#define DIFICULDADE_SIMULADA 2
+#define MAX_CHEGADAS 100000
+
+typedef struct {
+    int chegadas;
+    double fila_media;
+    int fila_max;
+    double frac_cheia;          /* Fracao do tempo com fila >= capacidade */
+    double primeira_derrota;    /* Segundos, ou < 0 se nunca */
+} ResultadoCarga;
+
+static ResultadoCarga simular(const ConfigJogo* config, uint64_t semente, int servidores) {
+    ResultadoCarga r = { 0, 0.0, 0, 0.0, -1.0 };
+    GeradorChegadas chegadas;
+    if (chegadas_init(&chegadas, config, semente) != 0) return r;
+
+    GeradorAleatorio gerador;
+    aleatorio_semear(&gerador, semente, FLUXO_MURAL);
+
+    double* chegou = malloc(sizeof(double) * MAX_CHEGADAS);
+    double* inicio = malloc(sizeof(double) * MAX_CHEGADAS);
+    double livre_em[MAX_TEDAX_MENU] = { 0 };
+
+    /* FIFO com varios servidores: cada modulo vai para o tecnico que livra primeiro */
+    double t = 0.0;
+    Chegada c;
+    int n = 0;
+    while (n < MAX_CHEGADAS && chegadas_proxima(&chegadas, DIFICULDADE_SIMULADA, &c)) {
+        t += c.intervalo;
+        if (t > HORIZONTE_SEG) break;
+
+        Modulo m;
+        if (c.tipo >= 0) gerar_modulo(&gerador, &m, n, DIFICULDADE_SIMULADA, c.tipo, c.parametro);
+        else gerar_modulo_aleatorio(&gerador, &m, n, DIFICULDADE_SIMULADA);
+
+        int k = 0;
+        for (int i = 1; i < servidores; i++) {
+            if (livre_em[i] < livre_em[k]) k = i;
+        }
+        chegou[n] = t;
+        inicio[n] = livre_em[k] > t ? livre_em[k] : t;
+        livre_em[k] = inicio[n] + m.tempo_resolucao;
+        n++;
+    }
+    r.chegadas = n;
+
+    /* Varredura: a fila cresce em cada chegada e diminui em cada inicio */
+    int a = 0, b = 0, fila = 0;
+    double anterior = 0.0, area = 0.0, tempo_cheia = 0.0;
+    while (a < n || b < n) {
+        bool eh_inicio = b < a && (a >= n || inicio[b] <= chegou[a]);
+        double agora = eh_inicio ? inicio[b] : chegou[a];
+        if (agora > HORIZONTE_SEG) agora = HORIZONTE_SEG;
+
+        area += fila * (agora - anterior);
+        if (fila >= MAX_MODULOS_PENDENTES) tempo_cheia += agora - anterior;
+        anterior = agora;
+
+        if (eh_inicio) {
+            fila--;
+            b++;
+        } else {
+            fila++;
+            a++;
+            if (fila > r.fila_max) r.fila_max = fila;
+            if (fila >= MAX_MODULOS_PENDENTES && r.primeira_derrota < 0) r.primeira_derrota = agora;
+        }
+    }
+
+    r.fila_media = area / HORIZONTE_SEG;
+    r.frac_cheia = tempo_cheia / HORIZONTE_SEG;
+
+    free(chegou);
+    free(inicio);
+    chegadas_destroy(&chegadas);
+    return r;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t semente = argc > 1 ? strtoull(argv[1], NULL, 10) : 42;
+    const char* trace = argc > 2 ? argv[2] : NULL;
+
+    printf("=== Carga por modelo de chegada: %.0f s virtuais, semente %llu, capacidade %d ===\n",
+           HORIZONTE_SEG, (unsigned long long)semente, MAX_MODULOS_PENDENTES);
+    printf("%-9s %6s %12s %11s %9s %12s %14s\n", "modelo", "tedax", "chegadas/min",
+           "fila media", "fila max", "cheia (%)", "derrota em (s)");
+
+    for (int modelo = 0; modelo < CHEGADA_TOTAL; modelo++) {
+        ConfigJogo config = config_padrao();
+        config.modelo_chegada = modelo;
+        if (modelo == CHEGADA_TRACE) {
+            if (!trace) continue;
+            strncpy(config.arquivo_trace, trace, MAX_CAMINHO - 1);
+        }
+
+        for (int tedax = 1; tedax <= MAX_TEDAX_MENU; tedax++) {
+            ResultadoCarga r = simular(&config, semente, tedax);
+            char derrota[16] = "-";
+            if (r.primeira_derrota >= 0) snprintf(derrota, sizeof(derrota), "%.0f", r.primeira_derrota);
+            printf("%-9s %6d %12.2f %11.2f %9d %12.2f %14s\n", chegadas_nome_modelo(modelo), tedax,
+                   r.chegadas / (HORIZONTE_SEG / 60.0), r.fila_media, r.fila_max,
+                   100.0 * r.frac_cheia, derrota);
+        }
+    }
+    return 0;
+}
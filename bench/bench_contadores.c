@@ -0,0 +1,194 @@
+/*
+ * bench_contadores.c - Contadores da partida: mutex_estado x atomico unico x slot por tedax
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_contadores [segundos=1]
+ *
+ * Cada thread faz o papel de um tedax que so conclui modulos: conta um
+ * desarmado por volta, de tres jeitos, enquanto a thread principal le o
+ * total a cada 1 ms (como o timer e a tela):
+ *
+ *   global   stats.modulos_desarmados++ sob mutex_estado, e a leitura
+ *            travando o mesmo mutex (o caminho antigo)
+ *   atomico  um so contador atomico relaxado para todos os tedax
+ *   slot     o contador do proprio Tedax, em linha propria, e a leitura
+ *            somando todos os tedax (jogo_somar_contadores)
+ *
+ * Reporta incrementos por segundo (total e por thread), o custo de cada
+ * leitura do total e confere o total final com o que as threads contaram.
+ * Por fim, mede a soma com 4 a MAX_TEDAX tedax e 4 threads contando.
+ */
+
+#include "../include/tipos.h"
+#include "../include/jogo.h"
+#include "../include/modulos.h"
+#include "../include/pool_modulos.h"
+#include "../include/metricas.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define SEGUNDOS_PADRAO 1
+#define MAX_THREADS 64
+#define THREADS_SOMA 4
+#define LEITURA_US 1000
+
+typedef enum {
+    MODO_GLOBAL,
+    MODO_ATOMICO,
+    MODO_SLOT
+} ModoContador;
+
+static const char* NOMES_MODO[] = { "global", "atomico", "slot" };
+
+typedef struct {
+    Tedax* tedax;
+    ModoContador modo;
+    long feitos;
+} Participante;
+
+static EstadoJogoCompleto estado;
+static alignas(TAMANHO_LINHA_CACHE) _Atomic int compartilhado;
+static atomic_bool rodando;
+
+static void contar(Participante* p) {
+    switch (p->modo) {
+        case MODO_GLOBAL:
+            pthread_mutex_lock(&estado.mutex_estado);
+            estado.stats.modulos_desarmados++;
+            pthread_mutex_unlock(&estado.mutex_estado);
+            break;
+        case MODO_ATOMICO:
+            atomic_fetch_add_explicit(&compartilhado, 1, memory_order_relaxed);
+            break;
+        case MODO_SLOT:
+            atomic_fetch_add_explicit(&p->tedax->modulos_desarmados, 1, memory_order_relaxed);
+            break;
+    }
+}
+
+static void* participar(void* arg) {
+    Participante* p = (Participante*)arg;
+    while (atomic_load_explicit(&rodando, memory_order_relaxed)) {
+        for (int i = 0; i < 256; i++) contar(p);
+        p->feitos += 256;
+    }
+    return NULL;
+}
+
+static int ler_total(ModoContador modo) {
+    switch (modo) {
+        case MODO_GLOBAL: {
+            pthread_mutex_lock(&estado.mutex_estado);
+            int n = estado.stats.modulos_desarmados;
+            pthread_mutex_unlock(&estado.mutex_estado);
+            return n;
+        }
+        case MODO_ATOMICO:
+            return atomic_load_explicit(&compartilhado, memory_order_relaxed);
+        case MODO_SLOT: {
+            Estatisticas stats;
+            jogo_somar_contadores(&estado, &stats);
+            return stats.modulos_desarmados;
+        }
+    }
+    return 0;
+}
+
+static void zerar(int num_tedax) {
+    estado.config.num_tedax = num_tedax;
+    estado.stats.modulos_desarmados = 0;
+    atomic_store(&compartilhado, 0);
+    for (int i = 0; i < MAX_TEDAX; i++) atomic_store(&estado.tedax[i].modulos_desarmados, 0);
+}
+
+/*
+ * 'threads' tedax contando, espalhados entre os 'num_tedax' do jogo; a
+ * thread principal le o total a cada LEITURA_US. Devolve os ns por leitura.
+ */
+static double medir(int threads, int num_tedax, ModoContador modo, int segundos, bool imprimir) {
+    Participante participantes[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    zerar(num_tedax);
+    atomic_store(&rodando, true);
+    for (int i = 0; i < threads; i++) {
+        participantes[i] = (Participante){ .tedax = &estado.tedax[(long)i * num_tedax / threads], .modo = modo };
+        pthread_create(&ids[i], NULL, participar, &participantes[i]);
+    }
+
+    long leituras = 0;
+    long long lendo = 0;
+    long long inicio = relogio_ns();
+    long long fim = inicio + segundos * 1000000000LL;
+    long long proximo = inicio;
+    while (proximo < fim) {
+        long long antes = relogio_ns();
+        volatile int total = ler_total(modo);
+        (void)total;
+        lendo += relogio_ns() - antes;
+        leituras++;
+        proximo += LEITURA_US * 1000LL;
+        struct timespec prazo = timespec_de_ns(proximo);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &prazo, NULL);
+    }
+    atomic_store(&rodando, false);
+    long feitos = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        feitos += participantes[i].feitos;
+    }
+    double duracao = (relogio_ns() - inicio) / 1e9;
+    double ns_leitura = leituras > 0 ? (double)lendo / leituras : 0.0;
+
+    if (imprimir) {
+        printf("%7d %-8s %12.2f %14.0f %12.1f %6s\n", threads, NOMES_MODO[modo], feitos / duracao / 1e6,
+               feitos / duracao / threads, ns_leitura, ler_total(modo) == (int)feitos ? "ok" : "ERRO");
+    }
+    return ns_leitura;
+}
+
+int main(int argc, char* argv[]) {
+    int segundos = argc > 1 ? atoi(argv[1]) : SEGUNDOS_PADRAO;
+    if (segundos < 1 || segundos > 10) segundos = SEGUNDOS_PADRAO;
+
+    /* Vetores para MAX_TEDAX; cada medida usa os primeiros num_tedax */
+    ConfigJogo config = config_padrao();
+    config.num_tedax = MAX_TEDAX;
+    config.num_bancadas = 1;
+    if (jogo_init(&estado, &config) != 0) {
+        fprintf(stderr, "Falha ao iniciar o jogo\n");
+        return 1;
+    }
+    jogo = &estado;
+
+    printf("=== Threads contando desarmados, total lido a cada %d us, %d s por medida ===\n", LEITURA_US,
+           segundos);
+    printf("%7s %-8s %12s %14s %12s %6s\n", "threads", "modo", "Mincr/s", "incr/s/thread", "ns/leitura", "total");
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        for (int modo = MODO_GLOBAL; modo <= MODO_SLOT; modo++) {
+            medir(threads, threads, (ModoContador)modo, segundos, true);
+        }
+    }
+
+    printf("\n=== Soma dos slots com %d threads contando ===\n", THREADS_SOMA);
+    printf("%7s %12s %12s\n", "tedax", "ns/leitura", "ns/tedax");
+    for (int num_tedax = THREADS_SOMA; num_tedax <= MAX_TEDAX; num_tedax *= 4) {
+        double ns = medir(THREADS_SOMA, num_tedax, MODO_SLOT, segundos, false);
+        printf("%7d %12.1f %12.2f\n", num_tedax, ns, ns / num_tedax);
+    }
+
+    jogo = NULL;
+    estado.config.num_tedax = MAX_TEDAX;
+    jogo_liberar_elementos(&estado);
+    fila_modulos_destroy(&estado.fila_modulos);
+    pool_modulos_destroy();
+    pthread_mutex_destroy(&estado.mutex_estado);
+    pthread_mutex_destroy(&estado.mutex_display);
+    pthread_mutex_destroy(&estado.mutex_comando);
+    pthread_cond_destroy(&estado.cond_fim_jogo);
+    pthread_cond_destroy(&estado.cond_estado);
+    return 0;
+}
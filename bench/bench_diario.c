@@ -0,0 +1,193 @@
+/*
+ * bench_diario.c - Mensagens de feedback: slot unico sob trylock x diario MPSC
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_diario [segundos=1] [quadro_us=1000]
+ *
+ * Cada thread produtora publica mensagens formatadas sem parar, como
+ * tedax, mural e timer fazem com jogo_feedback, e a thread principal le
+ * a cada 'quadro_us' como o painel de mensagens:
+ *
+ *   slot    o jogo_feedback antigo: trylock em mutex_estado e vsnprintf
+ *           numa mensagem unica; trava ocupada perde a mensagem, e o
+ *           quadro so ve a ultima
+ *   diario  jogo_feedback atual (diario_publicar) e diario_recentes com
+ *           as ultimas MENSAGENS_PAINEL entradas
+ *
+ * Primeiro a toda velocidade, depois com cada thread publicando uma
+ * mensagem a cada RITMO_MS (ritmo de jogo movimentado). Reporta tentativas
+ * e mensagens escritas por segundo, as descartadas pelo produtor (trava
+ * ocupada ou slot do anel ainda em uso) e as sobrescritas antes de algum
+ * quadro alcanca-las. A toda velocidade o anel da muitas voltas entre dois
+ * quadros, e o que importa e o produtor nunca esperar; no ritmo, o quadro
+ * deve alcancar todas.
+ */
+
+#include "../include/tipos.h"
+#include "../include/jogo.h"
+#include "../include/modulos.h"
+#include "../include/pool_modulos.h"
+#include "../include/diario.h"
+#include "../include/metricas.h"
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define SEGUNDOS_PADRAO 1
+#define QUADRO_US_PADRAO 1000
+#define MAX_THREADS 64
+#define MENSAGENS_PAINEL 5
+#define RITMO_MS 10
+
+typedef struct {
+    int id;
+    bool diario;
+    long long intervalo_ns;         /* 0 = sem pausa entre mensagens */
+    long tentativas;
+} Produtor;
+
+static EstadoJogoCompleto estado;
+static atomic_bool rodando;
+
+/* A mensagem unica de antes, com um numero para o quadro saber se e nova */
+static char mensagem_antiga[128];
+static long numero_antigo;
+static atomic_long perdidas_antigas;
+
+static void feedback_antigo(const char* formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    if (pthread_mutex_trylock(&estado.mutex_estado) == 0) {
+        vsnprintf(mensagem_antiga, sizeof(mensagem_antiga), formato, args);
+        numero_antigo++;
+        pthread_mutex_unlock(&estado.mutex_estado);
+    } else {
+        atomic_fetch_add_explicit(&perdidas_antigas, 1, memory_order_relaxed);
+    }
+    va_end(args);
+}
+
+static void publicar(Produtor* p, long k) {
+    if (p->diario) jogo_feedback(&estado, "Tedax %d desarmou Fios #%ld com sucesso!", p->id + 1, k);
+    else feedback_antigo("Tedax %d desarmou Fios #%ld com sucesso!", p->id + 1, k);
+}
+
+static void* produzir(void* arg) {
+    Produtor* p = (Produtor*)arg;
+    long k = 0;
+    long long proximo = relogio_ns();
+    while (atomic_load_explicit(&rodando, memory_order_relaxed)) {
+        if (p->intervalo_ns == 0) {
+            for (int i = 0; i < 64; i++, p->tentativas++) publicar(p, k++);
+            continue;
+        }
+        publicar(p, k++);
+        p->tentativas++;
+        proximo += p->intervalo_ns;
+        struct timespec prazo = timespec_de_ns(proximo);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &prazo, NULL);
+    }
+    return NULL;
+}
+
+static void medir(int threads, bool diario, long long intervalo_ns, int segundos, int quadro_us) {
+    Produtor produtores[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    diario_init(&estado.diario);
+    numero_antigo = 0;
+    atomic_store(&perdidas_antigas, 0);
+    atomic_store(&rodando, true);
+    for (int i = 0; i < threads; i++) {
+        produtores[i] = (Produtor){ .id = i, .diario = diario, .intervalo_ns = intervalo_ns };
+        pthread_create(&ids[i], NULL, produzir, &produtores[i]);
+    }
+
+    /* Quadros: o slot antigo mostra so a ultima mensagem, e so se a trava estiver livre */
+    long vistas_antigas = 0, ultimo_visto = 0;
+    volatile int soma = 0;
+    long long inicio = relogio_ns();
+    long long fim = inicio + segundos * 1000000000LL;
+    long long proximo = inicio;
+    while (proximo < fim) {
+        if (diario) {
+            EntradaDiario entradas[MENSAGENS_PAINEL];
+            int qtd = diario_recentes(&estado.diario, entradas, MENSAGENS_PAINEL);
+            for (int i = 0; i < qtd; i++) soma += entradas[i].texto[0];
+        } else if (pthread_mutex_trylock(&estado.mutex_estado) == 0) {
+            if (numero_antigo != ultimo_visto) {
+                vistas_antigas++;
+                ultimo_visto = numero_antigo;
+            }
+            soma += mensagem_antiga[0];
+            pthread_mutex_unlock(&estado.mutex_estado);
+        }
+        proximo += quadro_us * 1000LL;
+        struct timespec prazo = timespec_de_ns(proximo);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &prazo, NULL);
+    }
+    atomic_store(&rodando, false);
+    long tentativas = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        tentativas += produtores[i].tentativas;
+    }
+    double duracao = (relogio_ns() - inicio) / 1e9;
+
+    long descartadas, sobrescritas;
+    if (diario) {
+        EstatisticasDiario e = diario_estatisticas(&estado.diario);
+        descartadas = e.descartadas;
+        sobrescritas = e.sobrescritas;
+    } else {
+        descartadas = atomic_load(&perdidas_antigas);
+        sobrescritas = numero_antigo - vistas_antigas;
+    }
+    printf("%7d %-7s %12.0f %12.0f %12ld %7.2f%% %13ld %7.2f%%\n", threads, diario ? "diario" : "slot",
+           tentativas / duracao, (tentativas - descartadas) / duracao, descartadas,
+           100.0 * descartadas / tentativas, sobrescritas, 100.0 * sobrescritas / tentativas);
+}
+
+int main(int argc, char* argv[]) {
+    int segundos = argc > 1 ? atoi(argv[1]) : SEGUNDOS_PADRAO;
+    int quadro_us = argc > 2 ? atoi(argv[2]) : QUADRO_US_PADRAO;
+    if (segundos < 1) segundos = SEGUNDOS_PADRAO;
+    if (quadro_us < 1) quadro_us = QUADRO_US_PADRAO;
+
+    ConfigJogo config = config_padrao();
+    if (jogo_init(&estado, &config) != 0) {
+        fprintf(stderr, "Falha ao iniciar o jogo\n");
+        return 1;
+    }
+    jogo = &estado;
+
+    for (int ritmo = 0; ritmo <= 1; ritmo++) {
+        long long intervalo_ns = ritmo ? RITMO_MS * 1000000LL : 0;
+        if (ritmo) {
+            printf("\n=== Uma mensagem a cada %d ms por thread ===\n", RITMO_MS);
+        } else {
+            printf("=== Produtores a toda velocidade, um quadro a cada %d us, %d s por medida (anel de %d) ===\n",
+                   quadro_us, segundos, CAPACIDADE_DIARIO);
+        }
+        printf("%7s %-7s %12s %12s %12s %8s %13s %8s\n", "threads", "modo", "tentativas/s", "escritas/s",
+               "descartadas", "", "sobrescritas", "");
+        for (int threads = 1; threads <= MAX_THREADS; threads *= 4) {
+            medir(threads, false, intervalo_ns, segundos, quadro_us);
+            medir(threads, true, intervalo_ns, segundos, quadro_us);
+        }
+    }
+
+    jogo = NULL;
+    jogo_liberar_elementos(&estado);
+    fila_modulos_destroy(&estado.fila_modulos);
+    pool_modulos_destroy();
+    pthread_mutex_destroy(&estado.mutex_estado);
+    pthread_mutex_destroy(&estado.mutex_display);
+    pthread_mutex_destroy(&estado.mutex_comando);
+    pthread_cond_destroy(&estado.cond_fim_jogo);
+    pthread_cond_destroy(&estado.cond_estado);
+    return 0;
+}
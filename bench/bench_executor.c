@@ -0,0 +1,203 @@
+/*
+ * bench_executor.c - Um thread por tedax x tedax como tarefas em um pool (M:N)
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_executor [tedax] [segundos]
+ *
+ * Cria muitos tedax autonomos (padrao 10000) disputando BANCADAS_BENCH
+ * bancadas, com a fila pre-carregada de modulos de tempo_resolucao 1: como
+ * no jogo, quase todo o tempo de um tedax e esperando bancada ou
+ * "resolvendo". Compara o modo thread (um pthread por tedax) com o modo
+ * pool (maquinas de estados em nproc trabalhadores) e reporta a memoria
+ * por tedax (RSS e virtual; a memoria do kernel por thread nao entra),
+ * trocas de contexto por segundo, uso de CPU e modulos desarmados/s.
+ *
+ * Os tedax ficam em um vetor proprio, fora de jogo->tedax; com
+ * config.num_tedax = 1 nao ha roubo entre eles.
+ */
+
+#include "../include/tipos.h"
+#include "../include/jogo.h"
+#include "../include/modulos.h"
+#include "../include/tedax.h"
+#include "../include/bancada.h"
+#include "../include/pool_modulos.h"
+#include "../include/aleatorio.h"
+#include "../include/metricas.h"
+#include "../include/executor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define TEDAX_PADRAO 10000
+#define SEGUNDOS_PADRAO 5
+#define CAPACIDADE_BENCH (1 << 17)
+#define MODULOS_POR_TEDAX 2
+#define BANCADAS_BENCH 5
+
+static EstadoJogoCompleto estado;
+
+typedef struct {
+    int criados;                /* Tedax efetivamente iniciados */
+    int threads;                /* Threads de tedax (ou trabalhadores do pool) */
+    double rss_por_tedax;       /* Bytes */
+    double virtual_por_tedax;   /* Bytes */
+    double trocas_por_seg;      /* Voluntarias + involuntarias */
+    double cpu;                 /* Fracao de uma CPU */
+    double desarmados_por_seg;
+} Resultado;
+
+/* Paginas residentes e virtuais do processo */
+static void memoria_processo(long* rss, long* virt) {
+    *rss = *virt = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f) return;
+    if (fscanf(f, "%ld %ld", virt, rss) != 2) *rss = *virt = 0;
+    fclose(f);
+    long pagina = sysconf(_SC_PAGESIZE);
+    *rss *= pagina;
+    *virt *= pagina;
+}
+
+static long trocas_contexto(const struct rusage* r) {
+    return r->ru_nvcsw + r->ru_nivcsw;
+}
+
+static double segundos_cpu(const struct rusage* r) {
+    return r->ru_utime.tv_sec + r->ru_utime.tv_usec / 1e6 +
+           r->ru_stime.tv_sec + r->ru_stime.tv_usec / 1e6;
+}
+
+static int desarmados(void) {
+    Estatisticas stats;
+    jogo_somar_contadores(&estado, &stats);
+    return stats.modulos_desarmados;
+}
+
+static Resultado medir(bool em_pool, int num_tedax, int segundos) {
+    Resultado r = { 0 };
+
+    ConfigJogo config = config_padrao();
+    config.num_tedax = 1;
+    config.num_bancadas = BANCADAS_BENCH;
+    config.capacidade_fila = CAPACIDADE_BENCH;
+    config.tedax_autonomos = true;
+    config.tedax_em_pool = em_pool;
+    if (jogo_init(&estado, &config) != 0) {
+        fprintf(stderr, "Falha ao iniciar o jogo\n");
+        exit(1);
+    }
+    jogo = &estado;
+    estado.estado = JOGO_RODANDO;
+
+    GeradorAleatorio gerador;
+    aleatorio_semear(&gerador, 42, FLUXO_MURAL);
+    long long modulos = (long long)num_tedax * MODULOS_POR_TEDAX;
+    if (modulos > CAPACIDADE_BENCH) modulos = CAPACIDADE_BENCH;
+    for (long long i = 0; i < modulos; i++) {
+        ModuloHandle h = pool_modulos_alocar();
+        if (h == MODULO_HANDLE_NULO) break;
+        Modulo* m = pool_modulos_obter(h);
+        gerar_modulo_aleatorio(&gerador, m, estado.proximo_id_modulo++, 1);
+        m->tempo_resolucao = 1;
+        if (!fila_modulos_adicionar(&estado.fila_modulos, h)) pool_modulos_liberar(h);
+    }
+
+    long rss0, virt0;
+    memoria_processo(&rss0, &virt0);
+
+    Tedax* equipe = aligned_alloc(TAMANHO_LINHA_CACHE, sizeof(Tedax) * num_tedax);
+    if (equipe) memset(equipe, 0, sizeof(Tedax) * num_tedax);
+    Executor executor;
+    if (!equipe || (em_pool && executor_init(&executor, 0, pool_modulos_devolver_cache) != 0)) {
+        fprintf(stderr, "Sem memoria para %d tedax\n", num_tedax);
+        exit(1);
+    }
+
+    for (int i = 0; i < num_tedax; i++) {
+        tedax_init(&equipe[i], i);
+        int ok = em_pool ? tedax_iniciar_tarefa(&equipe[i], &executor) : tedax_iniciar_thread(&equipe[i]);
+        if (ok != 0) break;
+        r.criados++;
+    }
+    r.threads = em_pool ? executor.num_trabalhadores : r.criados;
+
+    sleep(1); /* Aquecimento: todos os tedax com modulo e esperando bancada */
+
+    long rss1, virt1;
+    memoria_processo(&rss1, &virt1);
+    struct rusage uso0, uso1;
+    getrusage(RUSAGE_SELF, &uso0);
+    long long t0 = relogio_ns();
+    int feitos0 = desarmados();
+
+    sleep(segundos);
+
+    getrusage(RUSAGE_SELF, &uso1);
+    double dt = (relogio_ns() - t0) / 1e9;
+    int feitos1 = desarmados();
+
+    if (r.criados > 0) {
+        r.rss_por_tedax = (double)(rss1 - rss0) / r.criados;
+        r.virtual_por_tedax = (double)(virt1 - virt0) / r.criados;
+    }
+    r.trocas_por_seg = (trocas_contexto(&uso1) - trocas_contexto(&uso0)) / dt;
+    r.cpu = (segundos_cpu(&uso1) - segundos_cpu(&uso0)) / dt;
+    r.desarmados_por_seg = (feitos1 - feitos0) / dt;
+
+    /* Encerra: todos saem em paralelo antes dos joins */
+    pthread_mutex_lock(&estado.mutex_estado);
+    estado.executando = false;
+    pthread_cond_broadcast(&estado.cond_estado);
+    pthread_mutex_unlock(&estado.mutex_estado);
+    fila_modulos_despertar(&estado.fila_modulos);
+    for (int i = 0; i < BANCADAS_BENCH; i++) {
+        pthread_mutex_lock(&estado.bancadas[i].mutex);
+        pthread_cond_broadcast(&estado.bancadas[i].cond_livre);
+        pthread_mutex_unlock(&estado.bancadas[i].mutex);
+    }
+
+    for (int i = 0; i < r.criados; i++) tedax_parar_thread(&equipe[i]);
+    if (em_pool) executor_destroy(&executor);
+    for (int i = 0; i < num_tedax; i++) tedax_destroy(&equipe[i]);
+    free(equipe);
+
+    fila_modulos_limpar(&estado.fila_modulos);
+    jogo_liberar_elementos(&estado);
+    fila_modulos_destroy(&estado.fila_modulos);
+    pool_modulos_devolver_cache();
+    pool_modulos_destroy();
+    pthread_mutex_destroy(&estado.mutex_estado);
+    pthread_mutex_destroy(&estado.mutex_display);
+    pthread_mutex_destroy(&estado.mutex_comando);
+    pthread_cond_destroy(&estado.cond_fim_jogo);
+    pthread_cond_destroy(&estado.cond_estado);
+    jogo = NULL;
+    return r;
+}
+
+static void imprimir(const char* modo, Resultado r) {
+    printf("%-7s %7d %8d %12.1f %15.1f %12.0f %8.0f%% %13.1f\n", modo, r.criados, r.threads,
+           r.rss_por_tedax / 1024.0, r.virtual_por_tedax / 1024.0, r.trocas_por_seg,
+           r.cpu * 100.0, r.desarmados_por_seg);
+}
+
+int main(int argc, char* argv[]) {
+    int num_tedax = argc > 1 ? atoi(argv[1]) : TEDAX_PADRAO;
+    int segundos = argc > 2 ? atoi(argv[2]) : SEGUNDOS_PADRAO;
+    if (num_tedax < 1) num_tedax = TEDAX_PADRAO;
+    if (segundos < 1) segundos = SEGUNDOS_PADRAO;
+
+    printf("=== %d tedax autonomos, %d bancadas, %d s medidos, %d CPUs ===\n",
+           num_tedax, BANCADAS_BENCH, segundos, executor_num_cpus());
+    printf("%-7s %7s %8s %12s %15s %12s %9s %13s\n", "modo", "tedax", "threads",
+           "RSS KiB/td", "virtual KiB/td", "trocas/s", "CPU", "desarmados/s");
+
+    imprimir("thread", medir(false, num_tedax, segundos));
+    imprimir("pool", medir(true, num_tedax, segundos));
+    return 0;
+}
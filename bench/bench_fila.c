@@ -0,0 +1,655 @@
+/*
+ * bench_fila.c - Benchmarks da fila de modulos pendentes
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_fila [cenario]
+ *   contencao            - vazao de enfileirar/desenfileirar com 1 a 32 threads
+ *   backlog [N] [cresce] - enche e esvazia uma fila de N modulos (padrao 10^6),
+ *                          um a um e em lotes
+ *   pool                 - ciclo gerar/enfileirar/retirar/liberar com o pool
+ *                          de modulos vs. copias com malloc/free
+ *   edf [semente]        - FIFO vs. EDF na mesma carga simulada: taxa de
+ *                          prazos perdidos e vazao
+ *   remocao              - remocao por ID no meio da fila com 10, 1k e 100k
+ *                          pendentes vs. vetor deslocado com memmove
+ *   espera               - consumidor bloqueado em fila_modulos_aguardar_item
+ *                          vs. polling com usleep: latencia e CPU gasta
+ */
+
+#include "../include/tipos.h"
+#include "../include/modulos.h"
+#include "../include/fila_mpmc.h"
+#include "../include/pool_modulos.h"
+#include "../include/aleatorio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define OPERACOES_POR_THREAD 200000
+#define CAPACIDADE_CONTENCAO 16
+
+static double agora_seg(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ==================== CONTENCAO ==================== */
+
+/* Referencia: buffer circular protegido por um unico mutex (versao anterior) */
+typedef struct {
+    ModuloHandle modulos[CAPACIDADE_CONTENCAO];
+    int inicio;
+    int fim;
+    int quantidade;
+    pthread_mutex_t mutex;
+} FilaMutex;
+
+static bool fila_mutex_adicionar(void* f, ModuloHandle m) {
+    FilaMutex* fila = f;
+    pthread_mutex_lock(&fila->mutex);
+    if (fila->quantidade >= CAPACIDADE_CONTENCAO) {
+        pthread_mutex_unlock(&fila->mutex);
+        return false;
+    }
+    fila->modulos[fila->fim] = m;
+    fila->fim = (fila->fim + 1) % CAPACIDADE_CONTENCAO;
+    fila->quantidade++;
+    pthread_mutex_unlock(&fila->mutex);
+    return true;
+}
+
+static bool fila_mutex_remover(void* f, ModuloHandle* m) {
+    FilaMutex* fila = f;
+    pthread_mutex_lock(&fila->mutex);
+    if (fila->quantidade == 0) {
+        pthread_mutex_unlock(&fila->mutex);
+        return false;
+    }
+    *m = fila->modulos[fila->inicio];
+    fila->inicio = (fila->inicio + 1) % CAPACIDADE_CONTENCAO;
+    fila->quantidade--;
+    pthread_mutex_unlock(&fila->mutex);
+    return true;
+}
+
+static bool mpmc_adicionar(void* f, ModuloHandle m) { return fila_mpmc_enfileirar(f, m); }
+static bool mpmc_remover(void* f, ModuloHandle* m) { return fila_mpmc_desenfileirar(f, m); }
+static bool modulos_adicionar(void* f, ModuloHandle m) { return fila_modulos_adicionar(f, m); }
+static bool modulos_remover(void* f, ModuloHandle* m) { return fila_modulos_remover(f, m); }
+
+typedef struct {
+    const char* nome;
+    bool (*adicionar)(void*, ModuloHandle);
+    bool (*remover)(void*, ModuloHandle*);
+} ImplFila;
+
+typedef struct {
+    const ImplFila* impl;
+    void* fila;
+} ArgContencao;
+
+static void* trabalhador_contencao(void* arg) {
+    ArgContencao* a = arg;
+    ModuloHandle h = pool_modulos_alocar();
+    pool_modulos_obter(h)->id = 0;
+    pool_modulos_obter(h)->tipo = MODULO_FIOS;
+
+    /* Cada iteracao publica um modulo e retira um (de qualquer produtor) */
+    for (int i = 0; i < OPERACOES_POR_THREAD; i++) {
+        while (!a->impl->adicionar(a->fila, h)) sched_yield();
+        while (!a->impl->remover(a->fila, &h)) sched_yield();
+    }
+
+    pool_modulos_liberar(h);
+    pool_modulos_devolver_cache();
+    return NULL;
+}
+
+static double medir_contencao(const ImplFila* impl, void* fila, int num_threads) {
+    pthread_t threads[32];
+    ArgContencao arg = { impl, fila };
+
+    double t0 = agora_seg();
+    for (int i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, trabalhador_contencao, &arg);
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double dt = agora_seg() - t0;
+
+    return (2.0 * OPERACOES_POR_THREAD * num_threads) / dt;
+}
+
+static void cenario_contencao(void) {
+    static const ImplFila impls[] = {
+        { "mutex (anterior)", fila_mutex_adicionar, fila_mutex_remover },
+        { "mpmc lock-free",   mpmc_adicionar,       mpmc_remover },
+        { "fila_modulos_*",   modulos_adicionar,    modulos_remover },
+    };
+    static const int threads[] = { 1, 2, 4, 8, 16, 32 };
+
+    printf("=== Contencao: %d pares enfileirar/desenfileirar por thread ===\n",
+           OPERACOES_POR_THREAD);
+    printf("%-18s", "implementacao");
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        printf("  %8d thr", threads[t]);
+    }
+    printf("   (Mops/s)\n");
+
+    for (size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+        printf("%-18s", impls[i].nome);
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            FilaMutex fm;
+            FilaMPMC mpmc;
+            SlotFilaMPMC slots[CAPACIDADE_CONTENCAO];
+            FilaModulos* fmod = malloc(sizeof(FilaModulos));
+            void* fila = NULL;
+
+            if (i == 0) {
+                memset(&fm, 0, sizeof(fm));
+                pthread_mutex_init(&fm.mutex, NULL);
+                fila = &fm;
+            } else if (i == 1) {
+                fila_mpmc_init(&mpmc, slots, CAPACIDADE_CONTENCAO);
+                fila = &mpmc;
+            } else {
+                fila_modulos_init(fmod, CAPACIDADE_CONTENCAO, false, FILA_FIFO);
+                fila = fmod;
+            }
+
+            double ops = medir_contencao(&impls[i], fila, threads[t]);
+            printf("  %12.2f", ops / 1e6);
+            fflush(stdout);
+
+            if (i == 0) pthread_mutex_destroy(&fm.mutex);
+            if (i == 2) fila_modulos_destroy(fmod);
+            free(fmod);
+        }
+        printf("\n");
+    }
+}
+
+/* ==================== BACKLOG ==================== */
+
+#define TAMANHO_LOTE_BACKLOG 64
+
+static void cenario_backlog(int n, bool crescente) {
+    FilaModulos* fila = malloc(sizeof(FilaModulos));
+    if (!fila || fila_modulos_init(fila, n, crescente, FILA_FIFO) != 0) {
+        fprintf(stderr, "Falha ao alocar fila de %d modulos\n", n);
+        free(fila);
+        return;
+    }
+
+    double t0 = agora_seg();
+    for (int i = 0; i < n; i++) {
+        ModuloHandle h = pool_modulos_alocar();
+        Modulo* m = pool_modulos_obter(h);
+        if (!m) {
+            fprintf(stderr, "Pool sem memoria no modulo %d\n", i);
+            break;
+        }
+        m->id = i;
+        m->tipo = i % MODULO_TOTAL;
+        if (!fila_modulos_adicionar(fila, h)) {
+            fprintf(stderr, "Fila recusou o modulo %d\n", i);
+            pool_modulos_liberar(h);
+            break;
+        }
+    }
+    double t1 = agora_seg();
+    int qtd = fila_modulos_quantidade(fila);
+    int removidos = 0;
+    ModuloHandle h;
+    while (fila_modulos_remover(fila, &h)) {
+        pool_modulos_liberar(h);
+        removidos++;
+    }
+    double t2 = agora_seg();
+
+    printf("=== Backlog de %d modulos (%s) ===\n", n, crescente ? "crescente" : "pre-alocada");
+    printf("enchimento: %d modulos em %.3f s (%.2f Mops/s)\n", qtd, t1 - t0, qtd / (t1 - t0) / 1e6);
+    printf("drenagem:   %d modulos em %.3f s (%.2f Mops/s)\n", removidos, t2 - t1,
+           removidos / (t2 - t1) / 1e6);
+    printf("nos alocados: %d\n", fila->capacidade_nos);
+
+    /* Mesmo ciclo em lotes: uma reserva por lote e um lock por drenagem */
+    ModuloHandle lote[TAMANHO_LOTE_BACKLOG];
+    int enfileirados = 0;
+    double t3 = agora_seg();
+    while (enfileirados < n) {
+        int k = n - enfileirados < TAMANHO_LOTE_BACKLOG ? n - enfileirados : TAMANHO_LOTE_BACKLOG;
+        for (int i = 0; i < k; i++) {
+            lote[i] = pool_modulos_alocar();
+            Modulo* m = pool_modulos_obter(lote[i]);
+            m->id = enfileirados + i;
+            m->tipo = (enfileirados + i) % MODULO_TOTAL;
+        }
+        int aceitos = fila_modulos_adicionar_lote(fila, lote, k);
+        for (int i = aceitos; i < k; i++) pool_modulos_liberar(lote[i]);
+        enfileirados += aceitos;
+        if (aceitos < k) break;
+    }
+    double t4 = agora_seg();
+    removidos = 0;
+    int r;
+    while ((r = fila_modulos_remover_lote(fila, lote, TAMANHO_LOTE_BACKLOG)) > 0) {
+        for (int i = 0; i < r; i++) pool_modulos_liberar(lote[i]);
+        removidos += r;
+    }
+    double t5 = agora_seg();
+
+    printf("lotes de %d: enchimento %.2f Mops/s, drenagem %.2f Mops/s\n", TAMANHO_LOTE_BACKLOG,
+           enfileirados / (t4 - t3) / 1e6, removidos / (t5 - t4) / 1e6);
+
+    fila_modulos_destroy(fila);
+    free(fila);
+}
+
+/* ==================== POOL ==================== */
+
+#define CICLOS_POOL 2000000
+
+/* Impede o compilador de eliminar o malloc/free da referencia */
+static Modulo* volatile sumidouro;
+
+static void cenario_pool(void) {
+    FilaModulos fila;
+    fila_modulos_init(&fila, MAX_MODULOS_PENDENTES, false, FILA_FIFO);
+
+    GeradorAleatorio gerador;
+    aleatorio_semear(&gerador, 42, FLUXO_MURAL);
+
+    /* Aquecimento: deixa os caches e slabs no tamanho de regime */
+    for (int i = 0; i < 1000; i++) {
+        ModuloHandle h = pool_modulos_alocar();
+        gerar_modulo_aleatorio(&gerador, pool_modulos_obter(h), i, 1);
+        fila_modulos_adicionar(&fila, h);
+        fila_modulos_remover_por_tipo(&fila, pool_modulos_obter(h)->tipo, &h);
+        pool_modulos_liberar(h);
+    }
+
+    /* Ciclo completo da partida: gerar, enfileirar, retirar por tipo, liberar */
+    long heap_antes = pool_modulos_estatisticas().alocacoes_heap;
+    double t0 = agora_seg();
+    for (int i = 0; i < CICLOS_POOL; i++) {
+        ModuloHandle h = pool_modulos_alocar();
+        Modulo* m = pool_modulos_obter(h);
+        m->id = i;
+        m->tipo = i % MODULO_TOTAL;
+        fila_modulos_adicionar(&fila, h);
+        fila_modulos_remover_por_tipo(&fila, i % MODULO_TOTAL, &h);
+        pool_modulos_liberar(h);
+    }
+    double dt_ciclo = agora_seg() - t0;
+    long heap_depois = pool_modulos_estatisticas().alocacoes_heap;
+
+    /* Apenas o custo de obter e devolver um modulo */
+    t0 = agora_seg();
+    for (int i = 0; i < CICLOS_POOL; i++) {
+        ModuloHandle h = pool_modulos_alocar();
+        pool_modulos_obter(h)->id = i;
+        pool_modulos_liberar(h);
+    }
+    double dt_pool = agora_seg() - t0;
+
+    /* Referencia: copia por valor + malloc/free por designacao (versao anterior) */
+    Modulo origem;
+    memset(&origem, 0, sizeof(origem));
+    t0 = agora_seg();
+    for (int i = 0; i < CICLOS_POOL; i++) {
+        Modulo gerado = origem;
+        gerado.id = i;
+        Modulo* copia = malloc(sizeof(Modulo));
+        memcpy(copia, &gerado, sizeof(Modulo));
+        sumidouro = copia;
+        free(sumidouro);
+    }
+    double dt_malloc = agora_seg() - t0;
+
+    printf("=== Pool de modulos: %d ciclos ===\n", CICLOS_POOL);
+    printf("ciclo completo (fila + pool): %.1f ns/ciclo, alocacoes de heap no regime: %ld\n",
+           dt_ciclo / CICLOS_POOL * 1e9, heap_depois - heap_antes);
+    printf("pool alocar/liberar:          %.1f ns/ciclo\n", dt_pool / CICLOS_POOL * 1e9);
+    printf("malloc + copia + free:        %.1f ns/ciclo, alocacoes de heap: %d\n",
+           dt_malloc / CICLOS_POOL * 1e9, CICLOS_POOL);
+
+    fila_modulos_destroy(&fila);
+}
+
+/* ==================== EDF ==================== */
+
+#define MODULOS_EDF 20000
+#define TEDAX_EDF 3
+#define INTERVALO_CHEGADA_EDF 5     /* chegadas a cada 0..4 s: carga perto da saturacao */
+
+typedef struct {
+    int desarmados;
+    int perdidos;           /* Terminados depois do prazo */
+    long duracao;           /* Segundos virtuais ate esvaziar */
+    double ns_por_escolha;
+} ResultadoEDF;
+
+/*
+ * Simula a partida em tempo virtual (1 passo = 1 s): os modulos chegam com
+ * intervalos aleatorios e TEDAX_EDF tecnicos pegam o proximo da fila assim
+ * que ficam livres. A mesma semente gera a mesma carga para as duas politicas.
+ */
+static ResultadoEDF simular_politica(PoliticaFila politica, unsigned semente) {
+    ResultadoEDF r = { 0, 0, 0, 0.0 };
+    FilaModulos* fila = malloc(sizeof(FilaModulos));
+    if (!fila || fila_modulos_init(fila, MODULOS_EDF, true, politica) != 0) {
+        free(fila);
+        return r;
+    }
+
+    GeradorAleatorio gerador;
+    aleatorio_semear(&gerador, semente, FLUXO_MURAL);
+    long livre_em[TEDAX_EDF] = { 0 };
+    long proxima_chegada = 0;
+    int gerados = 0;
+    double tempo_escolha = 0.0;
+    int escolhas = 0;
+
+    for (long t = 0; gerados < MODULOS_EDF || !fila_modulos_vazia(fila); t++) {
+        while (gerados < MODULOS_EDF && proxima_chegada <= t) {
+            ModuloHandle h = pool_modulos_alocar();
+            Modulo* m = pool_modulos_obter(h);
+            gerar_modulo_aleatorio(&gerador, m, gerados, 1 + aleatorio_intervalo(&gerador, 3));
+            m->criado_em = t;
+            fila_modulos_adicionar(fila, h);
+            gerados++;
+            proxima_chegada += aleatorio_intervalo(&gerador, INTERVALO_CHEGADA_EDF);
+        }
+
+        for (int k = 0; k < TEDAX_EDF; k++) {
+            if (livre_em[k] > t) continue;
+
+            ModuloHandle h;
+            double t0 = agora_seg();
+            bool ok = fila_modulos_remover(fila, &h);
+            tempo_escolha += agora_seg() - t0;
+            if (!ok) break;
+            escolhas++;
+
+            Modulo* m = pool_modulos_obter(h);
+            livre_em[k] = t + m->tempo_resolucao;
+            if (livre_em[k] > modulo_prazo(m)) r.perdidos++;
+            r.desarmados++;
+            if (livre_em[k] > r.duracao) r.duracao = livre_em[k];
+            pool_modulos_liberar(h);
+        }
+    }
+
+    r.ns_por_escolha = escolhas > 0 ? tempo_escolha / escolhas * 1e9 : 0.0;
+    fila_modulos_destroy(fila);
+    free(fila);
+    return r;
+}
+
+static void cenario_edf(unsigned semente) {
+    static const struct { const char* nome; PoliticaFila politica; } politicas[] = {
+        { "fifo", FILA_FIFO },
+        { "edf",  FILA_EDF },
+    };
+
+    printf("=== FIFO vs. EDF: %d modulos, %d tedax, semente %u ===\n",
+           MODULOS_EDF, TEDAX_EDF, semente);
+    printf("%-8s %10s %10s %10s %14s %12s\n",
+           "politica", "desarmados", "perdidos", "perda (%)", "vazao (/min)", "ns/escolha");
+
+    for (size_t i = 0; i < sizeof(politicas) / sizeof(politicas[0]); i++) {
+        ResultadoEDF r = simular_politica(politicas[i].politica, semente);
+        int no_prazo = r.desarmados - r.perdidos;
+        printf("%-8s %10d %10d %10.2f %14.2f %12.1f\n", politicas[i].nome,
+               r.desarmados, r.perdidos,
+               r.desarmados > 0 ? 100.0 * r.perdidos / r.desarmados : 0.0,
+               r.duracao > 0 ? 60.0 * no_prazo / r.duracao : 0.0,
+               r.ns_por_escolha);
+    }
+    printf("(vazao = modulos desarmados dentro do prazo por minuto virtual)\n");
+}
+
+/* ==================== REMOCAO ==================== */
+
+#define REMOCOES_POR_PROFUNDIDADE 200000
+
+/* Referencia: vetor contiguo que desloca os posteriores (versao anterior) */
+typedef struct {
+    ModuloHandle* modulos;
+    int quantidade;
+    pthread_mutex_t mutex;
+} FilaVetor;
+
+static bool fila_vetor_remover_por_id(FilaVetor* fila, int id, ModuloHandle* modulo) {
+    pthread_mutex_lock(&fila->mutex);
+    for (int i = 0; i < fila->quantidade; i++) {
+        if (pool_modulos_obter(fila->modulos[i])->id == id) {
+            *modulo = fila->modulos[i];
+            memmove(&fila->modulos[i], &fila->modulos[i + 1],
+                    sizeof(ModuloHandle) * (fila->quantidade - i - 1));
+            fila->quantidade--;
+            pthread_mutex_unlock(&fila->mutex);
+            return true;
+        }
+    }
+    pthread_mutex_unlock(&fila->mutex);
+    return false;
+}
+
+static void fila_vetor_adicionar(FilaVetor* fila, ModuloHandle modulo) {
+    pthread_mutex_lock(&fila->mutex);
+    fila->modulos[fila->quantidade++] = modulo;
+    pthread_mutex_unlock(&fila->mutex);
+}
+
+/*
+ * Mantem 'profundidade' modulos na fila e, a cada passo, retira o modulo
+ * do meio (pela ordem de chegada) e o devolve ao fim, como um tedax que
+ * falhou. Retorna ns por remocao.
+ */
+static double medir_remocao_fila(int profundidade, int remocoes) {
+    FilaModulos* fila = malloc(sizeof(FilaModulos));
+    if (!fila || fila_modulos_init(fila, profundidade, false, FILA_FIFO) != 0) {
+        free(fila);
+        return 0.0;
+    }
+    for (int i = 0; i < profundidade; i++) {
+        ModuloHandle h = pool_modulos_alocar();
+        pool_modulos_obter(h)->id = i;
+        pool_modulos_obter(h)->tipo = i % MODULO_TOTAL;
+        fila_modulos_adicionar(fila, h);
+    }
+
+    double total = 0.0;
+    for (int r = 0; r < remocoes; r++) {
+        /*
+         * Retirar o do meio e devolve-lo ao fim so gira a metade final,
+         * entao o ID que esta na posicao do meio e sempre este
+         */
+        int id = profundidade / 2 + r % (profundidade - profundidade / 2);
+        ModuloHandle h = MODULO_HANDLE_NULO;
+        double t0 = agora_seg();
+        fila_modulos_remover_por_id(fila, id, &h);
+        total += agora_seg() - t0;
+        fila_modulos_adicionar(fila, h);
+    }
+
+    fila_modulos_limpar(fila);
+    fila_modulos_destroy(fila);
+    free(fila);
+    return total / remocoes * 1e9;
+}
+
+static double medir_remocao_vetor(int profundidade, int remocoes) {
+    FilaVetor fila;
+    fila.modulos = malloc(sizeof(ModuloHandle) * profundidade);
+    fila.quantidade = 0;
+    pthread_mutex_init(&fila.mutex, NULL);
+    for (int i = 0; i < profundidade; i++) {
+        ModuloHandle h = pool_modulos_alocar();
+        pool_modulos_obter(h)->id = i;
+        fila_vetor_adicionar(&fila, h);
+    }
+
+    double total = 0.0;
+    for (int r = 0; r < remocoes; r++) {
+        int id = profundidade / 2 + r % (profundidade - profundidade / 2);
+        ModuloHandle h = MODULO_HANDLE_NULO;
+        double t0 = agora_seg();
+        fila_vetor_remover_por_id(&fila, id, &h);
+        total += agora_seg() - t0;
+        fila_vetor_adicionar(&fila, h);
+    }
+
+    for (int i = 0; i < fila.quantidade; i++) pool_modulos_liberar(fila.modulos[i]);
+    pthread_mutex_destroy(&fila.mutex);
+    free(fila.modulos);
+    return total / remocoes * 1e9;
+}
+
+static void cenario_remocao(void) {
+    static const int profundidades[] = { 10, 1000, 100000 };
+
+    printf("=== Remocao por ID no meio da fila ===\n");
+    printf("%12s %16s %20s\n", "pendentes", "indice (ns)", "vetor+memmove (ns)");
+    for (size_t i = 0; i < sizeof(profundidades) / sizeof(profundidades[0]); i++) {
+        int p = profundidades[i];
+        /* A referencia e O(n): menos repeticoes nas filas grandes */
+        int remocoes_vetor = p >= 100000 ? 2000 : REMOCOES_POR_PROFUNDIDADE;
+        double ns_indice = medir_remocao_fila(p, REMOCOES_POR_PROFUNDIDADE);
+        double ns_vetor = medir_remocao_vetor(p, remocoes_vetor);
+        printf("%12d %16.1f %20.1f\n", p, ns_indice, ns_vetor);
+    }
+}
+
+/* ==================== ESPERA ==================== */
+
+#define MODULOS_ESPERA 200
+#define INTERVALO_ESPERA_US 3000
+#define POLLING_ESPERA_US 100000    /* o mesmo usleep(100000) do jogo */
+
+typedef struct {
+    FilaModulos* fila;
+    bool bloqueante;
+    double publicado_em[MODULOS_ESPERA];
+    double latencia[MODULOS_ESPERA];
+    double cpu_consumidor;
+} ArgEspera;
+
+static double cpu_thread_seg(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void* consumidor_espera(void* arg) {
+    ArgEspera* a = arg;
+    double cpu0 = cpu_thread_seg();
+
+    for (int recebidos = 0; recebidos < MODULOS_ESPERA; ) {
+        if (a->bloqueante) {
+            fila_modulos_aguardar_item(a->fila, 0);
+        } else if (fila_modulos_vazia(a->fila)) {
+            usleep(POLLING_ESPERA_US);
+            continue;
+        }
+
+        ModuloHandle h;
+        while (fila_modulos_remover(a->fila, &h)) {
+            int id = pool_modulos_obter(h)->id;
+            a->latencia[id] = agora_seg() - a->publicado_em[id];
+            pool_modulos_liberar(h);
+            recebidos++;
+        }
+    }
+
+    a->cpu_consumidor = cpu_thread_seg() - cpu0;
+    pool_modulos_devolver_cache();
+    return NULL;
+}
+
+static int comparar_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void medir_espera(bool bloqueante) {
+    ArgEspera* a = calloc(1, sizeof(ArgEspera));
+    a->fila = malloc(sizeof(FilaModulos));
+    a->bloqueante = bloqueante;
+    fila_modulos_init(a->fila, MODULOS_ESPERA, false, FILA_FIFO);
+
+    pthread_t consumidor;
+    pthread_create(&consumidor, NULL, consumidor_espera, a);
+
+    for (int i = 0; i < MODULOS_ESPERA; i++) {
+        usleep(INTERVALO_ESPERA_US);
+        ModuloHandle h = pool_modulos_alocar();
+        pool_modulos_obter(h)->id = i;
+        a->publicado_em[i] = agora_seg();
+        fila_modulos_adicionar(a->fila, h);
+    }
+    pthread_join(consumidor, NULL);
+
+    qsort(a->latencia, MODULOS_ESPERA, sizeof(double), comparar_double);
+    double soma = 0.0;
+    for (int i = 0; i < MODULOS_ESPERA; i++) soma += a->latencia[i];
+
+    printf("%-22s %14.1f %14.1f %16.2f\n",
+           bloqueante ? "aguardar_item" : "polling usleep(100ms)",
+           soma / MODULOS_ESPERA * 1e6, a->latencia[MODULOS_ESPERA * 99 / 100] * 1e6,
+           a->cpu_consumidor * 1e3);
+
+    fila_modulos_destroy(a->fila);
+    free(a->fila);
+    free(a);
+}
+
+static void cenario_espera(void) {
+    printf("=== Espera por modulos: %d publicacoes a cada %d us ===\n",
+           MODULOS_ESPERA, INTERVALO_ESPERA_US);
+    printf("%-22s %14s %14s %16s\n", "consumidor", "lat. media(us)", "lat. p99 (us)",
+           "CPU consum. (ms)");
+    medir_espera(true);
+    medir_espera(false);
+}
+
+int main(int argc, char* argv[]) {
+    const char* cenario = argc > 1 ? argv[1] : "contencao";
+
+    if (pool_modulos_init() != 0) {
+        fprintf(stderr, "Falha ao iniciar o pool de modulos\n");
+        return 1;
+    }
+
+    if (strcmp(cenario, "contencao") == 0) {
+        cenario_contencao();
+    } else if (strcmp(cenario, "backlog") == 0) {
+        int n = argc > 2 ? atoi(argv[2]) : 1000000;
+        bool crescente = argc > 3 && strcmp(argv[3], "cresce") == 0;
+        cenario_backlog(n > 0 ? n : 1000000, crescente);
+    } else if (strcmp(cenario, "pool") == 0) {
+        cenario_pool();
+    } else if (strcmp(cenario, "espera") == 0) {
+        cenario_espera();
+    } else if (strcmp(cenario, "remocao") == 0) {
+        cenario_remocao();
+    } else if (strcmp(cenario, "edf") == 0) {
+        cenario_edf(argc > 2 ? (unsigned)strtoul(argv[2], NULL, 10) : 42u);
+    } else {
+        fprintf(stderr, "Cenario desconhecido: %s\n", cenario);
+        pool_modulos_destroy();
+        return 1;
+    }
+
+    pool_modulos_destroy();
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * bench_instrucao.c - Conferencia de instrucoes: texto x 2 bits por simbolo
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_instrucao [pares=65536] [repeticoes=200]
+ *
+ * Gera 'pares' modulos aleatorios e uma instrucao recebida para cada um
+ * (metade certa, metade com um simbolo trocado ou com outro tipo) e
+ * confere todos os pares 'repeticoes' vezes:
+ *
+ *   strcmp    instrucao em char[64] dentro do modulo, como antes
+ *   conferir  instrucao_conferir no modulo codificado, par a par
+ *   lote      instrucao_verificar_lote sobre vetores contiguos (SIMD)
+ *
+ * O lote usa SSE2 por padrao (AVX2 se instrucao.c for compilado com
+ * -mavx2). Os objetos do jogo saem sem otimizacao no make padrao; para
+ * medir o lote como ele roda otimizado use make release antes de make bench.
+ */
+
+#include "../include/tipos.h"
+#include "../include/modulos.h"
+#include "../include/instrucao.h"
+#include "../include/aleatorio.h"
+#include "../include/metricas.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define PARES_PADRAO 65536
+#define REPETICOES_PADRAO 200
+#define TAMANHO_TEXTO_ANTIGO 64
+
+/* Modulo com a instrucao em texto, do tamanho do layout antigo */
+typedef struct {
+    Modulo modulo;
+    char instrucao[TAMANHO_TEXTO_ANTIGO];
+} ModuloTexto;
+
+/* Evita que o compilador descarte as conferencias */
+static volatile long sumidouro;
+
+static double medir_strcmp(const ModuloTexto* modulos, char (*recebidas)[TAMANHO_TEXTO_ANTIGO], int n, int repeticoes,
+                           long* conferem) {
+    long long inicio = relogio_ns();
+    long total = 0;
+    for (int r = 0; r < repeticoes; r++) {
+        for (int i = 0; i < n; i++) total += strcmp(modulos[i].instrucao, recebidas[i]) == 0;
+    }
+    sumidouro += total;
+    *conferem = total / repeticoes;
+    return (relogio_ns() - inicio) / ((double)n * repeticoes);
+}
+
+static double medir_conferir(const Modulo* modulos, const InstrucaoCodificada* recebidas, int n, int repeticoes,
+                             long* conferem) {
+    long long inicio = relogio_ns();
+    long total = 0;
+    for (int r = 0; r < repeticoes; r++) {
+        for (int i = 0; i < n; i++) total += instrucao_conferir(&modulos[i].instrucao, &recebidas[i]);
+    }
+    sumidouro += total;
+    *conferem = total / repeticoes;
+    return (relogio_ns() - inicio) / ((double)n * repeticoes);
+}
+
+static double medir_lote(const InstrucaoCodificada* esperadas, const InstrucaoCodificada* recebidas, int n,
+                         int repeticoes, uint8_t* resultados, long* conferem) {
+    long long inicio = relogio_ns();
+    long total = 0;
+    for (int r = 0; r < repeticoes; r++) total += instrucao_verificar_lote(esperadas, recebidas, n, resultados);
+    sumidouro += total;
+    *conferem = total / repeticoes;
+    return (relogio_ns() - inicio) / ((double)n * repeticoes);
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : PARES_PADRAO;
+    int repeticoes = argc > 2 ? atoi(argv[2]) : REPETICOES_PADRAO;
+    if (n < 1) n = PARES_PADRAO;
+    if (repeticoes < 1) repeticoes = REPETICOES_PADRAO;
+
+    Modulo* modulos = malloc(sizeof(Modulo) * n);
+    ModuloTexto* antigos = malloc(sizeof(ModuloTexto) * n);
+    InstrucaoCodificada* esperadas = malloc(sizeof(InstrucaoCodificada) * n);
+    InstrucaoCodificada* recebidas = malloc(sizeof(InstrucaoCodificada) * n);
+    char (*textos)[TAMANHO_TEXTO_ANTIGO] = malloc(sizeof(*textos) * n);
+    uint8_t* resultados = malloc(n);
+    if (!modulos || !antigos || !esperadas || !recebidas || !textos || !resultados) {
+        fprintf(stderr, "Sem memoria\n");
+        return 1;
+    }
+
+    GeradorAleatorio gerador;
+    aleatorio_semear(&gerador, 42, FLUXO_MURAL);
+    for (int i = 0; i < n; i++) {
+        gerar_modulo_aleatorio(&gerador, &modulos[i], i + 1, 1 + aleatorio_intervalo(&gerador, 3));
+        esperadas[i] = modulos[i].instrucao;
+        antigos[i].modulo = modulos[i];
+        instrucao_decodificar(&modulos[i].instrucao, antigos[i].instrucao, TAMANHO_TEXTO_ANTIGO);
+
+        /* Metade certa; a outra com um simbolo trocado ou digitada como outro tipo */
+        InstrucaoCodificada r = modulos[i].instrucao;
+        if (aleatorio_intervalo(&gerador, 2)) {
+            int pos = aleatorio_intervalo(&gerador, (int)r.tamanho);
+            int alfabeto = instrucao_tamanho_alfabeto((TipoModulo)r.tipo);
+            if (alfabeto > 1) r.simbolos ^= (uint64_t)(1 + aleatorio_intervalo(&gerador, alfabeto - 1)) << (2 * pos);
+            else r.tipo = (r.tipo + 1) % MODULO_TOTAL;
+        }
+        recebidas[i] = r;
+        instrucao_decodificar(&r, textos[i], TAMANHO_TEXTO_ANTIGO);
+    }
+
+    const char* simd =
+#if defined(__AVX2__)
+        "AVX2";
+#elif defined(__SSE2__)
+        "SSE2";
+#else
+        "escalar";
+#endif
+
+    printf("=== %d pares, %d repeticoes, lote com %s ===\n", n, repeticoes, simd);
+    printf("Modulo: %zu bytes com instrucao de 2 bits (%zu bytes) x %zu com char[%d]\n\n", sizeof(Modulo),
+           sizeof(InstrucaoCodificada), sizeof(ModuloTexto) - sizeof(InstrucaoCodificada), TAMANHO_TEXTO_ANTIGO);
+
+    long c_strcmp, c_conferir, c_lote;
+    double ns_strcmp = medir_strcmp(antigos, textos, n, repeticoes, &c_strcmp);
+    double ns_conferir = medir_conferir(modulos, recebidas, n, repeticoes, &c_conferir);
+    double ns_lote = medir_lote(esperadas, recebidas, n, repeticoes, resultados, &c_lote);
+
+    printf("%-9s %10s %14s %10s\n", "metodo", "ns/par", "pares/s", "conferem");
+    printf("%-9s %10.2f %14.0f %10ld\n", "strcmp", ns_strcmp, 1e9 / ns_strcmp, c_strcmp);
+    printf("%-9s %10.2f %14.0f %10ld\n", "conferir", ns_conferir, 1e9 / ns_conferir, c_conferir);
+    printf("%-9s %10.2f %14.0f %10ld\n", "lote", ns_lote, 1e9 / ns_lote, c_lote);
+    if (c_strcmp != c_conferir || c_conferir != c_lote) {
+        printf("ERRO: os metodos discordam\n");
+        return 1;
+    }
+
+    free(modulos);
+    free(antigos);
+    free(esperadas);
+    free(recebidas);
+    free(textos);
+    free(resultados);
+    return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * bench_layout.c - Falso compartilhamento entre bancadas vizinhas
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_layout [segundos=1]
+ *
+ * Cada thread martela so a sua bancada (trava, marca ocupada com o seu
+ * tedax e modulo, destrava, e o mesmo para liberar), como um tedax que
+ * nunca disputa bancada com ninguem. Qualquer custo extra com mais
+ * threads vem de linhas de cache divididas entre bancadas vizinhas:
+ *
+ *   compacta  a Bancada antiga, sem alinhamento (os campos em sequencia,
+ *             a bancada seguinte comecando no meio da linha)
+ *   alinhada  a Bancada de tipos.h (grupo quente em linha propria)
+ *
+ * Antes de medir, faz a conta que o perf c2c faria na mao: quantas linhas
+ * de cache tocadas pelo grupo quente de uma bancada sao tocadas tambem
+ * pelo de outra. Reporta ciclos (ocupar + liberar) por segundo, no total
+ * e por thread.
+ */
+
+#include "../include/tipos.h"
+#include "../include/metricas.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define SEGUNDOS_PADRAO 1
+#define MAX_THREADS 16
+
+/* Layout anterior da Bancada, campo a campo */
+typedef struct {
+    int id;
+    Estado estado;
+    ModuloHandle modulo_atual;
+    int tedax_id;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond_livre;
+    EsperaBancada* fila_inicio;
+    EsperaBancada* fila_fim;
+    int esperando;
+    MapaBancadas* mapa;
+} BancadaCompacta;
+
+typedef struct {
+    int id;
+    bool alinhada;
+    long operacoes;
+} Participante;
+
+static BancadaCompacta* compactas;
+static Bancada* alinhadas;
+static atomic_bool rodando;
+
+/* Linha de cache de um endereco */
+static uintptr_t linha(const void* p) {
+    return (uintptr_t)p / TAMANHO_LINHA_CACHE;
+}
+
+/*
+ * Linhas tocadas pelos campos quentes (estado ate esperando) de mais de
+ * uma bancada: para cada vizinha, compara a faixa de linhas de uma com a
+ * da outra.
+ */
+static int linhas_disputadas(const char* base, size_t tamanho, size_t quente_inicio, size_t quente_fim, int n) {
+    int disputadas = 0;
+    for (int i = 0; i + 1 < n; i++) {
+        uintptr_t fim_i = linha(base + tamanho * i + quente_fim - 1);
+        uintptr_t inicio_prox = linha(base + tamanho * (i + 1) + quente_inicio);
+        if (fim_i >= inicio_prox) disputadas++;
+    }
+    return disputadas;
+}
+
+static void ciclo_compacta(BancadaCompacta* b, int tedax, int k) {
+    pthread_mutex_lock(&b->mutex);
+    b->estado = ESTADO_OCUPADO;
+    b->tedax_id = tedax;
+    b->modulo_atual = (ModuloHandle)k;
+    pthread_mutex_unlock(&b->mutex);
+    pthread_mutex_lock(&b->mutex);
+    b->estado = ESTADO_LIVRE;
+    b->tedax_id = -1;
+    b->modulo_atual = MODULO_HANDLE_NULO;
+    pthread_mutex_unlock(&b->mutex);
+}
+
+static void ciclo_alinhada(Bancada* b, int tedax, int k) {
+    pthread_mutex_lock(&b->mutex);
+    b->estado = ESTADO_OCUPADO;
+    b->tedax_id = tedax;
+    b->modulo_atual = (ModuloHandle)k;
+    pthread_mutex_unlock(&b->mutex);
+    pthread_mutex_lock(&b->mutex);
+    b->estado = ESTADO_LIVRE;
+    b->tedax_id = -1;
+    b->modulo_atual = MODULO_HANDLE_NULO;
+    pthread_mutex_unlock(&b->mutex);
+}
+
+static void* participar(void* arg) {
+    Participante* p = (Participante*)arg;
+    int k = 0;
+    while (atomic_load_explicit(&rodando, memory_order_relaxed)) {
+        for (int i = 0; i < 256; i++, k++) {
+            if (p->alinhada) ciclo_alinhada(&alinhadas[p->id], p->id, k);
+            else ciclo_compacta(&compactas[p->id], p->id, k);
+        }
+        p->operacoes += 256;
+    }
+    return NULL;
+}
+
+static void medir(int threads, bool alinhada, int segundos) {
+    Participante participantes[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    atomic_store(&rodando, true);
+    long long inicio = relogio_ns();
+    for (int i = 0; i < threads; i++) {
+        participantes[i] = (Participante){ .id = i, .alinhada = alinhada };
+        pthread_create(&ids[i], NULL, participar, &participantes[i]);
+    }
+    struct timespec espera = { segundos, 0 };
+    nanosleep(&espera, NULL);
+    atomic_store(&rodando, false);
+    long operacoes = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        operacoes += participantes[i].operacoes;
+    }
+    double duracao = (relogio_ns() - inicio) / 1e9;
+    printf("%7d %-9s %14.0f %14.0f\n", threads, alinhada ? "alinhada" : "compacta", operacoes / duracao,
+           operacoes / duracao / threads);
+}
+
+int main(int argc, char* argv[]) {
+    int segundos = argc > 1 ? atoi(argv[1]) : SEGUNDOS_PADRAO;
+    if (segundos < 1) segundos = SEGUNDOS_PADRAO;
+
+    /* A compacta vem de malloc, como o vetor antigo; a alinhada, como jogo_dimensionar */
+    compactas = malloc(sizeof(BancadaCompacta) * MAX_THREADS);
+    alinhadas = aligned_alloc(TAMANHO_LINHA_CACHE, sizeof(Bancada) * MAX_THREADS);
+    if (!compactas || !alinhadas) {
+        fprintf(stderr, "Sem memoria\n");
+        return 1;
+    }
+    for (int i = 0; i < MAX_THREADS; i++) {
+        compactas[i] = (BancadaCompacta){ .id = i, .tedax_id = -1, .modulo_atual = MODULO_HANDLE_NULO };
+        pthread_mutex_init(&compactas[i].mutex, NULL);
+        alinhadas[i] = (Bancada){ .id = i, .tedax_id = -1, .modulo_atual = MODULO_HANDLE_NULO };
+        pthread_mutex_init(&alinhadas[i].mutex, NULL);
+    }
+
+    printf("=== Layout: %d bancadas vizinhas, uma por thread ===\n", MAX_THREADS);
+    printf("%-9s %8s %18s %18s\n", "layout", "bytes", "linhas/bancada", "linhas disputadas");
+    printf("%-9s %8zu %18zu %15d/%d\n", "compacta", sizeof(BancadaCompacta),
+           (sizeof(BancadaCompacta) + TAMANHO_LINHA_CACHE - 1) / TAMANHO_LINHA_CACHE,
+           linhas_disputadas((const char*)compactas, sizeof(BancadaCompacta), offsetof(BancadaCompacta, estado),
+                             offsetof(BancadaCompacta, mapa), MAX_THREADS),
+           MAX_THREADS - 1);
+    printf("%-9s %8zu %18zu %15d/%d\n", "alinhada", sizeof(Bancada), sizeof(Bancada) / TAMANHO_LINHA_CACHE,
+           linhas_disputadas((const char*)alinhadas, sizeof(Bancada), offsetof(Bancada, mutex), sizeof(Bancada),
+                             MAX_THREADS),
+           MAX_THREADS - 1);
+    printf("(Tedax: %zu bytes, %zu linhas)\n\n", sizeof(Tedax), sizeof(Tedax) / TAMANHO_LINHA_CACHE);
+
+    printf("%7s %-9s %14s %14s\n", "threads", "layout", "ciclos/s", "ciclos/s/thr");
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        medir(threads, false, segundos);
+        medir(threads, true, segundos);
+    }
+
+    for (int i = 0; i < MAX_THREADS; i++) {
+        pthread_mutex_destroy(&compactas[i].mutex);
+        pthread_mutex_destroy(&alinhadas[i].mutex);
+    }
+    free(compactas);
+    free(alinhadas);
+    return 0;
+}
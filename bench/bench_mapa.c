@@ -0,0 +1,146 @@
+/*
+ * bench_mapa.c - Bancada livre: laco de mutexes x bitmap atomico
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_mapa [threads=4] [segundos=1]
+ *
+ * Para 5 a 4096 bancadas, quase todas ocupadas por um dono fixo, as
+ * threads reservam uma bancada livre a partir da "sua" e a liberam logo
+ * em seguida, enquanto a thread principal conta as ocupadas sem parar
+ * (como a tela faz):
+ *
+ *   travas  bancada_ocupar em cada bancada ate achar uma livre (o laco
+ *           antigo do tedax) e contagem travando bancada por bancada
+ *   mapa    mapa_bancadas_reservar (find-first-set + CAS) e popcount
+ *
+ * Reporta reservas por segundo e o custo de cada contagem.
+ */
+
+#include "../include/tipos.h"
+#include "../include/bancada.h"
+#include "../include/metricas.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define THREADS_PADRAO 4
+#define SEGUNDOS_PADRAO 1
+#define MAX_THREADS 64
+#define DONO_FIXO (-2)              /* Ocupa as bancadas que nunca liberam */
+
+typedef struct {
+    int id;
+    int inicio;                     /* Primeira bancada tentada */
+    bool usar_mapa;
+    long reservas;
+} Participante;
+
+static Bancada* bancadas;
+static int num_bancadas;
+static MapaBancadas mapa;
+static atomic_bool rodando;
+
+/* O laco antigo: tenta ocupar cada bancada a partir de 'inicio' */
+static int reservar_travando(int inicio, int tedax_id) {
+    for (int i = 0; i < num_bancadas; i++) {
+        int b = (inicio + i) % num_bancadas;
+        if (bancada_ocupar(&bancadas[b], tedax_id, MODULO_HANDLE_NULO)) return b;
+    }
+    return -1;
+}
+
+static void* participar(void* arg) {
+    Participante* p = (Participante*)arg;
+    while (atomic_load_explicit(&rodando, memory_order_relaxed)) {
+        int b = p->usar_mapa
+                    ? mapa_bancadas_reservar(&mapa, num_bancadas, p->inicio, -1, p->id, MODULO_HANDLE_NULO)
+                    : reservar_travando(p->inicio, p->id);
+        if (b < 0) continue;
+        bancada_liberar(&bancadas[b], p->id);
+        p->reservas++;
+    }
+    return NULL;
+}
+
+/* Deixa 'livres' bancadas espalhadas livres e ocupa as outras para sempre */
+static void preparar(int n, int livres, bool usar_mapa) {
+    num_bancadas = n;
+    bancadas = aligned_alloc(TAMANHO_LINHA_CACHE, sizeof(Bancada) * n);
+    if (!bancadas) {
+        fprintf(stderr, "Sem memoria para %d bancadas\n", n);
+        exit(1);
+    }
+    int passo = livres < n ? n / livres : 1;
+    for (int i = 0; i < n; i++) {
+        bancada_init(&bancadas[i], i);
+        if (i % passo != passo - 1) bancada_ocupar(&bancadas[i], DONO_FIXO, MODULO_HANDLE_NULO);
+    }
+    if (usar_mapa && mapa_bancadas_init(&mapa, bancadas, n) != 0) {
+        fprintf(stderr, "Falha ao criar o mapa\n");
+        exit(1);
+    }
+}
+
+static void encerrar(bool usar_mapa) {
+    if (usar_mapa) mapa_bancadas_destroy(&mapa);
+    for (int i = 0; i < num_bancadas; i++) bancada_destroy(&bancadas[i]);
+    free(bancadas);
+    bancadas = NULL;
+}
+
+static void medir(int n, bool usar_mapa, int threads, int segundos) {
+    int livres = threads * 2;
+    preparar(n, livres, usar_mapa);
+
+    Participante participantes[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    atomic_store(&rodando, true);
+    for (int i = 0; i < threads; i++) {
+        participantes[i] = (Participante){ .id = i, .inicio = (int)((long)i * n / threads),
+                                           .usar_mapa = usar_mapa };
+        pthread_create(&ids[i], NULL, participar, &participantes[i]);
+    }
+
+    long contagens = 0;
+    long long ocupadas = 0;
+    long long inicio = relogio_ns();
+    long long fim = inicio + segundos * 1000000000LL;
+    long long agora = inicio;
+    while (agora < fim) {
+        for (int k = 0; k < 64; k++) ocupadas += contar_bancadas_ocupadas(bancadas, n);
+        contagens += 64;
+        agora = relogio_ns();
+    }
+    atomic_store(&rodando, false);
+    long reservas = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        reservas += participantes[i].reservas;
+    }
+    double duracao = (agora - inicio) / 1e9;
+
+    printf("%8d %7d %-7s %14.0f %14.0f %12.1f %10.1f\n", n, n < livres ? n : livres,
+           usar_mapa ? "mapa" : "travas", reservas / duracao, contagens / duracao,
+           (agora - inicio) / (double)contagens, (double)ocupadas / contagens);
+    encerrar(usar_mapa);
+}
+
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? atoi(argv[1]) : THREADS_PADRAO;
+    int segundos = argc > 2 ? atoi(argv[2]) : SEGUNDOS_PADRAO;
+    if (threads < 1 || threads > MAX_THREADS) threads = THREADS_PADRAO;
+    if (segundos < 1) segundos = SEGUNDOS_PADRAO;
+
+    printf("=== %d threads reservando e liberando, %d s por medida ===\n", threads, segundos);
+    printf("%8s %7s %-7s %14s %14s %12s %10s\n", "bancadas", "livres", "modo", "reservas/s", "contagens/s",
+           "ns/contagem", "ocupadas");
+
+    int tamanhos[] = { 5, 64, 1024, 4096 };
+    for (size_t k = 0; k < sizeof(tamanhos) / sizeof(tamanhos[0]); k++) {
+        medir(tamanhos[k], false, threads, segundos);
+        medir(tamanhos[k], true, threads, segundos);
+    }
+    return 0;
+}
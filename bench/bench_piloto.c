@@ -0,0 +1,186 @@
+/*
+ * bench_piloto.c - Piloto automatico: concordancia e taxa maxima sustentavel
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_piloto [partidas_reais=3] [sementes=20]
+ *
+ * concordancia  joga partidas reais sem ncurses com o piloto (uma por
+ *               politica, 3 tedax disputando 2 bancadas) e repete cada uma
+ *               com simulacao_executar e a mesma semente
+ * capacidade    para cada configuracao (tedax x bancadas) e politica,
+ *               busca binaria da maior taxa Poisson em que ao menos 90%
+ *               das 'sementes' partidas de 10 min (modo infinito, fila de
+ *               10) terminam sem fila cheia; mostra a taxa em modulos/s e
+ *               a vazao de desarmados nessa taxa. Roda em tempo virtual,
+ *               com as mesmas escolhas do piloto da partida real.
+ */
+
+#include "../include/tipos.h"
+#include "../include/jogo.h"
+#include "../include/simulacao.h"
+#include "../include/piloto.h"
+#include "../include/metricas.h"
+#include "../include/modulos.h"
+#include "../include/tedax.h"
+#include "../include/bancada.h"
+#include "../include/pool_modulos.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define REAIS_PADRAO 3
+#define SEMENTES_PADRAO 20
+#define SEMENTE_BASE 2000
+#define TEMPO_CAPACIDADE 600
+#define FILA_CAPACIDADE 10
+#define SOBREVIVENCIA_MINIMA 0.9
+#define TAXA_MAXIMA_BUSCA 240.0     /* modulos/min */
+#define PRECISAO_BUSCA 0.25
+
+static EstadoJogoCompleto estado;
+
+static const int configuracoes[][2] = { { 1, 1 }, { 2, 1 }, { 2, 2 }, { 3, 2 }, { 3, 3 } };
+#define NUM_CONFIGURACOES ((int)(sizeof(configuracoes) / sizeof(configuracoes[0])))
+
+static ConfigJogo config_concordancia(PoliticaPiloto politica, uint64_t semente) {
+    ConfigJogo config = config_padrao();
+    config.num_tedax = 3;
+    config.num_bancadas = 2;
+    config.tempo_partida = 30;
+    config.dificuldade = 2;
+    config.modulos_para_vencer = 50;
+    config.modelo_chegada = CHEGADA_POISSON;
+    config.taxa_chegada = 30.0;
+    config.piloto = politica;
+    config.semente = semente;
+    return config;
+}
+
+/* Partida real ate o timer decidir; devolve no mesmo formato da simulacao */
+static void jogar_real(const ConfigJogo* config, ResultadoSimulacao* r) {
+    pthread_mutex_lock(&estado.mutex_estado);
+    memcpy(&estado.config, config, sizeof(ConfigJogo));
+    config_normalizar(&estado.config);
+    pthread_mutex_unlock(&estado.mutex_estado);
+    estado.executando = true;
+    jogo_iniciar_partida(&estado);
+
+    pthread_mutex_lock(&estado.mutex_estado);
+    while (estado.estado == JOGO_RODANDO) {
+        pthread_cond_wait(&estado.cond_estado, &estado.mutex_estado);
+    }
+    memset(r, 0, sizeof(ResultadoSimulacao));
+    r->semente = estado.semente;
+    r->estado_final = estado.estado;
+    memcpy(r->motivo, estado.motivo_final, sizeof(r->motivo));
+    r->segundos = estado.config.tempo_partida - estado.stats.tempo_restante;
+    r->stats = estado.stats;
+    jogo_somar_contadores(&estado, &r->stats);
+    pthread_mutex_unlock(&estado.mutex_estado);
+
+    jogo_parar_partida(&estado);
+}
+
+static bool iguais(const ResultadoSimulacao* a, const ResultadoSimulacao* b) {
+    return a->estado_final == b->estado_final && strcmp(a->motivo, b->motivo) == 0 &&
+           a->segundos == b->segundos && a->stats.modulos_gerados == b->stats.modulos_gerados &&
+           a->stats.modulos_desarmados == b->stats.modulos_desarmados;
+}
+
+static void imprimir(const char* origem, const ResultadoSimulacao* r) {
+    printf("  %-7s %-8s %3d s  gerados %3d  desarmados %3d  (%s)\n", origem,
+           r->estado_final == JOGO_VITORIA ? "vitoria" : "derrota", r->segundos,
+           r->stats.modulos_gerados, r->stats.modulos_desarmados, r->motivo);
+}
+
+/* Fracao das partidas sem fila cheia na taxa dada; 'vazao' recebe desarmados/s medios */
+static double sobrevivencia(int num_tedax, int num_bancadas, PoliticaPiloto politica, double taxa, int sementes,
+                            double* vazao) {
+    ConfigJogo config = config_padrao();
+    config.num_tedax = num_tedax;
+    config.num_bancadas = num_bancadas;
+    config.tempo_partida = TEMPO_CAPACIDADE;
+    config.modo_infinito = true;
+    config.capacidade_fila = FILA_CAPACIDADE;
+    config.modelo_chegada = CHEGADA_POISSON;
+    config.taxa_chegada = taxa;
+    config.piloto = politica;
+
+    int vivas = 0;
+    double desarmados_por_s = 0;
+    for (int i = 0; i < sementes; i++) {
+        ResultadoSimulacao r;
+        if (simulacao_executar(&config, SEMENTE_BASE + (uint64_t)i, &r) != 0) continue;
+        if (strncmp(r.motivo, "Fila cheia", 10) != 0) vivas++;
+        if (r.segundos > 0) desarmados_por_s += (double)r.stats.modulos_desarmados / r.segundos;
+    }
+    if (vazao) *vazao = desarmados_por_s / sementes;
+    return (double)vivas / sementes;
+}
+
+int main(int argc, char* argv[]) {
+    int reais = argc > 1 ? atoi(argv[1]) : REAIS_PADRAO;
+    int sementes = argc > 2 ? atoi(argv[2]) : SEMENTES_PADRAO;
+    if (reais < 0) reais = REAIS_PADRAO;
+    if (sementes < 1) sementes = SEMENTES_PADRAO;
+
+    ConfigJogo padrao = config_padrao();
+    if (jogo_init(&estado, &padrao) != 0) {
+        fprintf(stderr, "Falha ao iniciar o jogo\n");
+        return 1;
+    }
+    jogo = &estado;
+
+    printf("=== Concordancia: %d partidas reais com o piloto x simulacao ===\n", reais);
+    int concordantes = 0;
+    for (int i = 0; i < reais; i++) {
+        PoliticaPiloto politica = PILOTO_FIFO + i % (PILOTO_TOTAL - PILOTO_FIFO);
+        ConfigJogo config = config_concordancia(politica, SEMENTE_BASE + (uint64_t)i);
+        ResultadoSimulacao real, virtual;
+        jogar_real(&config, &real);
+        simulacao_executar(&config, config.semente, &virtual);
+        bool ok = iguais(&real, &virtual);
+        concordantes += ok;
+        printf("%s, semente %llu: %s\n", piloto_nome_politica(politica), (unsigned long long)config.semente,
+               ok ? "iguais" : "DIFERENTES");
+        imprimir("real", &real);
+        imprimir("virtual", &virtual);
+    }
+    if (reais > 0) printf("%d/%d iguais\n\n", concordantes, reais);
+
+    /* jogo_finalizar pararia a partida de novo; as threads ja foram unidas */
+    jogo = NULL;
+    fila_modulos_limpar(&estado.fila_modulos);
+    jogo_liberar_elementos(&estado);
+    fila_modulos_destroy(&estado.fila_modulos);
+    pool_modulos_destroy();
+    pthread_mutex_destroy(&estado.mutex_estado);
+    pthread_mutex_destroy(&estado.mutex_display);
+    pthread_mutex_destroy(&estado.mutex_comando);
+    pthread_cond_destroy(&estado.cond_fim_jogo);
+    pthread_cond_destroy(&estado.cond_estado);
+
+    printf("=== Capacidade: taxa maxima com %.0f%% de %d partidas de %d s sem fila cheia ===\n",
+           SOBREVIVENCIA_MINIMA * 100, sementes, TEMPO_CAPACIDADE);
+    printf("%5s %8s %7s %12s %10s %14s\n", "tedax", "bancadas", "piloto", "modulos/min", "modulos/s",
+           "desarmados/s");
+    long long inicio = relogio_ns();
+    for (int c = 0; c < NUM_CONFIGURACOES; c++) {
+        for (int p = PILOTO_FIFO; p < PILOTO_TOTAL; p++) {
+            int t = configuracoes[c][0], b = configuracoes[c][1];
+            double baixa = 0, alta = TAXA_MAXIMA_BUSCA;
+            while (alta - baixa > PRECISAO_BUSCA) {
+                double meio = (baixa + alta) / 2;
+                if (sobrevivencia(t, b, p, meio, sementes, NULL) >= SOBREVIVENCIA_MINIMA) baixa = meio;
+                else alta = meio;
+            }
+            double vazao = 0;
+            if (baixa > 0) sobrevivencia(t, b, p, baixa, sementes, &vazao);
+            printf("%5d %8d %7s %12.2f %10.3f %14.3f\n", t, b, piloto_nome_politica(p), baixa, baixa / 60, vazao);
+        }
+    }
+    printf("(busca em %.1f s)\n", (relogio_ns() - inicio) / 1e9);
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * bench_retrato.c - Leitura da tela: trylock nos mutexes x retratos (seqlock)
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_retrato [tedax=8] [segundos=1] [quadro_us=1000]
+ *
+ * Cada thread do motor faz o papel de um tedax em laco, pelos caminhos
+ * reais: ocupa a sua bancada, muda o proprio estado, conta um desarmado
+ * no seu contador, manda a mensagem de feedback e libera a bancada,
+ * publicando os retratos como o jogo.
+ * A thread principal desenha um quadro a cada 'quadro_us' lendo status,
+ * tedax e bancadas de dois jeitos:
+ *
+ *   travas   como a tela antiga: trylock em mutex_estado e no mutex de
+ *            cada tedax e bancada; painel (ou coluna) com a trava ocupada
+ *            nao e desenhado
+ *   retrato  jogo_ler_status, tedax_ler_retrato e bancada_ler_retrato,
+ *            sem travar nada
+ *
+ * Reporta paineis pulados, o tempo por quadro com travas seguradas (ou
+ * lendo retratos) em p50/p99/max, releituras e ciclos do motor por segundo.
+ */
+
+#include "../include/tipos.h"
+#include "../include/jogo.h"
+#include "../include/modulos.h"
+#include "../include/tedax.h"
+#include "../include/bancada.h"
+#include "../include/pool_modulos.h"
+#include "../include/metricas.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define TEDAX_PADRAO 8
+#define SEGUNDOS_PADRAO 1
+#define QUADRO_US_PADRAO 1000
+#define MAX_THREADS 64
+
+static EstadoJogoCompleto estado;
+static atomic_bool rodando;
+static atomic_long ciclos;
+
+/* Um tedax do motor: a bancada de mesmo indice, estado e contadores publicados */
+static void* motor(void* arg) {
+    Tedax* t = (Tedax*)arg;
+    Bancada* b = &estado.bancadas[t->id];
+    long feitos = 0;
+    while (atomic_load_explicit(&rodando, memory_order_relaxed)) {
+        bancada_ocupar(b, t->id, MODULO_HANDLE_NULO);
+        pthread_mutex_lock(&t->mutex);
+        t->estado = ESTADO_OCUPADO;
+        tedax_publicar(t);
+        pthread_mutex_unlock(&t->mutex);
+
+        atomic_fetch_add_explicit(&t->modulos_desarmados, 1, memory_order_relaxed);
+        jogo_feedback(&estado, "Tedax %d desarmou", t->id + 1);
+
+        bancada_liberar(b, t->id);
+        pthread_mutex_lock(&t->mutex);
+        t->estado = ESTADO_LIVRE;
+        tedax_publicar(t);
+        pthread_mutex_unlock(&t->mutex);
+        feitos++;
+    }
+    atomic_fetch_add(&ciclos, feitos);
+    return NULL;
+}
+
+/* A leitura da tela antiga; devolve os ns com travas seguradas e soma os pulados */
+static long long ler_com_travas(int n, long* pulados) {
+    long long segurando = 0;
+    volatile int soma = 0;
+    if (pthread_mutex_trylock(&estado.mutex_estado) == 0) {
+        long long inicio = relogio_ns();
+        Estatisticas stats = estado.stats;
+        soma += stats.modulos_desarmados + stats.tempo_restante;
+        segurando += relogio_ns() - inicio;
+        pthread_mutex_unlock(&estado.mutex_estado);
+    } else {
+        (*pulados)++;
+    }
+    for (int i = 0; i < n; i++) {
+        Tedax* t = &estado.tedax[i];
+        if (pthread_mutex_trylock(&t->mutex) == 0) {
+            long long inicio = relogio_ns();
+            soma += t->estado + atomic_load_explicit(&t->modulos_desarmados, memory_order_relaxed);
+            segurando += relogio_ns() - inicio;
+            pthread_mutex_unlock(&t->mutex);
+        } else {
+            (*pulados)++;
+        }
+        Bancada* b = &estado.bancadas[i];
+        if (pthread_mutex_trylock(&b->mutex) == 0) {
+            long long inicio = relogio_ns();
+            soma += b->estado + b->tedax_id + (int)b->modulo_atual;
+            segurando += relogio_ns() - inicio;
+            pthread_mutex_unlock(&b->mutex);
+        } else {
+            (*pulados)++;
+        }
+    }
+    return segurando;
+}
+
+/* A leitura atual; devolve os ns lendo e soma as releituras */
+static long long ler_retratos(int n, long* releituras) {
+    volatile int soma = 0;
+    long long inicio = relogio_ns();
+    RetratoStatus status;
+    *releituras += jogo_ler_status(&estado, &status);
+    soma += status.stats.modulos_desarmados + status.stats.tempo_restante;
+    for (int i = 0; i < n; i++) {
+        RetratoTedax t;
+        RetratoBancada b;
+        *releituras += tedax_ler_retrato(&estado.tedax[i], &t);
+        *releituras += bancada_ler_retrato(&estado.bancadas[i], &b);
+        soma += t.estado + t.desarmados + b.estado + b.tedax_id;
+    }
+    return relogio_ns() - inicio;
+}
+
+static void medir(int n, bool retrato, int segundos, int quadro_us) {
+    pthread_t ids[MAX_THREADS];
+    atomic_store(&rodando, true);
+    atomic_store(&ciclos, 0);
+    for (int i = 0; i < n; i++) pthread_create(&ids[i], NULL, motor, &estado.tedax[i]);
+
+    HistogramaLatencia por_quadro;
+    histograma_zerar(&por_quadro);
+    long quadros = 0, pulados = 0, releituras = 0;
+    long long pior = 0;
+    long long inicio = relogio_ns();
+    long long fim = inicio + segundos * 1000000000LL;
+    long long proximo = inicio;
+    while (proximo < fim) {
+        long long ns = retrato ? ler_retratos(n, &releituras) : ler_com_travas(n, &pulados);
+        histograma_registrar(&por_quadro, ns);
+        if (ns > pior) pior = ns;
+        quadros++;
+        proximo += quadro_us * 1000LL;
+        struct timespec prazo = timespec_de_ns(proximo);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &prazo, NULL);
+    }
+    atomic_store(&rodando, false);
+    for (int i = 0; i < n; i++) pthread_join(ids[i], NULL);
+    double duracao = (relogio_ns() - inicio) / 1e9;
+
+    long leituras = quadros * (1 + 2L * n);
+    printf("%-8s %8ld %9ld %7.2f%% %9.2f %9.2f %9.2f %11ld %12.0f\n", retrato ? "retrato" : "travas", quadros,
+           pulados, 100.0 * pulados / leituras, histograma_percentil(&por_quadro, 50) / 1e3,
+           histograma_percentil(&por_quadro, 99) / 1e3, pior / 1e3, releituras, atomic_load(&ciclos) / duracao);
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : TEDAX_PADRAO;
+    int segundos = argc > 2 ? atoi(argv[2]) : SEGUNDOS_PADRAO;
+    int quadro_us = argc > 3 ? atoi(argv[3]) : QUADRO_US_PADRAO;
+    if (n < 1 || n > MAX_THREADS) n = TEDAX_PADRAO;
+    if (segundos < 1) segundos = SEGUNDOS_PADRAO;
+    if (quadro_us < 1) quadro_us = QUADRO_US_PADRAO;
+
+    ConfigJogo config = config_padrao();
+    config.num_tedax = n;
+    config.num_bancadas = n;
+    if (jogo_init(&estado, &config) != 0) {
+        fprintf(stderr, "Falha ao iniciar o jogo\n");
+        return 1;
+    }
+    jogo = &estado;
+
+    printf("=== %d tedax no motor, um quadro a cada %d us, %d s por modo ===\n", n, quadro_us, segundos);
+    printf("(trava/leitura: us por quadro segurando travas ou copiando retratos)\n");
+    printf("%-8s %8s %9s %8s %9s %9s %9s %11s %12s\n", "modo", "quadros", "pulados", "", "p50", "p99", "max",
+           "releituras", "ciclos/s");
+    medir(n, false, segundos, quadro_us);
+    medir(n, true, segundos, quadro_us);
+
+    jogo = NULL;
+    jogo_liberar_elementos(&estado);
+    fila_modulos_destroy(&estado.fila_modulos);
+    pool_modulos_destroy();
+    pthread_mutex_destroy(&estado.mutex_estado);
+    pthread_mutex_destroy(&estado.mutex_display);
+    pthread_mutex_destroy(&estado.mutex_comando);
+    pthread_cond_destroy(&estado.cond_fim_jogo);
+    pthread_cond_destroy(&estado.cond_estado);
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * bench_simulacao.c - Partida em tempo virtual x partida real
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_simulacao [partidas_reais=4] [partidas_virtuais=100000]
+ *
+ * concordancia  joga partidas reais sem ncurses (tedax autonomos, cenarios
+ *               curtos que alternam vitoria, tempo esgotado e fila cheia)
+ *               e repete cada uma com simulacao_executar e a mesma semente;
+ *               compara desfecho, segundo do fim, gerados e desarmados
+ * vazao         partidas/s da simulacao na configuracao padrao
+ */
+
+#include "../include/tipos.h"
+#include "../include/jogo.h"
+#include "../include/simulacao.h"
+#include "../include/metricas.h"
+#include "../include/modulos.h"
+#include "../include/tedax.h"
+#include "../include/bancada.h"
+#include "../include/pool_modulos.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define REAIS_PADRAO 4
+#define VIRTUAIS_PADRAO 100000
+#define SEMENTE_BASE 1000
+
+static EstadoJogoCompleto estado;
+
+typedef struct {
+    const char* nome;
+    int num_tedax;
+    int num_bancadas;
+    int tempo_partida;
+    int dificuldade;
+    int modulos_para_vencer;
+    int capacidade_fila;
+} Cenario;
+
+static const Cenario cenarios[] = {
+    { "vitoria",   3, 2, 30, 1, 5, MAX_MODULOS_PENDENTES },
+    { "tempo",     2, 1, 20, 2, 50, MAX_MODULOS_PENDENTES },
+    { "fila",      1, 1, 40, 3, 50, 3 },
+    { "disputa",   3, 1, 30, 2, 8, MAX_MODULOS_PENDENTES },
+};
+#define NUM_CENARIOS ((int)(sizeof(cenarios) / sizeof(cenarios[0])))
+
+static ConfigJogo config_cenario(const Cenario* c, uint64_t semente) {
+    ConfigJogo config = config_padrao();
+    config.num_tedax = c->num_tedax;
+    config.num_bancadas = c->num_bancadas;
+    config.tempo_partida = c->tempo_partida;
+    config.dificuldade = c->dificuldade;
+    config.modulos_para_vencer = c->modulos_para_vencer;
+    config.capacidade_fila = c->capacidade_fila;
+    config.tedax_autonomos = true;
+    config.semente = semente;
+    return config;
+}
+
+/* Partida real ate o timer decidir; devolve no mesmo formato da simulacao */
+static void jogar_real(const ConfigJogo* config, ResultadoSimulacao* r) {
+    pthread_mutex_lock(&estado.mutex_estado);
+    memcpy(&estado.config, config, sizeof(ConfigJogo));
+    config_normalizar(&estado.config);
+    pthread_mutex_unlock(&estado.mutex_estado);
+    estado.executando = true;
+    jogo_iniciar_partida(&estado);
+
+    pthread_mutex_lock(&estado.mutex_estado);
+    while (estado.estado == JOGO_RODANDO) {
+        pthread_cond_wait(&estado.cond_estado, &estado.mutex_estado);
+    }
+    memset(r, 0, sizeof(ResultadoSimulacao));
+    r->semente = estado.semente;
+    r->estado_final = estado.estado;
+    memcpy(r->motivo, estado.motivo_final, sizeof(r->motivo));
+    r->segundos = estado.config.tempo_partida - estado.stats.tempo_restante;
+    r->stats = estado.stats;
+    jogo_somar_contadores(&estado, &r->stats);
+    pthread_mutex_unlock(&estado.mutex_estado);
+
+    jogo_parar_partida(&estado);
+}
+
+static bool iguais(const ResultadoSimulacao* a, const ResultadoSimulacao* b) {
+    return a->estado_final == b->estado_final && strcmp(a->motivo, b->motivo) == 0 &&
+           a->segundos == b->segundos && a->stats.modulos_gerados == b->stats.modulos_gerados &&
+           a->stats.modulos_desarmados == b->stats.modulos_desarmados;
+}
+
+static void imprimir(const char* origem, const ResultadoSimulacao* r) {
+    printf("  %-7s %-8s %3d s  gerados %3d  desarmados %3d  (%s)\n", origem,
+           r->estado_final == JOGO_VITORIA ? "vitoria" : "derrota", r->segundos,
+           r->stats.modulos_gerados, r->stats.modulos_desarmados, r->motivo);
+}
+
+int main(int argc, char* argv[]) {
+    int reais = argc > 1 ? atoi(argv[1]) : REAIS_PADRAO;
+    int virtuais = argc > 2 ? atoi(argv[2]) : VIRTUAIS_PADRAO;
+    if (reais < 0) reais = REAIS_PADRAO;
+    if (virtuais < 1) virtuais = VIRTUAIS_PADRAO;
+
+    ConfigJogo padrao = config_padrao();
+    if (jogo_init(&estado, &padrao) != 0) {
+        fprintf(stderr, "Falha ao iniciar o jogo\n");
+        return 1;
+    }
+    jogo = &estado;
+
+    printf("=== Concordancia: %d partidas reais x simulacao ===\n", reais);
+    int concordantes = 0;
+    for (int i = 0; i < reais; i++) {
+        const Cenario* c = &cenarios[i % NUM_CENARIOS];
+        uint64_t semente = SEMENTE_BASE + (uint64_t)i;
+        ConfigJogo config = config_cenario(c, semente);
+
+        ResultadoSimulacao real, virtual;
+        jogar_real(&config, &real);
+        simulacao_executar(&config, semente, &virtual);
+
+        bool ok = iguais(&real, &virtual);
+        if (ok) concordantes++;
+        printf("%s semente %llu: %s\n", c->nome, (unsigned long long)semente, ok ? "igual" : "DIFERENTE");
+        imprimir("real", &real);
+        imprimir("virtual", &virtual);
+    }
+    if (reais > 0) printf("%d de %d partidas iguais\n", concordantes, reais);
+
+    /* jogo_finalizar pararia a partida de novo; as threads ja foram unidas */
+    jogo = NULL;
+    fila_modulos_limpar(&estado.fila_modulos);
+    jogo_liberar_elementos(&estado);
+    fila_modulos_destroy(&estado.fila_modulos);
+    pool_modulos_destroy();
+    pthread_mutex_destroy(&estado.mutex_estado);
+    pthread_mutex_destroy(&estado.mutex_display);
+    pthread_mutex_destroy(&estado.mutex_comando);
+    pthread_cond_destroy(&estado.cond_fim_jogo);
+    pthread_cond_destroy(&estado.cond_estado);
+
+    printf("\n=== Vazao: %d partidas virtuais (configuracao padrao, tedax autonomos) ===\n", virtuais);
+    ConfigJogo config = config_padrao();
+    config.tedax_autonomos = true;
+    ResultadoSimulacao r;
+    long long desarmados = 0, eventos = 0;
+    long long inicio = relogio_ns();
+    for (int i = 0; i < virtuais; i++) {
+        simulacao_executar(&config, SEMENTE_BASE + (uint64_t)i, &r);
+        desarmados += r.stats.modulos_desarmados;
+        eventos += r.eventos;
+    }
+    double segundos = (relogio_ns() - inicio) / 1e9;
+    printf("%.3f s: %.0f partidas/s, %.0f eventos/partida, %.1f desarmados/partida\n", segundos,
+           virtuais / segundos, (double)eventos / virtuais, (double)desarmados / virtuais);
+    return 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * bench_tedax.c - Tedax comandados (push) x tedax autonomos (pull + roubo)
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ *
+ * Uso: bench_tedax [modulos]
+ *
+ * Os modulos tem tempo_resolucao 0, entao o que se mede e o custo de
+ * levar um modulo da fila ate um tedax. No modo push um despachante faz
+ * o papel do coordenador: espera a fila e designa o modulo mais antigo ao
+ * primeiro tedax livre. No modo autonomo os tedax puxam lotes da fila para
+ * as suas deques e roubam uns dos outros.
+ *
+ * Cenarios, para 1 a MAX_TEDAX_MENU tedax (cada um com a sua bancada):
+ *   saturacao  fila pre-carregada; modulos/s ate esvaziar
+ *   ritmo      chegadas periodicas a TAXAS_RITMO modulos/s por 1 s;
+ *              percentis da espera na fila (entrada -> tedax assume)
+ */
+
+#include "../include/tipos.h"
+#include "../include/jogo.h"
+#include "../include/modulos.h"
+#include "../include/tedax.h"
+#include "../include/bancada.h"
+#include "../include/pool_modulos.h"
+#include "../include/aleatorio.h"
+#include "../include/metricas.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+EstadoJogoCompleto* jogo = NULL;
+
+#define MODULOS_PADRAO 100000
+#define CAPACIDADE_BENCH (1 << 17)
+#define DURACAO_RITMO_NS 1000000000LL   /* 1 s de chegadas por medicao */
+#define TIMEOUT_ESVAZIAR_NS 30000000000LL
+#define TAXAS_RITMO 1000.0, 10000.0, 50000.0
+
+static EstadoJogoCompleto estado;
+static pthread_t despachante;
+static GeradorAleatorio gerador;
+
+typedef struct {
+    double vazao;                       /* Modulos/s */
+    long long p50, p90, p99;            /* Espera na fila (ns) */
+    long puxados, roubados;
+} Resultado;
+
+/* Coordenador automatico do modo push */
+static void* thread_despachante(void* arg) {
+    (void)arg;
+    while (estado.executando) {
+        if (!fila_modulos_aguardar_item(&estado.fila_modulos, 50)) continue;
+
+        int livre = -1;
+        for (int i = 0; i < estado.config.num_tedax && livre < 0; i++) {
+            if (tedax_disponivel(&estado.tedax[i])) livre = i;
+        }
+        if (livre < 0) {
+            sched_yield();
+            continue;
+        }
+
+        ModuloHandle h;
+        if (!fila_modulos_remover(&estado.fila_modulos, &h)) continue;
+        Modulo* m = pool_modulos_obter(h);
+        if (!tedax_designar_modulo(&estado.tedax[livre], h, livre, &m->instrucao)) {
+            if (!fila_modulos_adicionar(&estado.fila_modulos, h)) pool_modulos_liberar(h);
+        }
+    }
+    pool_modulos_devolver_cache();
+    return NULL;
+}
+
+static bool publicar_modulo(void) {
+    ModuloHandle h = pool_modulos_alocar();
+    if (h == MODULO_HANDLE_NULO) return false;
+    Modulo* m = pool_modulos_obter(h);
+    gerar_modulo_aleatorio(&gerador, m, estado.proximo_id_modulo++, 1);
+    m->tempo_resolucao = 0;
+    if (!fila_modulos_adicionar(&estado.fila_modulos, h)) {
+        pool_modulos_liberar(h);
+        return false;
+    }
+    atomic_fetch_add_explicit(&estado.gerados_mural, 1, memory_order_relaxed);
+    return true;
+}
+
+static void preparar(bool autonomo, int num_tedax, int pre_carga) {
+    ConfigJogo config = config_padrao();
+    config.num_tedax = num_tedax;
+    config.num_bancadas = num_tedax;
+    config.capacidade_fila = CAPACIDADE_BENCH;
+    config.tedax_autonomos = autonomo;
+    if (jogo_init(&estado, &config) != 0) {
+        fprintf(stderr, "Falha ao iniciar o jogo\n");
+        exit(1);
+    }
+    jogo = &estado;
+    estado.estado = JOGO_RODANDO;
+    aleatorio_semear(&gerador, 42, FLUXO_MURAL);
+
+    for (int i = 0; i < pre_carga; i++) publicar_modulo();
+
+    for (int i = 0; i < num_tedax; i++) tedax_iniciar_thread(&estado.tedax[i]);
+    if (!autonomo) pthread_create(&despachante, NULL, thread_despachante, NULL);
+}
+
+static int desarmados(void) {
+    Estatisticas stats;
+    jogo_somar_contadores(&estado, &stats);
+    return stats.modulos_desarmados;
+}
+
+/* Espera ate 'total' modulos desarmados; devolve o instante (ns) */
+static long long esperar_desarmados(int total) {
+    long long limite = relogio_ns() + TIMEOUT_ESVAZIAR_NS;
+    while (desarmados() < total && relogio_ns() < limite) usleep(200);
+    return relogio_ns();
+}
+
+static Resultado encerrar(void) {
+    Resultado r = { 0 };
+
+    pthread_mutex_lock(&estado.mutex_estado);
+    estado.executando = false;
+    pthread_cond_broadcast(&estado.cond_estado);
+    pthread_mutex_unlock(&estado.mutex_estado);
+    fila_modulos_despertar(&estado.fila_modulos);
+
+    if (!estado.config.tedax_autonomos) pthread_join(despachante, NULL);
+
+    HistogramaLatencia total;
+    histograma_zerar(&total);
+    for (int i = 0; i < estado.config.num_tedax; i++) {
+        tedax_parar_thread(&estado.tedax[i]);
+        histograma_somar(&total, &estado.tedax[i].latencia_fila);
+        r.puxados += estado.tedax[i].modulos_puxados;
+        r.roubados += estado.tedax[i].modulos_roubados;
+    }
+    r.p50 = histograma_percentil(&total, 50);
+    r.p90 = histograma_percentil(&total, 90);
+    r.p99 = histograma_percentil(&total, 99);
+
+    fila_modulos_limpar(&estado.fila_modulos);
+    jogo_liberar_elementos(&estado);
+    fila_modulos_destroy(&estado.fila_modulos);
+    pool_modulos_devolver_cache();
+    pool_modulos_destroy();
+    pthread_mutex_destroy(&estado.mutex_estado);
+    pthread_mutex_destroy(&estado.mutex_display);
+    pthread_mutex_destroy(&estado.mutex_comando);
+    pthread_cond_destroy(&estado.cond_fim_jogo);
+    pthread_cond_destroy(&estado.cond_estado);
+    jogo = NULL;
+    return r;
+}
+
+static Resultado medir_saturacao(bool autonomo, int num_tedax, int modulos) {
+    preparar(autonomo, num_tedax, modulos);
+    long long inicio = relogio_ns();
+    long long fim = esperar_desarmados(modulos);
+    int feitos = desarmados();
+    Resultado r = encerrar();
+    r.vazao = feitos / ((fim - inicio) / 1e9);
+    return r;
+}
+
+static Resultado medir_ritmo(bool autonomo, int num_tedax, double taxa) {
+    preparar(autonomo, num_tedax, 0);
+
+    /* Chegadas em prazos absolutos: atrasos do sono viram rajadas curtas */
+    long long intervalo = (long long)(1e9 / taxa);
+    long long inicio = relogio_ns();
+    int gerados = 0;
+    for (long long prazo = inicio; prazo < inicio + DURACAO_RITMO_NS; prazo += intervalo) {
+        struct timespec ts = { prazo / 1000000000LL, prazo % 1000000000LL };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        if (publicar_modulo()) gerados++;
+    }
+    long long fim = esperar_desarmados(gerados);
+    int feitos = desarmados();
+    Resultado r = encerrar();
+    r.vazao = feitos / ((fim - inicio) / 1e9);
+    return r;
+}
+
+static void imprimir(const char* modo, int tedax, const char* carga, Resultado r) {
+    printf("%-9s %5d %9s %12.0f %10.1f %10.1f %10.1f %9ld %9ld\n", modo, tedax, carga,
+           r.vazao, r.p50 / 1e3, r.p90 / 1e3, r.p99 / 1e3, r.puxados, r.roubados);
+}
+
+int main(int argc, char* argv[]) {
+    int modulos = argc > 1 ? atoi(argv[1]) : MODULOS_PADRAO;
+    if (modulos < 1 || modulos > CAPACIDADE_BENCH) modulos = MODULOS_PADRAO;
+
+    printf("=== Tedax push x autonomos: %d modulos na saturacao, tempo_resolucao 0 ===\n", modulos);
+    printf("%-9s %5s %9s %12s %10s %10s %10s %9s %9s\n", "modo", "tedax", "carga",
+           "modulos/s", "p50 (us)", "p90 (us)", "p99 (us)", "puxados", "roubados");
+
+    for (int tedax = 1; tedax <= MAX_TEDAX_MENU; tedax++) {
+        Resultado push = medir_saturacao(false, tedax, modulos);
+        Resultado autonomo = medir_saturacao(true, tedax, modulos);
+        imprimir("push", tedax, "saturada", push);
+        imprimir("autonomo", tedax, "saturada", autonomo);
+
+        /* Mesma taxa de chegada para os dois modos */
+        double taxas[] = { TAXAS_RITMO };
+        for (size_t t = 0; t < sizeof(taxas) / sizeof(taxas[0]); t++) {
+            char carga[16];
+            snprintf(carga, sizeof(carga), "%.0f/s", taxas[t]);
+            imprimir("push", tedax, carga, medir_ritmo(false, tedax, taxas[t]));
+            imprimir("autonomo", tedax, carga, medir_ritmo(true, tedax, taxas[t]));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file afinidade.h
+ * @brief Afinidade de CPU e nomes das threads do motor
+ *
+ * Cada papel (interface, mural, timer, tedax, coordenador) pode ser
+ * fixado em um conjunto de CPUs com --afinidade papel=lista. As threads
+ * criadas pelo jogo recebem a mascara nos atributos de criacao (nunca
+ * rodam fora dela); a thread principal e os trabalhadores do executor,
+ * que ja existem, sao fixados logo depois. Toda thread recebe um nome ("mural", "tedax-2",
+ * "executor-1"...) para aparecer em top -H e perf.
+ *
+ * A mascara pedida e cruzada com as CPUs que o processo pode usar
+ * (sched_getaffinity); se nao sobrar nenhuma, o papel fica sem fixar.
+ * Mascaras de 64 bits: CPUs 0 a 63.
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef AFINIDADE_H
+#define AFINIDADE_H
+
+#include "tipos.h"
+#include <stdio.h>
+
+/**
+ * @brief Le uma opcao "papel=lista" (ex.: "tedax=2-3", "mural=1,4")
+ * @param texto Texto da opcao
+ * @param config Recebe a mascara do papel
+ * @return 0 se sucesso, -1 se o papel ou a lista forem invalidos
+ */
+int afinidade_ler(const char* texto, ConfigJogo* config);
+
+/**
+ * @brief Converte o nome do papel ("interface", "mural", "timer", "tedax", "coordenador")
+ * @param nome Nome do papel
+ * @return Papel correspondente, ou -1 se desconhecido
+ */
+int afinidade_papel_por_nome(const char* nome);
+
+/**
+ * @brief Retorna o nome de um papel
+ * @param papel Papel
+ * @return Nome do papel
+ */
+const char* afinidade_nome_papel(PapelThread papel);
+
+/**
+ * @brief Mascara efetiva do papel: a pedida cruzada com as CPUs do processo
+ * @param config Configuracao (NULL = sem fixar)
+ * @param papel Papel da thread
+ * @return Mascara efetiva, ou 0 se o papel nao deve ser fixado
+ */
+uint64_t afinidade_efetiva(const ConfigJogo* config, PapelThread papel);
+
+/**
+ * @brief Cria uma thread ja fixada nas CPUs do papel e com nome
+ * @param thread Recebe a thread criada
+ * @param config Configuracao (NULL = sem fixar)
+ * @param papel Papel da thread
+ * @param indice Numero no nome (ex.: 2 em "tedax-2"), ou -1 para so o papel
+ * @param funcao Funcao da thread
+ * @param arg Argumento da funcao
+ * @return 0 se sucesso, codigo de pthread_create caso contrario
+ */
+int afinidade_criar_thread(pthread_t* thread, const ConfigJogo* config, PapelThread papel, int indice,
+                           void* (*funcao)(void*), void* arg);
+
+/**
+ * @brief Fixa e nomeia uma thread que ja existe (principal, executor)
+ * @param thread Thread alvo
+ * @param config Configuracao (NULL = sem fixar)
+ * @param papel Papel da thread
+ * @param nome Nome da thread (cortado em 15 caracteres), ou NULL para manter
+ */
+void afinidade_aplicar(pthread_t thread, const ConfigJogo* config, PapelThread papel, const char* nome);
+
+/**
+ * @brief Relatorio de posicionamento: CPUs do processo e mascara de cada papel
+ * @param saida Arquivo de saida (stderr no inicio do jogo)
+ * @param config Configuracao
+ */
+void afinidade_relatorio(FILE* saida, const ConfigJogo* config);
+
+#endif /* AFINIDADE_H */
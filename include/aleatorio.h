@@ -0,0 +1,54 @@
+/**
+ * @file aleatorio.h
+ * @brief Gerador pseudoaleatorio por thread (xoshiro256**)
+ *
+ * Cada thread geradora tem o seu proprio GeradorAleatorio, sem estado
+ * compartilhado nem locks. O estado inicial vem de uma semente e de um
+ * numero de fluxo, de modo que a mesma semente reproduz exatamente a
+ * mesma sequencia e fluxos diferentes sao independentes.
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef ALEATORIO_H
+#define ALEATORIO_H
+
+#include "tipos.h"
+
+/**
+ * @brief Inicializa o gerador a partir de uma semente e de um fluxo
+ * @param gerador Ponteiro para o gerador
+ * @param semente Semente da partida
+ * @param fluxo Identificador do fluxo (ex.: FLUXO_MURAL)
+ */
+void aleatorio_semear(GeradorAleatorio* gerador, uint64_t semente, uint64_t fluxo);
+
+/**
+ * @brief Proximo valor de 64 bits
+ * @param gerador Ponteiro para o gerador
+ * @return Valor uniforme em [0, 2^64)
+ */
+uint64_t aleatorio_proximo(GeradorAleatorio* gerador);
+
+/**
+ * @brief Inteiro uniforme em [0, n)
+ * @param gerador Ponteiro para o gerador
+ * @param n Limite superior exclusivo (> 0)
+ * @return Valor em [0, n)
+ */
+int aleatorio_intervalo(GeradorAleatorio* gerador, int n);
+
+/**
+ * @brief Real uniforme em [0, 1)
+ * @param gerador Ponteiro para o gerador
+ * @return Valor em [0, 1) com 53 bits de precisao
+ */
+double aleatorio_unitario(GeradorAleatorio* gerador);
+
+/**
+ * @brief Semente derivada do relogio, para partidas sem --seed
+ * @return Semente nao nula
+ */
+uint64_t aleatorio_semente_relogio(void);
+
+#endif /* ALEATORIO_H */
@@ -30,17 +30,24 @@ void bancada_destroy(Bancada* bancada);
  */
 bool bancada_livre(Bancada* bancada);
 
+/**
+ * @brief Trabalho na bancada: 1 se ocupada mais os tedax na fila de espera
+ * @param bancada Ponteiro para a bancada
+ * @return Carga da bancada
+ */
+int bancada_carga(Bancada* bancada);
+
 /**
  * @brief Tenta ocupar uma bancada
  * @param bancada Ponteiro para a bancada
  * @param tedax_id ID do tedax que quer ocupar
- * @param modulo Modulo a ser trabalhado
+ * @param modulo Handle do modulo a ser trabalhado
  * @return true se conseguiu ocupar
  */
-bool bancada_ocupar(Bancada* bancada, int tedax_id, Modulo* modulo);
+bool bancada_ocupar(Bancada* bancada, int tedax_id, ModuloHandle modulo);
 
 /**
- * @brief Libera uma bancada
+ * @brief Libera uma bancada (ou a entrega ao primeiro da fila de espera)
  * @param bancada Ponteiro para a bancada
  * @param tedax_id ID do tedax que esta liberando
  * @return true se liberou com sucesso
@@ -55,6 +62,57 @@ bool bancada_liberar(Bancada* bancada, int tedax_id);
  */
 bool bancada_aguardar_livre(Bancada* bancada, int timeout_ms);
 
+/**
+ * @brief Entra na fila de espera da bancada
+ *
+ * Se a bancada estiver livre ela e entregue na hora. Senao, ao ser
+ * liberada ela passa direto ao primeiro da fila, que e acordado pela
+ * cond da espera ou, no modo pool, por executor_acordar. Preencha
+ * tedax_id, modulo e (no modo pool) executor/tarefa antes de entrar.
+ * @param bancada Ponteiro para a bancada
+ * @param espera Lugar na fila (valido ate bancada_sair_fila)
+ */
+void bancada_entrar_fila(Bancada* bancada, EsperaBancada* espera);
+
+/**
+ * @brief Aguarda a vez na fila (bloqueante; nao sai da fila)
+ * @param bancada Ponteiro para a bancada
+ * @param espera Lugar na fila
+ * @param timeout_ms Timeout em milissegundos (<= 0 = sem timeout)
+ * @return true se a bancada ja foi entregue
+ */
+bool bancada_aguardar_vez(Bancada* bancada, EsperaBancada* espera, int timeout_ms);
+
+/**
+ * @brief Consulta se a bancada ja foi entregue, sem esperar
+ * @param bancada Ponteiro para a bancada
+ * @param espera Lugar na fila
+ * @return true se a bancada ja foi entregue
+ */
+bool bancada_vez_concedida(Bancada* bancada, EsperaBancada* espera);
+
+/**
+ * @brief Sai da fila de espera
+ * @param bancada Ponteiro para a bancada
+ * @param espera Lugar na fila
+ * @return true se a bancada ja tinha sido entregue (o chamador e o dono e deve libera-la)
+ */
+bool bancada_sair_fila(Bancada* bancada, EsperaBancada* espera);
+
+/**
+ * @brief Publica o retrato da bancada para a tela (requer o mutex da bancada)
+ * @param bancada Ponteiro para a bancada
+ */
+void bancada_publicar(Bancada* bancada);
+
+/**
+ * @brief Copia o ultimo retrato publicado sem travar a bancada
+ * @param bancada Ponteiro para a bancada
+ * @param retrato Recebe estado, dono e nome do modulo
+ * @return Releituras por publicacao concorrente
+ */
+int bancada_ler_retrato(Bancada* bancada, RetratoBancada* retrato);
+
 /**
  * @brief Retorna o estado atual da bancada como string
  * @param bancada Ponteiro para a bancada
@@ -63,7 +121,55 @@ bool bancada_aguardar_livre(Bancada* bancada, int timeout_ms);
 const char* bancada_estado_str(Bancada* bancada);
 
 /**
- * @brief Encontra uma bancada livre
+ * @brief Cria o bitmap de livres e liga cada bancada a ele
+ *
+ * Depois disso as bancadas mantem o bit em dia sozinhas (ocupar, liberar,
+ * entrar na fila). O bit i e bancadas[i], que deve ter id i.
+ * @param mapa Mapa a inicializar
+ * @param bancadas Array de bancadas ja inicializadas
+ * @param num_bancadas Numero de bancadas (qualquer quantidade, 64 por palavra)
+ * @return 0 em sucesso, -1 em erro
+ */
+int mapa_bancadas_init(MapaBancadas* mapa, Bancada* bancadas, int num_bancadas);
+
+/**
+ * @brief Desliga as bancadas do mapa e libera as palavras
+ * @param mapa Mapa de bancadas
+ */
+void mapa_bancadas_destroy(MapaBancadas* mapa);
+
+/**
+ * @brief Refaz os bits a partir do estado das bancadas (sem ninguem reservando)
+ * @param mapa Mapa de bancadas
+ */
+void mapa_bancadas_sincronizar(MapaBancadas* mapa);
+
+/**
+ * @brief Ocupa a primeira bancada livre a partir de 'inicio' (find-first-set + CAS)
+ *
+ * Da uma volta pelas bancadas [0, limite) comecando em 'inicio', como o
+ * laco de bancada_ocupar, mas so trava o mutex da bancada conquistada.
+ * @param mapa Mapa de bancadas
+ * @param limite Bancadas consideradas (as primeiras 'limite')
+ * @param inicio Primeira bancada tentada
+ * @param exceto Bancada pulada (-1 para nenhuma)
+ * @param tedax_id Novo dono
+ * @param modulo Modulo que vai para a bancada
+ * @return Id da bancada ocupada, ou -1 se nenhuma livre
+ */
+int mapa_bancadas_reservar(MapaBancadas* mapa, int limite, int inicio, int exceto, int tedax_id,
+                           ModuloHandle modulo);
+
+/**
+ * @brief Conta as bancadas livres entre as primeiras 'limite' (popcount)
+ * @param mapa Mapa de bancadas
+ * @param limite Bancadas consideradas
+ * @return Quantidade de bancadas livres
+ */
+int mapa_bancadas_livres(MapaBancadas* mapa, int limite);
+
+/**
+ * @brief Encontra uma bancada livre (pelo mapa, se o array tiver um)
  * @param bancadas Array de bancadas
  * @param num_bancadas Numero de bancadas
  * @return ID da bancada livre ou -1 se nenhuma
@@ -71,7 +177,7 @@ const char* bancada_estado_str(Bancada* bancada);
 int encontrar_bancada_livre(Bancada* bancadas, int num_bancadas);
 
 /**
- * @brief Conta bancadas ocupadas
+ * @brief Conta bancadas ocupadas (popcount do mapa, se o array tiver um)
  * @param bancadas Array de bancadas
  * @param num_bancadas Numero de bancadas
  * @return Quantidade de bancadas ocupadas
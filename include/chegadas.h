@@ -0,0 +1,69 @@
+/**
+ * @file chegadas.h
+ * @brief Modelos de chegada de modulos para a thread do mural
+ *
+ * Cada partida escolhe em ConfigJogo como os modulos chegam:
+ * - CHEGADA_UNIFORME: intervalo uniforme entre INTERVALO_GERACAO_MIN e
+ *   INTERVALO_GERACAO_MAX, encurtado pela dificuldade (modelo original)
+ * - CHEGADA_POISSON: intervalos exponenciais com taxa fixa
+ * - CHEGADA_RAJADAS: processo on/off (MMPP de dois estados), alternando
+ *   calmaria e rajada com duracoes exponenciais
+ * - CHEGADA_TRACE: repete registros (instante, tipo, parametro) de um arquivo
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef CHEGADAS_H
+#define CHEGADAS_H
+
+#include "tipos.h"
+
+/**
+ * @struct Chegada
+ * @brief Proxima chegada produzida por um modelo
+ */
+typedef struct {
+    double intervalo;               /* Segundos desde a chegada anterior */
+    int tipo;                       /* TipoModulo forcado, ou -1 para sortear */
+    int parametro;                  /* Parametro forcado, ou 0 para sortear */
+} Chegada;
+
+/**
+ * @brief Prepara o modelo da partida (carrega o trace, se for o caso)
+ * @param chegadas Ponteiro para o estado do modelo
+ * @param config Configuracao da partida
+ * @param semente Semente da partida (fluxo FLUXO_CHEGADAS)
+ * @return 0 se sucesso, -1 se o trace nao pode ser lido
+ */
+int chegadas_init(GeradorChegadas* chegadas, const ConfigJogo* config, uint64_t semente);
+
+/**
+ * @brief Libera o trace carregado
+ * @param chegadas Ponteiro para o estado do modelo
+ */
+void chegadas_destroy(GeradorChegadas* chegadas);
+
+/**
+ * @brief Sorteia (ou le do trace) a proxima chegada
+ * @param chegadas Ponteiro para o estado do modelo
+ * @param dificuldade Dificuldade atual (usada pelo modelo uniforme)
+ * @param chegada Recebe o intervalo e, no trace, o tipo e o parametro
+ * @return false quando o trace terminou
+ */
+bool chegadas_proxima(GeradorChegadas* chegadas, int dificuldade, Chegada* chegada);
+
+/**
+ * @brief Converte o nome do modelo ("uniforme", "poisson", "rajadas", "trace")
+ * @param nome Nome do modelo
+ * @return Modelo correspondente, ou -1 se desconhecido
+ */
+int chegadas_modelo_por_nome(const char* nome);
+
+/**
+ * @brief Retorna o nome de um modelo de chegada
+ * @param modelo Modelo
+ * @return Nome do modelo
+ */
+const char* chegadas_nome_modelo(ModeloChegada modelo);
+
+#endif /* CHEGADAS_H */
@@ -0,0 +1,56 @@
+/**
+ * @file diario.h
+ * @brief Diario de mensagens: anel MPSC limitado que nunca bloqueia
+ *
+ * Substitui a mensagem unica de feedback, que era perdida sempre que
+ * mutex_estado estava ocupado. Produtores (tedax, mural, timer, jogador)
+ * publicam com um fetch_add e a escrita do slot como um retrato (ver
+ * retrato.h); a tela copia as ultimas entradas sem travar. Cheio, o anel
+ * sobrescreve a mais antiga. Um produtor que cai num slot ainda em uso
+ * por outro (o anel deu a volta durante a escrita) descarta a entrada em
+ * vez de esperar.
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef DIARIO_H
+#define DIARIO_H
+
+#include "tipos.h"
+
+/**
+ * @brief Esvazia o diario e zera os contadores (sem produtores rodando)
+ * @param diario Ponteiro para o diario
+ */
+void diario_init(Diario* diario);
+
+/**
+ * @brief Publica uma mensagem sem bloquear
+ * @param diario Ponteiro para o diario
+ * @param instante_ns Instante da mensagem (relogio_ns)
+ * @param texto Mensagem (cortada em MAX_TEXTO_DIARIO - 1 caracteres)
+ * @return true se escrita, false se descartada
+ */
+bool diario_publicar(Diario* diario, long long instante_ns, const char* texto);
+
+/**
+ * @brief Copia as entradas mais recentes, da mais antiga para a mais nova
+ *
+ * Entradas ainda sendo escritas ou ja sobrescritas sao puladas, entao
+ * podem vir menos que 'max' mesmo com o diario cheio.
+ *
+ * @param diario Ponteiro para o diario
+ * @param destino Recebe as entradas
+ * @param max Entradas que cabem em 'destino'
+ * @return Entradas copiadas
+ */
+int diario_recentes(Diario* diario, EntradaDiario* destino, int max);
+
+/**
+ * @brief Contadores de publicadas, descartadas e sobrescritas
+ * @param diario Ponteiro para o diario
+ * @return Contadores
+ */
+EstatisticasDiario diario_estatisticas(Diario* diario);
+
+#endif /* DIARIO_H */
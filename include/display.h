@@ -31,7 +31,9 @@
 #define ALTURA_BANCADAS  6
 #define ALTURA_TEDAX     6
 #define ALTURA_STATUS    4
+#define ALTURA_MENSAGENS 7          /* as ALTURA_MENSAGENS - 2 ultimas mensagens do diario */
 #define ALTURA_COMANDO   3
+#define LARGURA_MIN_COLUNA 18   /* Largura minima de um tedax ou bancada; o resto nao aparece */
 
 /**
  * @brief Inicializa o sistema de display (ncurses)
@@ -102,7 +104,24 @@ void display_status(EstadoJogoCompleto* estado, int linha);
 void display_comando(EstadoJogoCompleto* estado, int linha);
 
 /**
- * @brief Exibe uma mensagem de feedback temporaria
+ * @brief Desenha as mensagens mais recentes do diario, a mais nova embaixo
+ * @param estado Ponteiro para o estado do jogo
+ * @param linha Linha inicial
+ */
+void display_mensagens(EstadoJogoCompleto* estado, int linha);
+
+/**
+ * @brief Mensagem mais recente do diario dentro da caixa de status
+ *
+ * Usada quando o terminal nao tem linhas para o painel de mensagens.
+ *
+ * @param estado Ponteiro para o estado do jogo
+ * @param linha Linha inicial da caixa de status
+ */
+void display_ultima_mensagem(EstadoJogoCompleto* estado, int linha);
+
+/**
+ * @brief Publica uma mensagem no diario (painel de mensagens)
  * @param estado Ponteiro para o estado do jogo
  * @param mensagem Mensagem a exibir
  * @param tipo 0=info, 1=sucesso, 2=erro, 3=alerta
@@ -133,6 +152,22 @@ void display_fim_jogo(EstadoJogoCompleto* estado);
  */
 void display_ajuda(void);
 
+/**
+ * @brief Zera o custo das leituras (inicio de cada partida)
+ */
+void display_zerar_estatisticas(void);
+
+/**
+ * @brief Fecha o quadro: soma o tempo lendo estado compartilhado desde o anterior
+ */
+void display_fechar_quadro(void);
+
+/**
+ * @brief Custo das leituras da tela na partida atual
+ * @return Quadros, releituras e tempo de leitura por quadro
+ */
+EstatisticasTela display_estatisticas(void);
+
 /**
  * @brief Thread principal de display
  * @param arg Ponteiro para EstadoJogoCompleto
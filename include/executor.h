@@ -0,0 +1,76 @@
+/**
+ * @file executor.h
+ * @brief Pool fixo de threads para tarefas leves (execucao M:N)
+ *
+ * Uma tarefa e uma funcao de passo chamada repetidamente por algum
+ * trabalhador. O valor devolvido diz quando chamar de novo:
+ *   - EXECUTOR_CONCLUIDA: a tarefa terminou;
+ *   - EXECUTOR_ESTACIONAR: so depois de executor_acordar;
+ *   - prazo > 0 (relogio_ns): nao antes do prazo. Um prazo ja vencido
+ *     devolve a tarefa ao fim da fila de prontas.
+ *
+ * Um passo nao deve bloquear: esperas viram prazos ou estacionamento,
+ * e o executor as gerencia sem ocupar um trabalhador.
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include "tipos.h"
+
+#define EXECUTOR_CONCLUIDA (-1LL)
+#define EXECUTOR_ESTACIONAR 0LL
+
+/**
+ * @brief Cria o pool e inicia os trabalhadores
+ * @param executor Ponteiro para o executor
+ * @param num_trabalhadores Threads do pool (<= 0 usa o numero de CPUs)
+ * @param ao_sair Funcao chamada por cada trabalhador antes de terminar (pode ser NULL)
+ * @return 0 se sucesso, -1 se erro
+ */
+int executor_init(Executor* executor, int num_trabalhadores, void (*ao_sair)(void));
+
+/**
+ * @brief Para os trabalhadores e libera o pool
+ *
+ * Tarefas nao concluidas sao abandonadas; quem as criou deve encerra-las
+ * antes (ver executor_aguardar).
+ * @param executor Ponteiro para o executor
+ */
+void executor_destroy(Executor* executor);
+
+/**
+ * @brief Agenda uma tarefa nova para rodar imediatamente
+ * @param executor Ponteiro para o executor
+ * @param tarefa Tarefa (memoria do chamador, valida ate concluir)
+ * @param passo Funcao de passo
+ * @param arg Argumento do passo
+ */
+void executor_submeter(Executor* executor, TarefaExecutor* tarefa, PassoTarefa passo, void* arg);
+
+/**
+ * @brief Faz a tarefa rodar o quanto antes
+ *
+ * Tira a tarefa do estacionamento ou do heap de timers. Se ela estiver
+ * no meio de um passo, roda de novo logo em seguida.
+ * @param executor Ponteiro para o executor
+ * @param tarefa Tarefa submetida
+ */
+void executor_acordar(Executor* executor, TarefaExecutor* tarefa);
+
+/**
+ * @brief Bloqueia ate a tarefa concluir
+ * @param executor Ponteiro para o executor
+ * @param tarefa Tarefa submetida
+ */
+void executor_aguardar(Executor* executor, TarefaExecutor* tarefa);
+
+/**
+ * @brief Numero de CPUs online (minimo 1)
+ * @return Quantidade de CPUs
+ */
+int executor_num_cpus(void);
+
+#endif /* EXECUTOR_H */
@@ -0,0 +1,42 @@
+/**
+ * @file fila_mpmc.h
+ * @brief Fila circular limitada lock-free (multiplos produtores/consumidores)
+ *
+ * Implementacao com slots numerados por sequencia: cada slot guarda um
+ * contador que indica se esta livre para o produtor da posicao atual ou
+ * pronto para o consumidor. Nenhuma operacao bloqueia.
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef FILA_MPMC_H
+#define FILA_MPMC_H
+
+#include "tipos.h"
+
+/**
+ * @brief Inicializa a fila sobre um vetor de slots ja alocado
+ * @param fila Ponteiro para a fila
+ * @param slots Vetor de slots (tamanho = capacidade)
+ * @param capacidade Numero de slots (deve ser potencia de 2)
+ * @return 0 se sucesso, -1 se capacidade invalida
+ */
+int fila_mpmc_init(FilaMPMC* fila, SlotFilaMPMC* slots, size_t capacidade);
+
+/**
+ * @brief Publica um modulo na fila sem bloquear
+ * @param fila Ponteiro para a fila
+ * @param modulo Handle do modulo
+ * @return true se publicado, false se a fila estava cheia
+ */
+bool fila_mpmc_enfileirar(FilaMPMC* fila, ModuloHandle modulo);
+
+/**
+ * @brief Retira o modulo mais antigo da fila sem bloquear
+ * @param fila Ponteiro para a fila
+ * @param modulo Ponteiro para armazenar o handle retirado
+ * @return true se retirado, false se a fila estava vazia
+ */
+bool fila_mpmc_desenfileirar(FilaMPMC* fila, ModuloHandle* modulo);
+
+#endif /* FILA_MPMC_H */
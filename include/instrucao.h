@@ -0,0 +1,74 @@
+/**
+ * @file instrucao.h
+ * @brief Instrucoes codificadas com 2 bits por simbolo
+ *
+ * Todo alfabeto de instrucao tem no maximo 4 simbolos (Fios "rgby",
+ * Botao "p", Sequencia "1234", Simon "udlr"), entao uma instrucao de ate
+ * MAX_SIMBOLOS_INSTRUCAO simbolos cabe em um uint64_t mais o tamanho. O
+ * tipo vai junto: "rgb" de Fios e "123" de Sequencia tem os mesmos bits,
+ * mas nao sao a mesma instrucao.
+ *
+ * Conferir uma instrucao e comparar 16 bytes; instrucao_verificar_lote
+ * confere muitos pares de uma vez com SSE2/AVX2 (ou escalar fora do x86).
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef INSTRUCAO_H
+#define INSTRUCAO_H
+
+#include "tipos.h"
+
+/**
+ * @brief Codifica o texto de uma instrucao no alfabeto do tipo
+ * @param tipo Tipo do modulo (define o alfabeto)
+ * @param texto Instrucao em texto (ex.: "rgb")
+ * @param instrucao Recebe a codificacao; invalida (tamanho 0) em caso de erro
+ * @return false se o texto for vazio, longo demais ou tiver simbolo fora do alfabeto
+ */
+bool instrucao_codificar(TipoModulo tipo, const char* texto, InstrucaoCodificada* instrucao);
+
+/**
+ * @brief Escreve a instrucao em texto
+ * @param instrucao Instrucao codificada
+ * @param texto Recebe o texto (vazio se a instrucao for invalida)
+ * @param tam Tamanho do buffer (MAX_SIMBOLOS_INSTRUCAO + 1 basta)
+ */
+void instrucao_decodificar(const InstrucaoCodificada* instrucao, char* texto, size_t tam);
+
+/**
+ * @brief Monta uma instrucao a partir dos valores dos simbolos (0 a 3)
+ * @param tipo Tipo do modulo
+ * @param valores Valor de cada simbolo no alfabeto do tipo
+ * @param tamanho Quantidade de simbolos (1 a MAX_SIMBOLOS_INSTRUCAO)
+ * @param instrucao Recebe a codificacao
+ */
+void instrucao_montar(TipoModulo tipo, const int* valores, int tamanho, InstrucaoCodificada* instrucao);
+
+/**
+ * @brief Quantos simbolos o alfabeto do tipo tem
+ * @param tipo Tipo do modulo
+ * @return 1 a 4, ou 0 se o tipo for invalido
+ */
+int instrucao_tamanho_alfabeto(TipoModulo tipo);
+
+/**
+ * @brief Confere uma instrucao recebida contra a esperada
+ * @param esperada Instrucao do modulo
+ * @param recebida Instrucao fornecida
+ * @return true se iguais e validas
+ */
+bool instrucao_conferir(const InstrucaoCodificada* esperada, const InstrucaoCodificada* recebida);
+
+/**
+ * @brief Confere muitos pares (esperadas[i], recebidas[i]) de uma vez
+ * @param esperadas Instrucoes dos modulos
+ * @param recebidas Instrucoes fornecidas
+ * @param n Quantidade de pares
+ * @param resultados Recebe 1 (confere) ou 0 por par; pode ser NULL
+ * @return Quantidade de pares que conferem
+ */
+int instrucao_verificar_lote(const InstrucaoCodificada* esperadas, const InstrucaoCodificada* recebidas, int n,
+                             uint8_t* resultados);
+
+#endif /* INSTRUCAO_H */
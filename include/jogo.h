@@ -24,6 +24,23 @@ int jogo_init(EstadoJogoCompleto* estado, ConfigJogo* config);
  */
 void jogo_finalizar(EstadoJogoCompleto* estado);
 
+/**
+ * @brief Garante vetores de tedax e bancadas para a configuracao atual
+ *
+ * Aloca alinhado a linha de cache, com espaco ao menos para os limites do
+ * menu; so realoca (destruindo os elementos antigos) quando a configuracao
+ * pede mais do que ha. Chame sem partida em andamento.
+ * @param estado Ponteiro para o estado
+ * @return 0 se sucesso, -1 se erro
+ */
+int jogo_dimensionar(EstadoJogoCompleto* estado);
+
+/**
+ * @brief Destroi os tedax, as bancadas e o mapa e libera os vetores
+ * @param estado Ponteiro para o estado (sem partida em andamento)
+ */
+void jogo_liberar_elementos(EstadoJogoCompleto* estado);
+
 /**
  * @brief Inicia uma nova partida
  * @param estado Ponteiro para o estado
@@ -43,6 +60,42 @@ void jogo_parar_partida(EstadoJogoCompleto* estado);
  */
 void jogo_pausar(EstadoJogoCompleto* estado);
 
+/**
+ * @brief Modulos pendentes: fila global, caixas e deques dos tedax
+ * @param estado Ponteiro para o estado
+ * @return Quantidade de modulos ainda nao iniciados
+ */
+int jogo_modulos_pendentes(EstadoJogoCompleto* estado);
+
+/**
+ * @brief Soma os contadores de cada thread, sem travar
+ *
+ * Cada tedax conta os seus desarmados e falhados e o mural os gerados e
+ * despertares, em linhas de cache proprias; a soma preenche esses campos
+ * de 'stats' e nao mexe nos demais. Somas feitas durante a partida podem
+ * ficar atras de um incremento em curso, nunca adiante.
+ *
+ * @param estado Ponteiro para o estado
+ * @param stats Recebe os totais
+ */
+void jogo_somar_contadores(EstadoJogoCompleto* estado, Estatisticas* stats);
+
+/**
+ * @brief Regras de fim de partida, sem estado compartilhado
+ *
+ * Usada por jogo_verificar_fim a cada segundo e pela simulacao, para que
+ * as duas decidam o fim do mesmo jeito.
+ * @param config Configuracao da partida (capacidade_fila ja normalizada)
+ * @param stats Estatisticas no instante da verificacao
+ * @param pendentes Modulos pendentes (fila mais deques)
+ * @param novo_estado Recebe JOGO_VITORIA ou JOGO_DERROTA se terminou
+ * @param motivo Recebe o motivo do fim
+ * @param tam_motivo Tamanho de 'motivo'
+ * @return true se a partida terminou
+ */
+bool jogo_avaliar_fim(const ConfigJogo* config, const Estatisticas* stats, int pendentes,
+                      EstadoJogo* novo_estado, char* motivo, size_t tam_motivo);
+
 /**
  * @brief Verifica condicoes de fim de jogo
  * @param estado Ponteiro para o estado
@@ -84,13 +137,6 @@ void jogo_limpar_comando(EstadoJogoCompleto* estado);
  */
 bool jogo_executar_comando(EstadoJogoCompleto* estado);
 
-/**
- * @brief Thread do coordenador (input do jogador)
- * @param arg Ponteiro para EstadoJogoCompleto
- * @return NULL
- */
-void* thread_coordenador(void* arg);
-
 /**
  * @brief Thread do temporizador
  * @param arg Ponteiro para EstadoJogoCompleto
@@ -104,6 +150,34 @@ void* thread_timer(void* arg);
  */
 ConfigJogo config_padrao(void);
 
+/**
+ * @brief Limita os campos da configuracao aos intervalos validos
+ * @param config Configuracao a ajustar
+ */
+void config_normalizar(ConfigJogo* config);
+
+/**
+ * @brief Publica estado, stats e motivo para a tela (requer mutex_estado)
+ *
+ * Chamada por quem muda o que o painel de status mostra, exceto os
+ * contadores: esses sao somados na leitura.
+ *
+ * @param estado Ponteiro para o estado
+ */
+void jogo_publicar_status(EstadoJogoCompleto* estado);
+
+/**
+ * @brief Copia o ultimo status publicado sem travar mutex_estado
+ *
+ * Os contadores do retrato vem de jogo_somar_contadores no momento da
+ * leitura, e nao da ultima publicacao.
+ *
+ * @param estado Ponteiro para o estado
+ * @param retrato Recebe o status
+ * @return Releituras por publicacao concorrente
+ */
+int jogo_ler_status(EstadoJogoCompleto* estado, RetratoStatus* retrato);
+
 /**
  * @brief Obtem o estado atual de forma segura
  * @param estado Ponteiro para o estado
@@ -119,7 +193,7 @@ EstadoJogo jogo_obter_estado(EstadoJogoCompleto* estado);
 void jogo_definir_estado(EstadoJogoCompleto* estado, EstadoJogo novo_estado);
 
 /**
- * @brief Adiciona uma mensagem de feedback
+ * @brief Adiciona uma mensagem de feedback ao diario, sem travar
  * @param estado Ponteiro para o estado
  * @param formato Formato printf
  * @param ... Argumentos
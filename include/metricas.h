@@ -0,0 +1,59 @@
+/**
+ * @file metricas.h
+ * @brief Relogio monotonico e histogramas de latencia
+ *
+ * Os histogramas usam baldes logaritmicos (SUBBALDES_HISTOGRAMA por
+ * potencia de 2 de nanossegundos), com erro relativo de no maximo 25%
+ * nos percentis e tamanho fixo, sem alocacao.
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include "tipos.h"
+#include <time.h>
+
+/**
+ * @brief Instante atual do relogio monotonico
+ * @return Nanossegundos desde um ponto arbitrario
+ */
+long long relogio_ns(void);
+
+/**
+ * @brief Converte um instante de relogio_ns em timespec (para esperas com prazo absoluto)
+ * @param ns Instante em nanossegundos
+ * @return Prazo no relogio monotonico
+ */
+struct timespec timespec_de_ns(long long ns);
+
+/**
+ * @brief Zera um histograma
+ * @param histograma Ponteiro para o histograma
+ */
+void histograma_zerar(HistogramaLatencia* histograma);
+
+/**
+ * @brief Registra uma amostra
+ * @param histograma Ponteiro para o histograma
+ * @param ns Latencia em nanossegundos (negativos contam como 0)
+ */
+void histograma_registrar(HistogramaLatencia* histograma, long long ns);
+
+/**
+ * @brief Soma 'origem' em 'destino'
+ * @param destino Histograma acumulado
+ * @param origem Histograma a somar
+ */
+void histograma_somar(HistogramaLatencia* destino, const HistogramaLatencia* origem);
+
+/**
+ * @brief Percentil aproximado (limite superior do balde)
+ * @param histograma Ponteiro para o histograma
+ * @param p Percentil em [0, 100]
+ * @return Latencia em nanossegundos (0 se vazio)
+ */
+long long histograma_percentil(const HistogramaLatencia* histograma, double p);
+
+#endif /* METRICAS_H */
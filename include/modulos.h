@@ -9,12 +9,17 @@
 #define MODULOS_H
 
 #include "tipos.h"
+#include "aleatorio.h"
 
 /**
  * @brief Inicializa a fila de modulos
  * @param fila Ponteiro para a fila
+ * @param capacidade Maximo de modulos pendentes
+ * @param crescente Se true, aloca os nos sob demanda ate a capacidade
+ * @param politica FILA_FIFO (mais antigo) ou FILA_EDF (prazo mais proximo)
+ * @return 0 se sucesso, -1 se erro
  */
-void fila_modulos_init(FilaModulos* fila);
+int fila_modulos_init(FilaModulos* fila, int capacidade, bool crescente, PoliticaFila politica);
 
 /**
  * @brief Destroi a fila de modulos (libera recursos)
@@ -25,37 +30,113 @@ void fila_modulos_destroy(FilaModulos* fila);
 /**
  * @brief Adiciona um modulo a fila
  * @param fila Ponteiro para a fila
- * @param modulo Modulo a ser adicionado
+ * @param modulo Handle do modulo (a fila passa a ser dona dele)
  * @return true se adicionado com sucesso, false se fila cheia
  */
-bool fila_modulos_adicionar(FilaModulos* fila, Modulo* modulo);
+bool fila_modulos_adicionar(FilaModulos* fila, ModuloHandle modulo);
 
 /**
- * @brief Remove um modulo da fila
+ * @brief Remove o proximo modulo da fila (mais antigo, ou mais urgente no modo EDF)
  * @param fila Ponteiro para a fila
- * @param modulo Ponteiro para armazenar o modulo removido
+ * @param modulo Ponteiro para armazenar o handle removido
  * @return true se removido com sucesso, false se fila vazia
  */
-bool fila_modulos_remover(FilaModulos* fila, Modulo* modulo);
+bool fila_modulos_remover(FilaModulos* fila, ModuloHandle* modulo);
+
+/**
+ * @brief Adiciona varios modulos reservando as vagas de uma so vez
+ *
+ * Aceita os primeiros modulos que couberem; os restantes continuam
+ * pertencendo ao chamador.
+ *
+ * @param fila Ponteiro para a fila
+ * @param modulos Handles dos modulos
+ * @param n Numero de handles
+ * @return Quantos modulos (do inicio do vetor) foram adicionados
+ */
+int fila_modulos_adicionar_lote(FilaModulos* fila, const ModuloHandle* modulos, int n);
+
+/**
+ * @brief Remove ate 'max' modulos, na ordem da politica, sob um unico lock
+ * @param fila Ponteiro para a fila
+ * @param destino Vetor que recebe os handles removidos
+ * @param max Tamanho do vetor
+ * @return Numero de modulos removidos
+ */
+int fila_modulos_remover_lote(FilaModulos* fila, ModuloHandle* destino, int max);
+
+/**
+ * @brief Esvazia a fila devolvendo todos os modulos ao pool
+ * @param fila Ponteiro para a fila
+ * @return Numero de modulos descartados
+ */
+int fila_modulos_limpar(FilaModulos* fila);
+
+/**
+ * @brief Bloqueia ate haver um modulo na fila
+ *
+ * Dorme em cond_nao_vazia sem consumir CPU. Retornar true nao garante o
+ * modulo: outro consumidor pode retira-lo antes.
+ *
+ * @param fila Ponteiro para a fila
+ * @param timeout_ms Tempo maximo de espera (<= 0 aguarda indefinidamente)
+ * @return true se ha modulo, false em timeout ou fila_modulos_despertar
+ */
+bool fila_modulos_aguardar_item(FilaModulos* fila, int timeout_ms);
+
+/**
+ * @brief Bloqueia ate haver vaga na fila
+ * @param fila Ponteiro para a fila
+ * @param timeout_ms Tempo maximo de espera (<= 0 aguarda indefinidamente)
+ * @return true se ha vaga, false em timeout ou fila_modulos_despertar
+ */
+bool fila_modulos_aguardar_espaco(FilaModulos* fila, int timeout_ms);
+
+/**
+ * @brief Acorda todas as threads bloqueadas em aguardar_item/aguardar_espaco
+ *
+ * Usada ao encerrar a partida; as esperas em curso retornam false.
+ *
+ * @param fila Ponteiro para a fila
+ */
+void fila_modulos_despertar(FilaModulos* fila);
 
 /**
  * @brief Remove um modulo especifico da fila pelo ID
  * @param fila Ponteiro para a fila
  * @param id ID do modulo a remover
- * @param modulo Ponteiro para armazenar o modulo removido
+ * @param modulo Ponteiro para armazenar o handle removido
+ * @return true se encontrado e removido, false caso contrario
+ */
+bool fila_modulos_remover_por_id(FilaModulos* fila, int id, ModuloHandle* modulo);
+
+/**
+ * @brief Remove o modulo mais antigo de um tipo (mais urgente no modo EDF)
+ * @param fila Ponteiro para a fila
+ * @param tipo Tipo procurado
+ * @param modulo Ponteiro para armazenar o handle removido
  * @return true se encontrado e removido, false caso contrario
  */
-bool fila_modulos_remover_por_id(FilaModulos* fila, int id, Modulo* modulo);
+bool fila_modulos_remover_por_tipo(FilaModulos* fila, TipoModulo tipo, ModuloHandle* modulo);
 
 /**
  * @brief Retorna um modulo especifico da fila pelo indice (0-based)
  * @param fila Ponteiro para a fila
  * @param indice Indice do modulo na fila
- * @param modulo Ponteiro para armazenar o modulo
+ * @param modulo Ponteiro para armazenar uma copia do modulo
  * @return true se encontrado, false caso contrario
  */
 bool fila_modulos_obter(FilaModulos* fila, int indice, Modulo* modulo);
 
+/**
+ * @brief Copia os primeiros modulos da fila em ordem de chegada
+ * @param fila Ponteiro para a fila
+ * @param destino Vetor para receber os modulos
+ * @param max Quantidade maxima a copiar
+ * @return Quantidade copiada
+ */
+int fila_modulos_listar(FilaModulos* fila, Modulo* destino, int max);
+
 /**
  * @brief Verifica se a fila esta vazia
  * @param fila Ponteiro para a fila
@@ -77,13 +158,47 @@ bool fila_modulos_cheia(FilaModulos* fila);
  */
 int fila_modulos_quantidade(FilaModulos* fila);
 
+/**
+ * @brief Retorna o maximo de modulos pendentes da fila
+ * @param fila Ponteiro para a fila
+ * @return Capacidade configurada
+ */
+int fila_modulos_capacidade(FilaModulos* fila);
+
 /**
  * @brief Gera um novo modulo aleatorio
+ * @param gerador Gerador da thread chamadora
+ * @param modulo Modulo a preencher (normalmente obtido do pool)
+ * @param id ID para o novo modulo
+ * @param dificuldade Nivel de dificuldade (1-3)
+ */
+void gerar_modulo_aleatorio(GeradorAleatorio* gerador, Modulo* modulo, int id, int dificuldade);
+
+/**
+ * @brief Gera um modulo de tipo (e opcionalmente parametro) definido
+ *
+ * Usada pelo modelo de chegada trace; a instrucao continua sorteada.
+ *
+ * @param gerador Gerador da thread chamadora
+ * @param modulo Modulo a preencher
  * @param id ID para o novo modulo
  * @param dificuldade Nivel de dificuldade (1-3)
- * @return Modulo gerado
+ * @param tipo Tipo do modulo
+ * @param parametro Parametro do modulo (<= 0 para sortear)
+ */
+void gerar_modulo(GeradorAleatorio* gerador, Modulo* modulo, int id, int dificuldade,
+                  TipoModulo tipo, int parametro);
+
+/**
+ * @brief Calcula o prazo de um modulo
+ *
+ * Cada modulo tem FOLGA_PRAZO_BASE / dificuldade segundos de folga alem
+ * do seu tempo de resolucao, contados a partir de criado_em.
+ *
+ * @param modulo Ponteiro para o modulo
+ * @return Instante limite para o modulo ser desarmado
  */
-Modulo gerar_modulo_aleatorio(int id, int dificuldade);
+time_t modulo_prazo(const Modulo* modulo);
 
 /**
  * @brief Retorna o nome do tipo de modulo
@@ -0,0 +1,105 @@
+/**
+ * @file piloto.h
+ * @brief Piloto automatico: a thread do coordenador no lugar do jogador
+ *
+ * A cada PERIODO_PILOTO_MS o piloto olha os pendentes, os tedax e as
+ * bancadas e designa pelo mesmo caminho do comando do jogador
+ * (tedax_designar_modulo), com a instrucao certa. Cada tedax recebe no
+ * maximo uma designacao na caixa: o ocioso comeca na hora e o ocupado ja
+ * tem a proxima quando liberar a bancada, enquanto o resto continua na
+ * fila global, onde a politica ainda pode escolher. Tedax ociosos sao
+ * servidos primeiro, depois os ocupados, em ordem de id.
+ *
+ * Politicas:
+ * - fifo:  proximo pela politica da fila (mais antigo, ou prazo no EDF),
+ *          na bancada do tedax (id % bancadas)
+ * - sjf:   menor tempo_resolucao (empate pela politica da fila), na
+ *          bancada do tedax
+ * - carga: proximo pela politica da fila, na bancada com menos trabalho
+ *          (ocupada + fila de espera + designacoes a caminho)
+ *
+ * As escolhas sao funcoes puras, usadas tambem pela simulacao (--simular).
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef PILOTO_H
+#define PILOTO_H
+
+#include "tipos.h"
+
+/**
+ * @brief Converte o nome da politica ("fifo", "sjf", "carga")
+ * @param nome Nome da politica
+ * @return Politica correspondente, ou -1 se desconhecida
+ */
+int piloto_politica_por_nome(const char* nome);
+
+/**
+ * @brief Retorna o nome de uma politica
+ * @param politica Politica do piloto
+ * @return Nome da politica ("desligado" para PILOTO_DESLIGADO)
+ */
+const char* piloto_nome_politica(PoliticaPiloto politica);
+
+/**
+ * @brief Ordem em que os tedax sao servidos na rodada
+ * @param estados Estado de cada tedax
+ * @param com_designacao Se o tedax ja tem uma designacao na caixa
+ * @param num_tedax Quantidade de tedax
+ * @param ordem Recebe os ids dos tedax sem designacao (ociosos primeiro)
+ * @return Quantidade de ids em 'ordem'
+ */
+int piloto_ordenar_tedax(const Estado* estados, const bool* com_designacao, int num_tedax, int* ordem);
+
+/**
+ * @brief Escolhe o proximo modulo entre os pendentes
+ * @param politica Politica do piloto
+ * @param politica_fila Ordem da fila (FIFO ou EDF)
+ * @param candidatos Pendentes em ordem de chegada
+ * @param n Quantidade de pendentes
+ * @return Indice do escolhido, ou -1 se n == 0
+ */
+int piloto_escolher_modulo(PoliticaPiloto politica, PoliticaFila politica_fila, const CandidatoPiloto* candidatos,
+                           int n);
+
+/**
+ * @brief Escolhe a bancada de uma designacao
+ * @param politica Politica do piloto
+ * @param tedax Id do tedax designado
+ * @param carga Trabalho em cada bancada (usado por PILOTO_MENOS_CARREGADA)
+ * @param num_bancadas Quantidade de bancadas
+ * @return Id da bancada
+ */
+int piloto_escolher_bancada(PoliticaPiloto politica, int tedax, const int* carga, int num_bancadas);
+
+/**
+ * @brief Aloca os vetores de uma rodada para a configuracao
+ * @param rascunho Rascunho a preencher
+ * @param config Configuracao (capacidade da fila, tedax e bancadas)
+ * @return 0 se sucesso, -1 se erro
+ */
+int piloto_rascunho_init(RascunhoPiloto* rascunho, const ConfigJogo* config);
+
+/**
+ * @brief Libera os vetores do rascunho
+ * @param rascunho Rascunho do piloto
+ */
+void piloto_rascunho_destroy(RascunhoPiloto* rascunho);
+
+/**
+ * @brief Uma rodada do piloto sobre o jogo real
+ * @param estado Estado do jogo
+ * @param rascunho Vetores de trabalho (piloto_rascunho_init com a mesma configuracao)
+ * @return Designacoes feitas
+ */
+int piloto_rodada(EstadoJogoCompleto* estado, RascunhoPiloto* rascunho);
+
+/**
+ * @brief Thread do coordenador: uma rodada do piloto a cada PERIODO_PILOTO_MS
+ * @param arg Ponteiro para o estado do jogo
+ * @return NULL
+ */
+void* thread_coordenador(void* arg);
+
+#endif /* PILOTO_H */
@@ -0,0 +1,74 @@
+/**
+ * @file pool_modulos.h
+ * @brief Pool de modulos alocados em slabs e referenciados por handle
+ *
+ * Os modulos vivem em slabs de tamanho fixo que nunca sao movidos nem
+ * liberados durante a partida. Fila, tedax e bancadas trocam apenas o
+ * handle de 32 bits. Cada thread mantem um cache local de handles
+ * livres e so toca a lista global (com mutex) em lotes.
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef POOL_MODULOS_H
+#define POOL_MODULOS_H
+
+#include "tipos.h"
+
+/**
+ * @struct EstatisticasPool
+ * @brief Contadores do pool de modulos
+ */
+typedef struct {
+    long alocacoes_heap;            /* Chamadas a malloc feitas pelo pool (slabs) */
+    long handles_total;             /* Handles existentes em todos os slabs */
+} EstatisticasPool;
+
+/**
+ * @brief Inicializa o pool (pre-aloca um slab)
+ * @return 0 se sucesso, -1 se erro
+ */
+int pool_modulos_init(void);
+
+/**
+ * @brief Libera todos os slabs do pool
+ *
+ * Deve ser chamada pela thread principal depois que as demais threads
+ * devolveram seus caches.
+ */
+void pool_modulos_destroy(void);
+
+/**
+ * @brief Obtem um modulo livre do pool
+ * @return Handle do modulo ou MODULO_HANDLE_NULO se sem memoria
+ */
+ModuloHandle pool_modulos_alocar(void);
+
+/**
+ * @brief Devolve um modulo ao pool
+ * @param handle Handle obtido com pool_modulos_alocar
+ */
+void pool_modulos_liberar(ModuloHandle handle);
+
+/**
+ * @brief Resolve um handle para o modulo correspondente
+ * @param handle Handle valido
+ * @return Ponteiro estavel para o modulo, ou NULL se handle invalido
+ */
+Modulo* pool_modulos_obter(ModuloHandle handle);
+
+/**
+ * @brief Devolve o cache local da thread a lista global
+ *
+ * Deve ser chamada por threads que alocam ou liberam modulos antes de
+ * terminarem.
+ */
+void pool_modulos_devolver_cache(void);
+
+/**
+ * @brief Retorna os contadores do pool
+ * @return Copia das estatisticas
+ */
+EstatisticasPool pool_modulos_estatisticas(void);
+
+#endif /* POOL_MODULOS_H */
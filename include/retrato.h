@@ -0,0 +1,49 @@
+/**
+ * @file retrato.h
+ * @brief Retratos publicados por seqlock para leitores que nao travam
+ *
+ * Cada retrato tem duas copias (seqlock "latch"). O escritor (um por vez,
+ * serializado pelo mutex do dono) torna a versao impar e reescreve a
+ * copia 0, depois a torna par e reescreve a copia 1; a paridade indica ao
+ * leitor a copia que nao esta mudando. O leitor copia entre duas leituras
+ * da versao e so repete se uma publicacao avancou no meio: nunca espera
+ * um escritor interrompido no meio da copia, nem com uma so CPU. As
+ * palavras sao atomicas relaxadas (a copia concorrente nao e corrida de
+ * dados) e as cercas ordenam as copias em relacao a versao.
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef RETRATO_H
+#define RETRATO_H
+
+#include "tipos.h"
+
+/**
+ * @brief Zera o retrato e a versao (antes de qualquer leitor)
+ * @param seq Versao do retrato
+ * @param palavras Armazenamento do retrato
+ * @param bytes Tamanho do tipo do retrato
+ */
+void retrato_init(Seqlock* seq, _Atomic uint64_t* palavras, size_t bytes);
+
+/**
+ * @brief Publica um novo retrato (escritores serializados pelo chamador)
+ * @param seq Versao do retrato
+ * @param palavras Armazenamento das duas copias (PALAVRAS_RETRATO do tipo)
+ * @param origem Retrato novo
+ * @param bytes Tamanho do tipo do retrato
+ */
+void retrato_publicar(Seqlock* seq, _Atomic uint64_t* palavras, const void* origem, size_t bytes);
+
+/**
+ * @brief Copia um retrato consistente sem travar
+ * @param seq Versao do retrato
+ * @param palavras Armazenamento do retrato
+ * @param destino Recebe o retrato
+ * @param bytes Tamanho do tipo do retrato
+ * @return Quantas vezes a copia foi repetida por uma publicacao no meio
+ */
+int retrato_ler(Seqlock* seq, _Atomic uint64_t* palavras, void* destino, size_t bytes);
+
+#endif /* RETRATO_H */
@@ -0,0 +1,49 @@
+/**
+ * @file simulacao.h
+ * @brief Partidas em tempo virtual (simulacao de eventos discretos)
+ *
+ * Roda uma partida inteira sem threads nem sono: chegadas do mural, fim
+ * de cada resolucao, sondagens de bancada dos tedax autonomos e os tiques
+ * do timer viram eventos em um heap ordenado por instante virtual. Usa os
+ * mesmos geradores (chegadas.c e gerar_modulo, com os mesmos fluxos da
+ * semente) e as mesmas regras de fim (jogo_avaliar_fim) que a partida real,
+ * entao a mesma ConfigJogo e a mesma semente dao o mesmo desfecho.
+ *
+ * Modelo da partida real reproduzido:
+ * - Tedax autonomos assumem o proximo pendente (FIFO ou EDF) assim que
+ *   ficam livres, tentam a "sua" bancada e depois as outras; sem bancada,
+ *   entram na fila FIFO da sua e revisitam as outras a cada
+ *   ESPERA_AUTONOMO_MS.
+ * - Com --piloto, uma rodada do piloto a cada PERIODO_PILOTO_MS faz as
+ *   mesmas escolhas de piloto_rodada; o tedax assume a designacao ao
+ *   ficar livre e espera a entrega da bancada designada. Sem piloto nem
+ *   autonomia os tedax ficam parados (nao ha jogador).
+ * - Com a fila cheia o mural segura a chegada (e o id) e espera a vaga em
+ *   trechos de ESPERA_VAGA_MURAL_MS, sem descartar nada.
+ * - O timer tique FASE_TIMER_MS depois de cada segundo cheio; o que vence
+ *   no mesmo instante segue a ordem de TipoEventoSimulacao (a rodada do
+ *   piloto vem antes do fim de um trabalho que ela mesma designou, que na
+ *   partida real comeca um pouco depois do prazo da rodada).
+ *
+ * Diferencas conhecidas: o EDF usa o segundo virtual da chegada em vez do
+ * relogio de parede, e empates de latencia da partida real (por exemplo,
+ * qual tedax ocioso acorda primeiro) sao resolvidos pelo menor id.
+ *
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#ifndef SIMULACAO_H
+#define SIMULACAO_H
+
+#include "tipos.h"
+
+/**
+ * @brief Joga uma partida inteira em tempo virtual
+ * @param config Configuracao da partida (normalizada como em jogo_init)
+ * @param semente Semente da partida (0 = relogio, como --seed ausente)
+ * @param resultado Recebe o desfecho
+ * @return 0 se sucesso, -1 se o modelo de chegada ou a fila nao puderam ser criados
+ */
+int simulacao_executar(const ConfigJogo* config, uint64_t semente, ResultadoSimulacao* resultado);
+
+#endif /* SIMULACAO_H */
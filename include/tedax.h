@@ -32,27 +32,40 @@ void tedax_destroy(Tedax* tedax);
 int tedax_iniciar_thread(Tedax* tedax);
 
 /**
- * @brief Para a thread do tedax
+ * @brief Inicia o tedax como maquina de estados em um pool de threads
+ * @param tedax Ponteiro para o tedax
+ * @param executor Pool que vai rodar o tedax
+ * @return 0 se sucesso, -1 se erro
+ */
+int tedax_iniciar_tarefa(Tedax* tedax, Executor* executor);
+
+/**
+ * @brief Para a thread do tedax (ou encerra a sua tarefa no pool)
  * @param tedax Ponteiro para o tedax
  */
 void tedax_parar_thread(Tedax* tedax);
 
 /**
- * @brief Verifica se o tedax esta disponivel
+ * @brief Verifica se o tedax esta ocioso (livre e com a caixa vazia)
  * @param tedax Ponteiro para o tedax
  * @return true se disponivel
  */
 bool tedax_disponivel(Tedax* tedax);
 
 /**
- * @brief Designa um modulo para o tedax
+ * @brief Poe um modulo na caixa de designacoes do tedax
+ *
+ * O tedax pode estar ocupado: ele assume a designacao mais antiga assim
+ * que libera a bancada. A caixa e SPSC, entao so uma thread (o
+ * coordenador) pode designar de cada vez.
+ *
  * @param tedax Ponteiro para o tedax
- * @param modulo Ponteiro para o modulo
+ * @param modulo Handle do modulo (o tedax passa a ser dono dele se designado)
  * @param bancada_id ID da bancada a usar
- * @param instrucao Instrucao do coordenador
- * @return true se designado com sucesso
+ * @param instrucao Instrucao do coordenador (codificada no tipo pedido)
+ * @return true se designado, false se a caixa estiver cheia
  */
-bool tedax_designar_modulo(Tedax* tedax, Modulo* modulo, int bancada_id, const char* instrucao);
+bool tedax_designar_modulo(Tedax* tedax, ModuloHandle modulo, int bancada_id, const InstrucaoCodificada* instrucao);
 
 /**
  * @brief Retorna o estado atual do tedax como string
@@ -61,8 +74,57 @@ bool tedax_designar_modulo(Tedax* tedax, Modulo* modulo, int bancada_id, const c
  */
 const char* tedax_estado_str(Tedax* tedax);
 
+/**
+ * @brief Quantidade de modulos na deque local (modo autonomo)
+ * @param tedax Ponteiro para o tedax
+ * @return Modulos puxados da fila e ainda nao iniciados
+ */
+int tedax_quantidade_deque(Tedax* tedax);
+
+/**
+ * @brief Quantidade de designacoes na caixa, ainda nao iniciadas
+ * @param tedax Ponteiro para o tedax
+ * @return 0 a CAPACIDADE_CAIXA_TEDAX
+ */
+int tedax_quantidade_caixa(Tedax* tedax);
+
+/**
+ * @brief Publica o retrato do tedax para a tela
+ *
+ * So o dono do tedax (a sua thread ou tarefa) muda estado e contadores,
+ * entao as publicacoes ja sao serializadas; fora da partida, quem reinicia.
+ *
+ * @param tedax Ponteiro para o tedax
+ */
+void tedax_publicar(Tedax* tedax);
+
+/**
+ * @brief Copia o ultimo retrato publicado sem travar o tedax
+ * @param tedax Ponteiro para o tedax
+ * @param retrato Recebe estado e contadores
+ * @return Releituras por publicacao concorrente
+ */
+int tedax_ler_retrato(Tedax* tedax, RetratoTedax* retrato);
+
+/**
+ * @brief Soma as designacoes da caixa na carga de cada bancada (so para o coordenador)
+ * @param tedax Ponteiro para o tedax
+ * @param carga Carga por id de bancada, incrementada por designacao ainda nao iniciada
+ */
+void tedax_somar_designacoes(Tedax* tedax, int* carga);
+
+/**
+ * @brief Descarta as designacoes nao iniciadas, devolvendo os modulos ao pool
+ * @param tedax Ponteiro para o tedax (sem trabalho em andamento)
+ */
+void tedax_esvaziar_caixa(Tedax* tedax);
+
 /**
  * @brief Thread principal do tedax
+ *
+ * Com config.tedax_autonomos o tedax busca trabalho sozinho: consome a
+ * propria deque, reabastece-a em lotes da fila global e, ocioso, rouba
+ * da deque de outro tedax. Tarefas designadas tem prioridade.
  * @param arg Ponteiro para o Tedax
  * @return NULL
  */
@@ -75,7 +137,7 @@ void* thread_tedax(void* arg);
  * @param instrucao Instrucao fornecida
  * @return true se resolvido com sucesso
  */
-bool tedax_resolver_modulo(Tedax* tedax, Modulo* modulo, const char* instrucao);
+bool tedax_resolver_modulo(Tedax* tedax, Modulo* modulo, const InstrucaoCodificada* instrucao);
 
 /**
  * @brief Verifica se a instrucao esta correta para o modulo
@@ -83,6 +145,6 @@ bool tedax_resolver_modulo(Tedax* tedax, Modulo* modulo, const char* instrucao);
  * @param instrucao Instrucao fornecida
  * @return true se correta
  */
-bool verificar_instrucao(Modulo* modulo, const char* instrucao);
+bool verificar_instrucao(Modulo* modulo, const InstrucaoCodificada* instrucao);
 
 #endif /* TEDAX_H */
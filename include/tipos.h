@@ -11,20 +11,47 @@
 #define TIPOS_H
 
 #include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 
 /* ==================== CONSTANTES ==================== */
 
-#define MAX_TEDAX 3
-#define MAX_BANCADAS 5
-#define MAX_MODULOS_PENDENTES 10
+#define MAX_TEDAX 4096              /* limite de --tedax (vetores alocados pela configuracao) */
+#define MAX_BANCADAS 4096           /* limite de --bancadas */
+#define MAX_TEDAX_MENU 3            /* limites do menu de configuracoes (cabem na tela) */
+#define MAX_BANCADAS_MENU 5
+#define MAX_MODULOS_PENDENTES 10    /* capacidade padrao da fila de pendentes */
 #define MAX_NOME_MODULO 32
-#define MAX_INSTRUCAO 64
+#define MAX_SIMBOLOS_INSTRUCAO 32   /* simbolos de uma instrucao (2 bits cada, ver instrucao.h) */
+
+#define TAMANHO_LINHA_CACHE 64
+#define CAPACIDADE_ENTRADA_MAX 1024 /* slots da fila lock-free de entrada */
+#define CAPACIDADE_NOS_INICIAL 16   /* nos alocados de inicio em fila crescente */
+#define CAPACIDADE_DIARIO 256       /* entradas do diario de mensagens (potencia de 2) */
+#define MAX_TEXTO_DIARIO 112        /* texto de uma entrada, com o '\0' */
 
 #define TEMPO_PARTIDA_PADRAO 120    /* segundos */
 #define INTERVALO_GERACAO_MIN 3     /* segundos entre geracao de modulos */
 #define INTERVALO_GERACAO_MAX 8
+#define MAX_CAMINHO 256             /* caminho do arquivo de trace */
+#define TAXA_CHEGADA_PADRAO 12.0    /* modulos/min (Poisson; calmaria nas rajadas) */
+#define TAXA_RAJADA_PADRAO 40.0     /* modulos/min durante uma rajada */
+#define DURACAO_RAJADA_PADRAO 10.0  /* segundos, em media */
+#define DURACAO_CALMARIA_PADRAO 30.0
+#define FOLGA_PRAZO_BASE 30         /* segundos de folga de um modulo de dificuldade 1 */
+#define CAPACIDADE_DEQUE_TEDAX 8    /* modulos na deque local de um tedax autonomo */
+#define LOTE_PULL_TEDAX 2           /* modulos puxados da fila global por vez */
+#define CAPACIDADE_CAIXA_TEDAX 4    /* designacoes enfileiradas por tedax (potencia de 2) */
+#define ESPERA_AUTONOMO_MS 50       /* tedax autonomo revisita a fila e as outras bancadas */
+#define ESPERA_VAGA_MURAL_MS 100    /* mural espera uma vaga com a fila cheia */
+#define FASE_TIMER_MS 10            /* atraso de cada segundo do timer sobre o segundo cheio */
+#define PERIODO_PILOTO_MS 100       /* intervalo entre as rodadas do piloto automatico */
+#define SUBBALDES_HISTOGRAMA 4      /* baldes por potencia de 2 (precisao de 25%) */
+#define BALDES_HISTOGRAMA (SUBBALDES_HISTOGRAMA * 40) /* ate ~2^41 ns (~36 min) */
 
 /* Tipos de modulos */
 typedef enum {
@@ -35,6 +62,40 @@ typedef enum {
     MODULO_TOTAL
 } TipoModulo;
 
+/* Politica de escolha dos modulos pendentes */
+typedef enum {
+    FILA_FIFO = 0,          /* Mais antigo primeiro */
+    FILA_EDF                /* Prazo mais proximo primeiro (Earliest Deadline First) */
+} PoliticaFila;
+
+/* Politica do piloto automatico (thread do coordenador) */
+typedef enum {
+    PILOTO_DESLIGADO = 0,   /* Comandos do jogador */
+    PILOTO_FIFO,            /* Proximo pela politica da fila, na bancada do tedax */
+    PILOTO_SJF,             /* Menor tempo_resolucao primeiro (Shortest Job First) */
+    PILOTO_MENOS_CARREGADA, /* Proximo pela politica da fila, na bancada com menos trabalho */
+    PILOTO_TOTAL
+} PoliticaPiloto;
+
+/* Modelo de chegada dos modulos (ver chegadas.h) */
+typedef enum {
+    CHEGADA_UNIFORME = 0,   /* Intervalo uniforme ajustado pela dificuldade */
+    CHEGADA_POISSON,        /* Intervalos exponenciais com taxa fixa */
+    CHEGADA_RAJADAS,        /* On/off: calmaria e rajadas (MMPP) */
+    CHEGADA_TRACE,          /* Repeticao de um arquivo (instante, tipo, parametro) */
+    CHEGADA_TOTAL
+} ModeloChegada;
+
+/* Papel de cada thread do motor (afinidade de CPU e nome, ver afinidade.h) */
+typedef enum {
+    PAPEL_INTERFACE = 0,    /* Thread principal: entrada e tela */
+    PAPEL_MURAL,            /* Geracao de modulos */
+    PAPEL_TIMER,            /* Contagem regressiva */
+    PAPEL_TEDAX,            /* Threads dos tedax ou trabalhadores do executor (--tedax-pool) */
+    PAPEL_COORDENADOR,      /* Piloto automatico (--piloto) */
+    PAPEL_TOTAL
+} PapelThread;
+
 /* Estados dos elementos do jogo */
 typedef enum {
     ESTADO_LIVRE = 0,
@@ -56,6 +117,19 @@ typedef enum {
 
 /* ==================== ESTRUTURAS ==================== */
 
+/**
+ * @struct InstrucaoCodificada
+ * @brief Instrucao com 2 bits por simbolo (ver instrucao.h)
+ *
+ * 16 bytes sem preenchimento, para que duas instrucoes possam ser
+ * comparadas como blocos de memoria (e em lote, com SIMD).
+ */
+typedef struct {
+    uint64_t simbolos;              /* Simbolo i nos bits 2i e 2i+1; bits acima do tamanho zerados */
+    uint32_t tamanho;               /* 0 = invalida (nunca confere) */
+    uint32_t tipo;                  /* TipoModulo do alfabeto */
+} InstrucaoCodificada;
+
 /**
  * @struct Modulo
  * @brief Representa um modulo da bomba a ser desarmado
@@ -67,59 +141,478 @@ typedef struct {
     int dificuldade;                /* 1-3, afeta tempo de resolucao */
     int tempo_resolucao;            /* Tempo em segundos para resolver */
     int parametro;                  /* Parametro especifico do tipo (ex: qtd de cliques) */
-    char instrucao[MAX_INSTRUCAO];  /* Instrucao para o jogador */
+    InstrucaoCodificada instrucao;  /* Instrucao para o jogador */
     bool resolvido;                 /* Se foi resolvido com sucesso */
     int tentativas;                 /* Numero de tentativas */
     time_t criado_em;               /* Quando foi criado */
+    long long enfileirado_ns;       /* Entrada na fila (relogio monotonico, ns) */
 } Modulo;
 
+/**
+ * @struct CandidatoPiloto
+ * @brief O que o piloto automatico olha em um modulo pendente
+ */
+typedef struct {
+    int tempo_resolucao;            /* Segundos de bancada */
+    long long prazo;                /* Chave EDF (modulo_prazo) */
+} CandidatoPiloto;
+
+/**
+ * @struct RascunhoPiloto
+ * @brief Vetores de trabalho de uma rodada do piloto (ver piloto.h)
+ */
+typedef struct {
+    Modulo* pendentes;              /* capacidade_fila */
+    CandidatoPiloto* candidatos;    /* capacidade_fila */
+    Estado* estados;                /* num_tedax */
+    bool* com_designacao;           /* num_tedax */
+    int* ordem;                     /* num_tedax */
+    int* carga;                     /* num_bancadas */
+} RascunhoPiloto;
+
+/* Referencia a um Modulo do pool (ver pool_modulos.h) */
+typedef uint32_t ModuloHandle;
+#define MODULO_HANDLE_NULO UINT32_MAX
+
+struct TarefaExecutor;
+struct Executor;
+
+/**
+ * @struct EsperaBancada
+ * @brief Lugar de um tedax na fila de espera de uma bancada (memoria do tedax)
+ */
+typedef struct EsperaBancada {
+    int tedax_id;                   /* Quem recebe a bancada */
+    ModuloHandle modulo;            /* Modulo que vai para a bancada */
+    bool concedida;                 /* Bancada ja entregue a este tedax */
+    pthread_cond_t cond;            /* Acorda a thread dona (CLOCK_MONOTONIC) */
+    struct Executor* executor;      /* Modo pool: acorda 'tarefa' em vez da cond */
+    struct TarefaExecutor* tarefa;
+    struct EsperaBancada* prox;     /* Proximo da fila */
+} EsperaBancada;
+
+#define BITS_PALAVRA_MAPA 64
+
+struct Bancada;
+
+/**
+ * @struct MapaBancadas
+ * @brief Bitmap atomico das bancadas livres (bit 1 = livre), 64 por palavra
+ *
+ * O bit e a posse da passagem de livre para ocupada: so quem o apaga
+ * (CAS ou fetch_and) pode ocupar a bancada, e quem a libera sem ninguem
+ * na fila acende o bit de novo sob o mutex da bancada.
+ */
+typedef struct MapaBancadas {
+    _Atomic uint64_t* palavras;     /* num_palavras palavras */
+    int num_palavras;
+    int num_bancadas;
+    struct Bancada* bancadas;       /* Bancadas cobertas (bit i = bancadas[i]) */
+} MapaBancadas;
+
+/** Palavras de 64 bits que guardam as duas copias de um retrato do tipo dado (ver retrato.h) */
+#define PALAVRAS_RETRATO(tipo) (2 * ((sizeof(tipo) + sizeof(uint64_t) - 1) / sizeof(uint64_t)))
+
+/**
+ * @struct Seqlock
+ * @brief Versao de um retrato publicado; a paridade diz qual copia esta estavel
+ *
+ * Um escritor por vez (o mutex do dono do retrato os serializa); leitores
+ * nao travam nada e repetem a copia se a versao mudou no meio.
+ */
+typedef struct {
+    _Atomic unsigned versao;
+} Seqlock;
+
+/**
+ * @struct RetratoBancada
+ * @brief O que a tela mostra de uma bancada
+ */
+typedef struct {
+    Estado estado;
+    int tedax_id;                   /* -1 se livre */
+    char modulo[MAX_NOME_MODULO];   /* Nome do modulo na bancada ("" se livre) */
+} RetratoBancada;
+
 /**
  * @struct Bancada
  * @brief Representa uma bancada de desativacao
+ *
+ * Quem espera entra em uma fila FIFO. Ao liberar, a bancada passa direto
+ * para o primeiro da fila sem ficar livre no meio, entao ninguem fura a
+ * fila e nao ha intervalo ocioso entre um tedax e o proximo.
+ *
+ * Alinhada a linha de cache: a primeira linha e fria (fixa ou so do laco
+ * antigo) e o mutex abre as linhas quentes, escritas a cada posse, que
+ * nenhuma outra bancada do vetor compartilha.
  */
-typedef struct {
-    int id;                         /* Identificador da bancada */
+typedef struct Bancada {
+    /* Frio */
+    alignas(TAMANHO_LINHA_CACHE) int id; /* Identificador da bancada */
+    MapaBancadas* mapa;             /* Bitmap de livres (NULL = sem mapa) */
+    pthread_cond_t cond_livre;      /* Condicao para bancada livre (bancada_aguardar_livre) */
+
+    /* Quente, sob 'mutex' */
+    alignas(TAMANHO_LINHA_CACHE) pthread_mutex_t mutex; /* Mutex para acesso a bancada */
     Estado estado;                  /* Livre ou ocupada */
-    Modulo* modulo_atual;           /* Modulo sendo desarmado */
     int tedax_id;                   /* ID do tedax usando a bancada (-1 se livre) */
-    pthread_mutex_t mutex;          /* Mutex para acesso a bancada */
-    pthread_cond_t cond_livre;      /* Condicao para bancada livre */
+    ModuloHandle modulo_atual;      /* Modulo sendo desarmado */
+    int esperando;                  /* Tedax na fila */
+    EsperaBancada* fila_inicio;     /* Fila de espera (entrega direta) */
+    EsperaBancada* fila_fim;
+
+    /* Retrato para a tela, publicado sob 'mutex' a cada mudanca */
+    alignas(TAMANHO_LINHA_CACHE) Seqlock seq_retrato;
+    _Atomic uint64_t retrato[PALAVRAS_RETRATO(RetratoBancada)];
 } Bancada;
 
+/**
+ * @struct HistogramaLatencia
+ * @brief Histograma logaritmico de latencias em nanossegundos (ver metricas.h)
+ */
+typedef struct {
+    long baldes[BALDES_HISTOGRAMA];
+    long total;
+} HistogramaLatencia;
+
+/* Estado de uma tarefa do executor (ver executor.h) */
+typedef enum {
+    TAREFA_PRONTA = 0,              /* Na fila de prontas */
+    TAREFA_RODANDO,                 /* Executando um passo em um trabalhador */
+    TAREFA_DORMINDO,                /* No heap de timers ate 'prazo' */
+    TAREFA_ESTACIONADA,             /* Aguardando executor_acordar */
+    TAREFA_CONCLUIDA
+} EstadoTarefa;
+
+/* Passo de uma tarefa: devolve quando rodar de novo (ver executor.h) */
+typedef long long (*PassoTarefa)(void* arg);
+
+/**
+ * @struct TarefaExecutor
+ * @brief Tarefa leve multiplexada nos trabalhadores de um Executor
+ */
+typedef struct TarefaExecutor {
+    PassoTarefa passo;              /* Funcao de um passo */
+    void* arg;                      /* Argumento do passo */
+    EstadoTarefa estado;
+    long long prazo;                /* Proxima execucao (TAREFA_DORMINDO) */
+    int pos_heap;                   /* Posicao no heap de timers (-1 fora dele) */
+    struct TarefaExecutor* prox;    /* Encadeamento na fila de prontas */
+    bool acordar_pendente;          /* executor_acordar durante um passo */
+} TarefaExecutor;
+
+/**
+ * @struct Executor
+ * @brief Pool fixo de threads que roda tarefas e gerencia as esperas com prazo
+ *
+ * Um unico mutex protege a fila de prontas e o heap de timers. Um dos
+ * trabalhadores ociosos (o vigia) dorme ate o prazo mais proximo; os
+ * demais esperam trabalho sem prazo.
+ */
+typedef struct Executor {
+    pthread_t* trabalhadores;
+    int num_trabalhadores;
+    void (*ao_sair)(void);          /* Chamado por cada trabalhador ao terminar */
+    TarefaExecutor* prontas_inicio; /* Fila FIFO de tarefas prontas */
+    TarefaExecutor* prontas_fim;
+    TarefaExecutor** timers;        /* Heap minimo por prazo */
+    int tam_timers;
+    int capacidade_timers;
+    bool ha_vigia;                  /* Algum trabalhador espera o prazo do topo */
+    int ociosos;                    /* Trabalhadores em cond_trabalho */
+    bool parando;
+    long passos;                    /* Passos executados */
+    pthread_mutex_t mutex;
+    pthread_cond_t cond_trabalho;   /* Tarefa pronta (CLOCK_MONOTONIC) */
+    pthread_cond_t cond_vigia;      /* Novo prazo mais proximo (CLOCK_MONOTONIC) */
+    pthread_cond_t cond_concluida;  /* Alguma tarefa terminou */
+} Executor;
+
+/* Fase da maquina de estados de um tedax no executor */
+typedef enum {
+    FASE_BUSCAR = 0,                /* Procurando trabalho */
+    FASE_BANCADA,                   /* Com modulo, tentando ocupar a bancada */
+    FASE_TRABALHO                   /* Desarmando (um passo por decimo de segundo) */
+} FaseTedax;
+
+/**
+ * @struct Designacao
+ * @brief Tarefa enviada pelo coordenador a um tedax
+ */
+typedef struct {
+    ModuloHandle modulo;            /* Modulo designado */
+    int bancada;                    /* ID da bancada designada */
+    InstrucaoCodificada instrucao;  /* Instrucao recebida do coordenador */
+} Designacao;
+
+/**
+ * @struct CaixaTarefas
+ * @brief Anel SPSC de designacoes: o coordenador produz, o tedax consome
+ *
+ * Os indices so crescem (a posicao e o indice modulo a capacidade) e cada
+ * um tem um unico escritor; ficam em linhas de cache distintas.
+ */
+typedef struct {
+    Designacao itens[CAPACIDADE_CAIXA_TEDAX];
+    atomic_uint escrita;            /* Proxima designacao a publicar (coordenador) */
+    char pad0[TAMANHO_LINHA_CACHE - sizeof(atomic_uint)];
+    atomic_uint leitura;            /* Proxima designacao a assumir (tedax) */
+    char pad1[TAMANHO_LINHA_CACHE - sizeof(atomic_uint)];
+} CaixaTarefas;
+
+/**
+ * @struct RetratoTedax
+ * @brief O que a tela mostra de um tedax (a caixa e lida direto, sem trava)
+ */
+typedef struct {
+    Estado estado;
+    int desarmados;
+    int falhados;
+} RetratoTedax;
+
+/**
+ * @struct EntradaDiario
+ * @brief Uma mensagem do diario (jogo_feedback)
+ */
+typedef struct {
+    uint64_t numero;                /* Ordem de chegada, a partir de 1 */
+    long long instante_ns;          /* relogio_ns na publicacao */
+    char texto[MAX_TEXTO_DIARIO];
+} EntradaDiario;
+
+/**
+ * @struct SlotDiario
+ * @brief Lugar de uma entrada no anel; a volta seguinte do anel o reaproveita
+ */
+typedef struct {
+    alignas(TAMANHO_LINHA_CACHE) atomic_bool ocupado; /* Um escritor por vez no slot */
+    _Atomic uint64_t numero;        /* Ultima entrada escrita aqui (0 = nenhuma) */
+    Seqlock seq;
+    _Atomic uint64_t entrada[PALAVRAS_RETRATO(EntradaDiario)];
+} SlotDiario;
+
+/**
+ * @struct Diario
+ * @brief Anel limitado de mensagens: muitos produtores, leitores sem travar
+ *
+ * Cada produtor pega um numero com fetch_add e escreve no slot desse
+ * numero como um retrato; a entrada mais antiga e sobrescrita quando o
+ * anel da a volta. Ninguem espera: se o slot ainda esta com o escritor
+ * da volta anterior, a entrada e descartada e contada.
+ */
+typedef struct {
+    alignas(TAMANHO_LINHA_CACHE) _Atomic uint64_t proximo; /* Numero da proxima entrada */
+    alignas(TAMANHO_LINHA_CACHE) _Atomic long descartadas; /* Slot ocupado ou ja com entrada mais nova */
+    _Atomic uint64_t visto_ate;     /* Ultimo numero que algum leitor ja alcancou */
+    _Atomic long sobrescritas;      /* Entradas que sairam do anel antes de algum leitor alcancar */
+    SlotDiario slots[CAPACIDADE_DIARIO];
+} Diario;
+
+/**
+ * @struct EstatisticasDiario
+ * @brief Contadores do diario (diario_estatisticas)
+ */
+typedef struct {
+    long publicadas;                /* Numeros entregues aos produtores */
+    long descartadas;               /* Nao escritas: slot com outro escritor ou entrada mais nova */
+    long sobrescritas;              /* Escritas, mas sobrescritas antes de algum leitor as alcancar */
+} EstatisticasDiario;
+
 /**
  * @struct Tedax
  * @brief Representa um Tecnico Especialista em Desativacao de Artefatos Explosivos
+ *
+ * Alinhado a linha de cache e dividido pelo padrao de acesso: o que outras
+ * threads leem e escrevem (mutex, estado, deque, caixa, lugar na fila da
+ * bancada) fica em linhas proprias, longe do trabalho e das estatisticas
+ * que so o dono escreve e dos campos fixos. Tedax vizinhos no vetor nunca
+ * compartilham linha.
  */
 typedef struct {
-    int id;                         /* Identificador do tedax */
+    /* Frio: fixo depois de tedax_init e de iniciar a thread ou a tarefa */
+    alignas(TAMANHO_LINHA_CACHE) int id; /* Identificador do tedax */
+    pthread_t thread;               /* Thread do tedax */
+    bool ativo;                     /* Se a thread esta ativa */
+    Executor* executor;             /* Modo pool: NULL no modo thread */
+
+    /* Compartilhado, sob 'mutex': piloto, tela e ladroes leem */
+    alignas(TAMANHO_LINHA_CACHE) pthread_mutex_t mutex; /* Mutex para estado do tedax */
     Estado estado;                  /* Livre, ocupado ou aguardando */
-    Modulo* modulo_atual;           /* Modulo sendo desarmado */
+    ModuloHandle modulo_atual;      /* Modulo sendo desarmado */
     Bancada* bancada_atual;         /* Bancada sendo utilizada */
-    int modulos_desarmados;         /* Contador de sucessos */
-    int modulos_falhados;           /* Contador de falhas */
-    pthread_t thread;               /* Thread do tedax */
-    pthread_mutex_t mutex;          /* Mutex para estado do tedax */
     pthread_cond_t cond_tarefa;     /* Condicao para nova tarefa */
-    bool ativo;                     /* Se a thread esta ativa */
 
-    /* Dados da tarefa atual */
-    int bancada_designada;          /* ID da bancada designada (-1 se nenhuma) */
-    char instrucao_recebida[MAX_INSTRUCAO]; /* Instrucao recebida do coordenador */
-    bool tarefa_pendente;           /* Se ha tarefa pendente */
+    /* Modo autonomo: deque local (protegida por 'mutex'). O dono consome
+     * do inicio e outros tedax roubam do inicio tambem, pois o item mais
+     * antigo e o mais urgente. */
+    ModuloHandle deque[CAPACIDADE_DEQUE_TEDAX];
+    int deque_inicio;               /* Indice do item mais antigo */
+    int deque_qtd;                  /* Itens na deque */
+
+    /* Designacoes ainda nao iniciadas, na ordem em que chegaram */
+    alignas(TAMANHO_LINHA_CACHE) CaixaTarefas caixa;
+
+    /* Escritos por quem entrega a bancada ou acorda a tarefa */
+    alignas(TAMANHO_LINHA_CACHE) EsperaBancada espera_bancada; /* Lugar na fila de uma bancada */
+    Bancada* bancada_espera;        /* Bancada em cuja fila esta (NULL se nenhuma) */
+    TarefaExecutor tarefa;          /* Modo pool: o tedax e uma maquina de estados */
+
+    /* Privado do dono: trabalho atual (separado da designacao, que pode chegar a qualquer momento) */
+    alignas(TAMANHO_LINHA_CACHE) int bancada_alvo; /* Bancada do trabalho atual (ou BANCADA_QUALQUER) */
+    FaseTedax fase;
+    InstrucaoCodificada instrucao_atual;
+    long long trabalho_restante_ns; /* Tempo de resolucao que falta (congela na pausa) */
+    long long trabalho_desde_ns;    /* Modo pool: inicio do trecho em curso (0 = parado) */
+    long long livre_desde_ns;       /* Fim da ultima tarefa (0 = nenhuma ainda) */
+    long long ocioso_ns;            /* Soma das esperas entre uma tarefa e a seguinte */
+    long trocas;                    /* Tarefas assumidas depois de outra */
+    long modulos_puxados;           /* Modulos retirados da fila global */
+    long modulos_roubados;          /* Modulos roubados de outros tedax */
+    HistogramaLatencia latencia_fila; /* Espera entre entrar na fila e comecar */
+
+    /* Contadores da partida: so o dono escreve (atomicos relaxados), quem
+     * precisa do total soma todos os tedax (jogo_somar_contadores) */
+    alignas(TAMANHO_LINHA_CACHE) _Atomic int modulos_desarmados; /* Contador de sucessos */
+    _Atomic int modulos_falhados;   /* Contador de falhas */
+
+    /* Retrato para a tela, publicado pelo dono (tedax_publicar) */
+    alignas(TAMANHO_LINHA_CACHE) Seqlock seq_retrato;
+    _Atomic uint64_t retrato[PALAVRAS_RETRATO(RetratoTedax)];
 } Tedax;
 
+/**
+ * @struct SlotFilaMPMC
+ * @brief Slot da fila lock-free (sequencia indica livre/publicado)
+ */
+typedef struct {
+    atomic_size_t sequencia;        /* Posicao esperada pelo proximo acesso */
+    ModuloHandle modulo;            /* Modulo armazenado */
+} SlotFilaMPMC;
+
+/**
+ * @struct FilaMPMC
+ * @brief Fila circular limitada lock-free (multiplos produtores/consumidores)
+ *
+ * Os indices de escrita e leitura ficam em linhas de cache distintas
+ * para que produtores e consumidores nao disputem a mesma linha.
+ */
+typedef struct {
+    SlotFilaMPMC* slots;            /* Vetor de slots (potencia de 2) */
+    size_t mascara;                 /* capacidade - 1 */
+    char pad0[TAMANHO_LINHA_CACHE];
+    atomic_size_t pos_escrita;      /* Proxima posicao a ser reservada por produtores */
+    char pad1[TAMANHO_LINHA_CACHE - sizeof(atomic_size_t)];
+    atomic_size_t pos_leitura;      /* Proxima posicao a ser reservada por consumidores */
+    char pad2[TAMANHO_LINHA_CACHE - sizeof(atomic_size_t)];
+} FilaMPMC;
+
+/**
+ * @struct GeradorAleatorio
+ * @brief Estado de um gerador xoshiro256** (um por thread)
+ */
+typedef struct {
+    uint64_t s[4];
+} GeradorAleatorio;
+
+/* Fluxos independentes derivados da mesma semente */
+#define FLUXO_MURAL 1               /* Thread do mural de modulos */
+#define FLUXO_CHEGADAS 2            /* Instantes de chegada do mural */
+
+/**
+ * @struct RegistroTrace
+ * @brief Uma chegada lida do arquivo de trace
+ */
+typedef struct {
+    double instante;                /* Segundos desde o inicio da partida */
+    int tipo;                       /* TipoModulo */
+    int parametro;                  /* Parametro do modulo (0 = sortear) */
+} RegistroTrace;
+
+/**
+ * @struct GeradorChegadas
+ * @brief Estado do modelo de chegada da partida (usado so pelo mural)
+ */
+typedef struct {
+    ModeloChegada modelo;
+    GeradorAleatorio gerador;       /* Fluxo FLUXO_CHEGADAS */
+    double taxa;                    /* Modulos/min (Poisson e calmaria) */
+    double taxa_rajada;             /* Modulos/min durante a rajada */
+    double duracao_rajada;          /* Duracao media da rajada (s) */
+    double duracao_calmaria;        /* Duracao media da calmaria (s) */
+    bool em_rajada;                 /* Estado atual do processo on/off */
+    double resta_estado;            /* Segundos ate a proxima troca de estado */
+    bool iniciado;                  /* Modelo uniforme: primeira chegada ja saiu */
+    RegistroTrace* trace;           /* Registros do trace */
+    int tam_trace;
+    int pos_trace;                  /* Proximo registro */
+    double instante_anterior;       /* Instante do ultimo registro entregue */
+} GeradorChegadas;
+
+/* Marcadores do indice por ID da fila de modulos */
+#define INDICE_VAZIO (-1)
+#define INDICE_LAPIDE (-2)          /* Entrada removida; a sondagem continua */
+
+/**
+ * @struct NoFila
+ * @brief No da fila de modulos, ligado em duas listas intrusivas
+ */
+typedef struct {
+    ModuloHandle modulo;            /* Modulo armazenado */
+    TipoModulo tipo;                /* Copia do tipo (evita consultar o pool) */
+    int id;                         /* Copia do ID (chave do indice por ID) */
+    int ant, prox;                  /* Lista global em ordem de chegada (-1 = fim) */
+    int ant_tipo, prox_tipo;        /* Lista do mesmo TipoModulo (-1 = fim) */
+    time_t prazo;                   /* Prazo do modulo (modo EDF) */
+    unsigned long ordem;            /* Ordem de chegada (desempate no modo EDF) */
+    int pos_heap;                   /* Posicao no heap do tipo (modo EDF) */
+} NoFila;
+
 /**
  * @struct FilaModulos
- * @brief Fila de modulos pendentes (circular)
+ * @brief Fila de modulos pendentes
+ *
+ * Produtores publicam na fila lock-free 'entrada' sem tomar o mutex.
+ * Consumidores seguram o mutex e transferem a entrada para os nos, que
+ * ficam ligados em ordem de chegada (para exibicao) e em uma lista FIFO
+ * por tipo, de modo que o modulo mais antigo de um tipo sai em O(1)
+ * sem mover os demais.
+ *
+ * A capacidade vem de ConfigJogo. Os nos sao alocados em potencia de 2;
+ * em modo crescente comecam pequenos e dobram ate o limite. Se a
+ * entrada lotar, o produtor insere direto nos nos sob o mutex.
+ *
+ * No modo EDF cada tipo tem tambem um heap binario de nos ordenado pelo
+ * prazo, e a escolha por tipo (ou geral) sai do topo dos heaps.
+ *
+ * Um indice ID -> no (enderecamento aberto, sondagem linear) faz a
+ * remocao por ID em O(1). Remocoes deixam lapides no indice, que e
+ * reconstruido quando elas passam de um quarto da tabela.
  */
 typedef struct {
-    Modulo modulos[MAX_MODULOS_PENDENTES];
-    int inicio;                     /* Indice do primeiro elemento */
-    int fim;                        /* Indice apos o ultimo elemento */
-    int quantidade;                 /* Quantidade atual de modulos */
-    pthread_mutex_t mutex;          /* Mutex para acesso a fila */
-    pthread_cond_t cond_nao_vazia;  /* Condicao para fila nao vazia */
-    pthread_cond_t cond_nao_cheia;  /* Condicao para fila nao cheia */
+    FilaMPMC entrada;               /* Modulos recem-publicados */
+    SlotFilaMPMC* slots_entrada;    /* Slots da entrada (potencia de 2) */
+    NoFila* nos;                    /* Nos alocados */
+    int capacidade_nos;             /* Nos alocados (potencia de 2) */
+    int limite;                     /* Maximo de modulos pendentes */
+    bool crescente;                 /* Se os nos podem crescer sob demanda */
+    PoliticaFila politica;          /* FIFO ou EDF */
+    int* heap[MODULO_TOTAL];        /* Heaps de nos por tipo (modo EDF) */
+    int tam_heap[MODULO_TOTAL];     /* Nos em cada heap */
+    unsigned long proxima_ordem;    /* Contador de chegada */
+    int* indice_id;                 /* ID -> no (INDICE_VAZIO / INDICE_LAPIDE) */
+    int mascara_indice;             /* Tamanho do indice - 1 (2x os nos) */
+    int lapides;                    /* Lapides no indice */
+    int livre;                      /* Primeiro no livre (encadeado por 'prox') */
+    int primeiro, ultimo;           /* Extremos da lista global */
+    int primeiro_tipo[MODULO_TOTAL];/* Mais antigo de cada tipo */
+    int ultimo_tipo[MODULO_TOTAL];  /* Mais recente de cada tipo */
+    int consolidados;               /* Modulos ja transferidos para os nos */
+    atomic_int quantidade;          /* Total de modulos (entrada + consolidados) */
+    pthread_mutex_t mutex;          /* Serializa os consumidores */
+    pthread_cond_t cond_nao_vazia;  /* Condicao para fila nao vazia (CLOCK_MONOTONIC) */
+    pthread_cond_t cond_nao_cheia;  /* Condicao para fila nao cheia (CLOCK_MONOTONIC) */
+    atomic_int aguardando_item;     /* Threads em fila_modulos_aguardar_item */
+    unsigned despertares;           /* Incrementado por fila_modulos_despertar */
 } FilaModulos;
 
 /**
@@ -127,27 +620,175 @@ typedef struct {
  * @brief Configuracoes da partida
  */
 typedef struct {
-    int num_tedax;                  /* Numero de tedax (1-3) */
-    int num_bancadas;               /* Numero de bancadas (1-5) */
+    int num_tedax;                  /* Numero de tedax (1-MAX_TEDAX; o menu limita a MAX_TEDAX_MENU) */
+    int num_bancadas;               /* Numero de bancadas (1-MAX_BANCADAS; o menu limita a MAX_BANCADAS_MENU) */
     int tempo_partida;              /* Tempo total da partida em segundos */
     int dificuldade;                /* Nivel de dificuldade (1-3) */
     int modulos_para_vencer;        /* Quantidade de modulos para vencer */
     bool modo_infinito;             /* Modo sem limite de modulos */
+    int capacidade_fila;            /* Modulos pendentes que causam derrota */
+    bool fila_crescente;            /* Aloca a fila sob demanda ate a capacidade */
+    PoliticaFila politica_fila;     /* Ordem de escolha dos pendentes */
+    uint64_t semente;               /* Semente da geracao (0 = relogio) */
+    ModeloChegada modelo_chegada;   /* Como os modulos chegam */
+    double taxa_chegada;            /* Modulos/min (Poisson; calmaria nas rajadas) */
+    double taxa_rajada;             /* Modulos/min durante as rajadas */
+    double duracao_rajada;          /* Duracao media de uma rajada (s) */
+    double duracao_calmaria;        /* Duracao media de uma calmaria (s) */
+    char arquivo_trace[MAX_CAMINHO];/* Arquivo do modelo trace */
+    bool tedax_autonomos;           /* Tedax puxam modulos sem o coordenador */
+    bool tedax_em_pool;             /* Tedax como tarefas em um pool de threads */
+    int trabalhadores_pool;         /* Threads do pool (0 = nproc) */
+    PoliticaPiloto piloto;          /* Piloto automatico no lugar do jogador */
+    uint64_t afinidade[PAPEL_TOTAL];/* CPUs permitidas por papel (bit i = CPU i; 0 = sem fixar) */
 } ConfigJogo;
 
 /**
  * @struct Estatisticas
  * @brief Estatisticas da partida atual
+ *
+ * Na partida real os contadores nao ficam aqui: cada thread conta no seu
+ * slot e jogo_somar_contadores preenche gerados, desarmados, falhados e
+ * despertares_mural com a soma. Pendentes sai de jogo_modulos_pendentes.
  */
 typedef struct {
     int modulos_gerados;            /* Total de modulos gerados */
     int modulos_desarmados;         /* Total de modulos desarmados */
     int modulos_falhados;           /* Total de falhas */
-    int modulos_pendentes;          /* Modulos na fila */
+    int modulos_pendentes;          /* Modulos na fila (so na simulacao) */
     time_t inicio_partida;          /* Quando a partida iniciou */
     int tempo_restante;             /* Tempo restante em segundos */
+    long despertares_mural;         /* Vezes que a thread do mural acordou */
 } Estatisticas;
 
+/**
+ * @struct RetratoStatus
+ * @brief O que a tela mostra do estado da partida (jogo_publicar_status)
+ */
+typedef struct {
+    EstadoJogo estado;
+    Estatisticas stats;
+    char motivo[128];
+} RetratoStatus;
+
+/**
+ * @struct EstatisticasTela
+ * @brief Custo das leituras da tela em cada quadro (display_estatisticas)
+ */
+typedef struct {
+    long quadros;                   /* Quadros desenhados durante a partida */
+    long releituras;                /* Retratos copiados de novo por publicacao no meio */
+    long long leitura_ns;           /* Soma do tempo lendo estado compartilhado */
+    long long leitura_max_ns;       /* Pior quadro */
+} EstatisticasTela;
+
+/* Eventos da simulacao; no mesmo instante sao tratados nesta ordem */
+typedef enum {
+    EVENTO_CHEGADA = 0,             /* Proxima chegada do mural */
+    EVENTO_VAGA_EXPIRADA,           /* Fim de um trecho da espera do mural por vaga na fila cheia */
+    EVENTO_PILOTO,                  /* Rodada do piloto automatico */
+    EVENTO_FIM_TRABALHO,            /* Tedax termina o tempo de resolucao */
+    EVENTO_SONDAGEM,                /* Tedax na fila revisita as outras bancadas */
+    EVENTO_SEGUNDO                  /* Tique do timer (verifica o fim) */
+} TipoEventoSimulacao;
+
+/* Uma chegada, uma vaga, um tique, uma rodada do piloto e ate duas pendencias por tedax */
+#define CAPACIDADE_EVENTOS_SIMULACAO(num_tedax) (4 * (num_tedax) + 4)
+
+/**
+ * @struct EventoSimulacao
+ * @brief Evento no heap de tempo virtual da simulacao
+ */
+typedef struct {
+    long long instante;             /* Tempo virtual (ns desde o inicio da partida) */
+    TipoEventoSimulacao tipo;
+    int tedax;                      /* Tedax do evento (ou -1) */
+    int versao;                     /* Sondagem: descartada se o tedax mudou de estado */
+    long seq;                       /* Desempate final: ordem de agendamento */
+} EventoSimulacao;
+
+/**
+ * @struct PendenteSimulado
+ * @brief Modulo na fila da simulacao
+ */
+typedef struct {
+    Modulo modulo;
+    long long prazo;                /* Chave EDF em segundos virtuais (como modulo_prazo) */
+} PendenteSimulado;
+
+/**
+ * @struct TedaxSimulado
+ * @brief Tedax autonomo ou comandado pelo piloto na simulacao
+ */
+typedef struct {
+    Estado estado;                  /* Livre, aguardando bancada ou ocupado */
+    Modulo modulo;                  /* Modulo assumido */
+    bool designado;                 /* Ha uma designacao do piloto na caixa */
+    Modulo proximo;                 /* Modulo designado */
+    int bancada_proxima;            /* Bancada designada */
+    int bancada;                    /* Bancada ocupada (-1 se nenhuma) */
+    int bancada_espera;             /* Bancada em cuja fila esta (-1 se nenhuma) */
+    int prox_espera;                /* Proximo na fila da bancada (-1 se ultimo) */
+    int versao;                     /* Invalida sondagens agendadas antes */
+    int desarmados;
+} TedaxSimulado;
+
+/**
+ * @struct BancadaSimulada
+ * @brief Bancada na simulacao: dono e fila FIFO com entrega direta
+ */
+typedef struct {
+    int dono;                       /* Tedax na bancada (-1 se livre) */
+    int fila_inicio, fila_fim;      /* Tedax esperando, encadeados por prox_espera (-1 = vazia) */
+    int esperando;
+} BancadaSimulada;
+
+/**
+ * @struct ResultadoSimulacao
+ * @brief Desfecho de uma partida simulada (ver simulacao.h)
+ */
+typedef struct {
+    uint64_t semente;               /* Semente usada */
+    EstadoJogo estado_final;        /* JOGO_VITORIA ou JOGO_DERROTA */
+    char motivo[128];               /* Mesmo texto de jogo_verificar_fim */
+    int segundos;                   /* Segundos jogados ate o fim */
+    Estatisticas stats;             /* Contadores no tique que decidiu a partida */
+    long eventos;                   /* Eventos processados */
+} ResultadoSimulacao;
+
+/**
+ * @struct Simulacao
+ * @brief Estado de uma partida em tempo virtual
+ */
+typedef struct {
+    ConfigJogo config;
+    GeradorChegadas chegadas;       /* Mesmo modelo e fluxo do mural */
+    GeradorAleatorio gerador;       /* Fluxo FLUXO_MURAL */
+    EventoSimulacao* eventos;       /* Heap por (instante, tipo, seq) */
+    int num_eventos;
+    int capacidade_eventos;
+    long seq;
+    PendenteSimulado* pendentes;    /* Em ordem de chegada */
+    int qtd_pendentes;
+    int capacidade_pendentes;
+    RascunhoPiloto rascunho;        /* Rodadas do piloto */
+    TedaxSimulado* tedax;           /* config.num_tedax */
+    BancadaSimulada* bancadas;      /* config.num_bancadas */
+    Estatisticas stats;
+    EstadoJogo estado;
+    long long agora;                /* Instante virtual do evento atual */
+    bool ha_chegada;                /* Modelo ainda tem chegadas (o trace acaba) */
+    long long proxima_chegada;      /* Prazo absoluto da proxima chegada (como o mural) */
+    int tipo_proxima, parametro_proxima;
+    int proximo_id;
+    bool esperando_vaga;            /* Mural segurando um modulo com a fila cheia */
+    int id_espera, tipo_espera, parametro_espera;
+    int versao_vaga;                /* Invalida expiracoes de esperas ja resolvidas */
+    int segundos;
+    char motivo[128];
+    long processados;
+} Simulacao;
+
 /**
  * @struct EstadoJogoCompleto
  * @brief Estado completo do jogo (recurso compartilhado principal)
@@ -158,39 +799,54 @@ typedef struct {
 
     /* Estado atual */
     EstadoJogo estado;
-    Estatisticas stats;
+    Estatisticas stats;              /* Tempo e inicio; contadores em jogo_somar_contadores */
 
     /* Elementos do jogo */
-    Tedax tedax[MAX_TEDAX];
-    Bancada bancadas[MAX_BANCADAS];
+    Tedax* tedax;                    /* Alinhados, ao menos config.num_tedax (jogo_dimensionar) */
+    Bancada* bancadas;               /* Alinhadas, ao menos config.num_bancadas */
+    int capacidade_tedax;            /* Elementos alocados em cada vetor */
+    int capacidade_bancadas;
+    MapaBancadas mapa_bancadas;      /* Bancadas livres, sem travar cada uma */
     FilaModulos fila_modulos;
+    GeradorChegadas chegadas;        /* Modelo de chegada da partida */
+    Executor executor;               /* Pool dos tedax (config.tedax_em_pool) */
 
     /* Controle de sincronizacao */
     pthread_mutex_t mutex_estado;    /* Mutex principal para estado do jogo */
     pthread_mutex_t mutex_display;   /* Mutex para atualizacao de tela */
     pthread_cond_t cond_fim_jogo;    /* Condicao para fim do jogo */
+    pthread_cond_t cond_estado;      /* Sinaliza qualquer mudanca de 'estado' (CLOCK_MONOTONIC) */
 
     /* Threads principais */
     pthread_t thread_mural;          /* Thread geradora de modulos */
     pthread_t thread_display;        /* Thread de exibicao */
-    pthread_t thread_coordenador;    /* Thread de input */
+    pthread_t thread_coordenador;    /* Piloto automatico (--piloto) */
     pthread_t thread_timer;          /* Thread do temporizador */
 
     /* Controle de execucao */
     bool executando;                 /* Flag de execucao */
     int proximo_id_modulo;           /* Contador de IDs de modulos */
+    uint64_t semente;                /* Semente usada na partida atual */
+    long long inicio_ns;             /* Inicio da partida (relogio_ns): base do mural e do timer */
 
     /* Buffer de comando do jogador */
     char buffer_comando[16];
     int pos_buffer;
     pthread_mutex_t mutex_comando;
 
-    /* Mensagens de feedback */
-    char mensagem_feedback[128];
-    time_t tempo_mensagem;
+    /* Mensagens de feedback, as mais recentes no painel de mensagens */
+    Diario diario;
 
     /* Motivo do fim da partida (vitoria/derrota) */
     char motivo_final[128];
+
+    /* Contadores da thread do mural (so ela escreve, atomicos relaxados) */
+    alignas(TAMANHO_LINHA_CACHE) _Atomic int gerados_mural;
+    _Atomic long despertares_mural;
+
+    /* Estado, stats e motivo para a tela, publicados sob mutex_estado */
+    alignas(TAMANHO_LINHA_CACHE) Seqlock seq_status;
+    _Atomic uint64_t status_publicado[PALAVRAS_RETRATO(RetratoStatus)];
 } EstadoJogoCompleto;
 
 /* ==================== VARIAVEIS GLOBAIS ==================== */
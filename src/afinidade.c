@@ -0,0 +1,204 @@
+/*
+ * afinidade.c - Afinidade de CPU e nomes das threads do motor
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#define _GNU_SOURCE
+#include "../include/afinidade.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_CPUS_MASCARA 64
+
+static const char* nomes_papeis[PAPEL_TOTAL] = { "interface", "mural", "timer", "tedax", "coordenador" };
+
+int afinidade_papel_por_nome(const char* nome) {
+    if (!nome) return -1;
+    for (int i = 0; i < PAPEL_TOTAL; i++) {
+        if (strcmp(nome, nomes_papeis[i]) == 0) return i;
+    }
+    return -1;
+}
+
+const char* afinidade_nome_papel(PapelThread papel) {
+    if (papel < 0 || papel >= PAPEL_TOTAL) return "?";
+    return nomes_papeis[papel];
+}
+
+/* Lista "0,2-3" -> mascara; -1 se malformada ou fora de 0..63 */
+static int ler_lista(const char* lista, uint64_t* mascara) {
+    uint64_t resultado = 0;
+    const char* p = lista;
+    while (*p) {
+        char* fim;
+        long inicio = strtol(p, &fim, 10);
+        if (fim == p) return -1;
+        long ultimo = inicio;
+        p = fim;
+        if (*p == '-') {
+            ultimo = strtol(p + 1, &fim, 10);
+            if (fim == p + 1) return -1;
+            p = fim;
+        }
+        if (inicio < 0 || ultimo < inicio || ultimo >= MAX_CPUS_MASCARA) return -1;
+        for (long cpu = inicio; cpu <= ultimo; cpu++) resultado |= 1ULL << cpu;
+        if (*p == ',') p++;
+        else if (*p != '\0') return -1;
+    }
+    if (resultado == 0) return -1;
+    *mascara = resultado;
+    return 0;
+}
+
+int afinidade_ler(const char* texto, ConfigJogo* config) {
+    if (!texto || !config) return -1;
+    const char* igual = strchr(texto, '=');
+    if (!igual || igual == texto) return -1;
+
+    char nome[16];
+    size_t tam = (size_t)(igual - texto);
+    if (tam >= sizeof(nome)) return -1;
+    memcpy(nome, texto, tam);
+    nome[tam] = '\0';
+
+    int papel = afinidade_papel_por_nome(nome);
+    if (papel < 0) return -1;
+    return ler_lista(igual + 1, &config->afinidade[papel]);
+}
+
+static pthread_once_t processo_lido = PTHREAD_ONCE_INIT;
+static uint64_t mascara_processo;
+
+static void ler_cpus_do_processo(void) {
+    cpu_set_t conjunto;
+    mascara_processo = ~0ULL;
+    if (sched_getaffinity(0, sizeof(conjunto), &conjunto) != 0) return;
+    mascara_processo = 0;
+    for (int cpu = 0; cpu < MAX_CPUS_MASCARA; cpu++) {
+        if (CPU_ISSET(cpu, &conjunto)) mascara_processo |= 1ULL << cpu;
+    }
+}
+
+/*
+ * CPUs que o processo pode usar, lidas uma vez: depois que a thread
+ * principal for fixada, sched_getaffinity(0) so veria a mascara dela
+ */
+static uint64_t cpus_do_processo(void) {
+    pthread_once(&processo_lido, ler_cpus_do_processo);
+    return mascara_processo;
+}
+
+static bool algum_papel_fixado(const ConfigJogo* config) {
+    if (!config) return false;
+    for (int papel = 0; papel < PAPEL_TOTAL; papel++) {
+        if (config->afinidade[papel]) return true;
+    }
+    return false;
+}
+
+/*
+ * Mascara a aplicar: a do papel ou, se ele nao for fixado mas outro for,
+ * todas as CPUs do processo (uma thread nova herdaria a mascara de quem a
+ * criou, por exemplo a da interface)
+ */
+static uint64_t mascara_da_thread(const ConfigJogo* config, PapelThread papel) {
+    uint64_t mascara = afinidade_efetiva(config, papel);
+    if (!mascara && algum_papel_fixado(config)) mascara = cpus_do_processo();
+    return mascara;
+}
+
+uint64_t afinidade_efetiva(const ConfigJogo* config, PapelThread papel) {
+    if (!config || papel < 0 || papel >= PAPEL_TOTAL || config->afinidade[papel] == 0) return 0;
+    return config->afinidade[papel] & cpus_do_processo();
+}
+
+static void preencher_conjunto(uint64_t mascara, cpu_set_t* conjunto) {
+    CPU_ZERO(conjunto);
+    for (int cpu = 0; cpu < MAX_CPUS_MASCARA; cpu++) {
+        if (mascara & (1ULL << cpu)) CPU_SET(cpu, conjunto);
+    }
+}
+
+int afinidade_criar_thread(pthread_t* thread, const ConfigJogo* config, PapelThread papel, int indice,
+                           void* (*funcao)(void*), void* arg) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    uint64_t mascara = mascara_da_thread(config, papel);
+    if (mascara) {
+        cpu_set_t conjunto;
+        preencher_conjunto(mascara, &conjunto);
+        pthread_attr_setaffinity_np(&attr, sizeof(conjunto), &conjunto);
+    }
+
+    int erro = pthread_create(thread, &attr, funcao, arg);
+    pthread_attr_destroy(&attr);
+    if (erro != 0) return erro;
+
+    char nome[16];
+    if (indice >= 0) snprintf(nome, sizeof(nome), "%s-%d", afinidade_nome_papel(papel), indice);
+    else snprintf(nome, sizeof(nome), "%s", afinidade_nome_papel(papel));
+    pthread_setname_np(*thread, nome);
+    return 0;
+}
+
+void afinidade_aplicar(pthread_t thread, const ConfigJogo* config, PapelThread papel, const char* nome) {
+    uint64_t mascara = mascara_da_thread(config, papel);
+    if (mascara) {
+        cpu_set_t conjunto;
+        preencher_conjunto(mascara, &conjunto);
+        pthread_setaffinity_np(thread, sizeof(conjunto), &conjunto);
+    }
+    if (nome) {
+        char curto[16]; /* Limite do kernel, com o terminador */
+        snprintf(curto, sizeof(curto), "%s", nome);
+        pthread_setname_np(thread, curto);
+    }
+}
+
+/* Mascara -> "0,2-3" */
+static void formatar_lista(uint64_t mascara, char* texto, size_t tam) {
+    size_t pos = 0;
+    texto[0] = '\0';
+    for (int cpu = 0; cpu < MAX_CPUS_MASCARA && pos < tam; cpu++) {
+        if (!(mascara & (1ULL << cpu))) continue;
+        int ultimo = cpu;
+        while (ultimo + 1 < MAX_CPUS_MASCARA && (mascara & (1ULL << (ultimo + 1)))) ultimo++;
+        int n = ultimo > cpu ? snprintf(texto + pos, tam - pos, "%s%d-%d", pos ? "," : "", cpu, ultimo)
+                             : snprintf(texto + pos, tam - pos, "%s%d", pos ? "," : "", cpu);
+        if (n < 0) break;
+        pos += (size_t)n;
+        cpu = ultimo;
+    }
+}
+
+void afinidade_relatorio(FILE* saida, const ConfigJogo* config) {
+    if (!saida || !config) return;
+
+    char lista[256];
+    uint64_t processo = cpus_do_processo();
+    formatar_lista(processo, lista, sizeof(lista));
+    fprintf(saida, "Afinidade: %ld CPUs online, processo em %s\n", sysconf(_SC_NPROCESSORS_ONLN), lista);
+
+    for (int papel = 0; papel < PAPEL_TOTAL; papel++) {
+        const char* threads = papel == PAPEL_TEDAX ? (config->tedax_em_pool ? "executor-N" : "tedax-N")
+                                                   : afinidade_nome_papel(papel);
+        if (config->afinidade[papel] == 0) {
+            fprintf(saida, "  %-11s %-11s sem fixar\n", afinidade_nome_papel(papel), threads);
+            continue;
+        }
+        uint64_t efetiva = config->afinidade[papel] & processo;
+        if (efetiva == 0) {
+            formatar_lista(config->afinidade[papel], lista, sizeof(lista));
+            fprintf(saida, "  %-11s %-11s sem fixar (CPUs %s fora do processo)\n", afinidade_nome_papel(papel),
+                    threads, lista);
+            continue;
+        }
+        formatar_lista(efetiva, lista, sizeof(lista));
+        fprintf(saida, "  %-11s %-11s CPUs %s", afinidade_nome_papel(papel), threads, lista);
+        if (efetiva != config->afinidade[papel]) fprintf(saida, " (parte do pedido fora do processo)");
+        fprintf(saida, "\n");
+    }
+}
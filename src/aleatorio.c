@@ -0,0 +1,63 @@
+/*
+ * aleatorio.c - Gerador xoshiro256** por thread com sementes reproduziveis
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#include "../include/aleatorio.h"
+#include <time.h>
+
+/* splitmix64: espalha a semente pelos 256 bits de estado */
+static uint64_t splitmix64(uint64_t* x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+void aleatorio_semear(GeradorAleatorio* gerador, uint64_t semente, uint64_t fluxo) {
+    if (!gerador) return;
+
+    /* Cada fluxo parte de um ponto distinto da sequencia do splitmix64 */
+    uint64_t x = semente ^ (fluxo * 0xD1B54A32D192ED03ULL);
+    for (int i = 0; i < 4; i++) {
+        gerador->s[i] = splitmix64(&x);
+    }
+}
+
+uint64_t aleatorio_proximo(GeradorAleatorio* gerador) {
+    uint64_t* s = gerador->s;
+    uint64_t resultado = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return resultado;
+}
+
+int aleatorio_intervalo(GeradorAleatorio* gerador, int n) {
+    if (n <= 1) return 0;
+    /* Multiplicacao pelos 32 bits altos: sem divisao e com vies desprezivel */
+    uint64_t r = aleatorio_proximo(gerador) >> 32;
+    return (int)((r * (uint64_t)n) >> 32);
+}
+
+double aleatorio_unitario(GeradorAleatorio* gerador) {
+    return (aleatorio_proximo(gerador) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+uint64_t aleatorio_semente_relogio(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t x = ((uint64_t)ts.tv_sec << 32) ^ (uint64_t)ts.tv_nsec;
+    uint64_t semente = splitmix64(&x);
+    return semente ? semente : 1;
+}
@@ -4,7 +4,11 @@
  */
 
 #include "../include/bancada.h"
+#include "../include/executor.h"
+#include "../include/pool_modulos.h"
+#include "../include/retrato.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <sys/time.h>
@@ -14,11 +18,17 @@ void bancada_init(Bancada* bancada, int id) {
 
     bancada->id = id;
     bancada->estado = ESTADO_LIVRE;
-    bancada->modulo_atual = NULL;
+    bancada->modulo_atual = MODULO_HANDLE_NULO;
     bancada->tedax_id = -1;
+    bancada->fila_inicio = NULL;
+    bancada->fila_fim = NULL;
+    bancada->esperando = 0;
+    bancada->mapa = NULL;
 
     pthread_mutex_init(&bancada->mutex, NULL);
     pthread_cond_init(&bancada->cond_livre, NULL);
+    retrato_init(&bancada->seq_retrato, bancada->retrato, sizeof(RetratoBancada));
+    bancada_publicar(bancada);
 }
 
 void bancada_destroy(Bancada* bancada) {
@@ -38,12 +48,72 @@ bool bancada_livre(Bancada* bancada) {
     return livre;
 }
 
-bool bancada_ocupar(Bancada* bancada, int tedax_id, Modulo* modulo) {
+int bancada_carga(Bancada* bancada) {
+    if (!bancada) return 0;
+
+    pthread_mutex_lock(&bancada->mutex);
+    int carga = (bancada->estado != ESTADO_LIVRE) + bancada->esperando;
+    pthread_mutex_unlock(&bancada->mutex);
+
+    return carga;
+}
+
+/* Palavra do mapa com o bit da bancada */
+static _Atomic uint64_t* mapa_palavra(Bancada* bancada, uint64_t* bit) {
+    *bit = 1ULL << (bancada->id % BITS_PALAVRA_MAPA);
+    return &bancada->mapa->palavras[bancada->id / BITS_PALAVRA_MAPA];
+}
+
+/*
+ * Apaga o bit de livre (requer o mutex). Falso se alguem ja o apagou com
+ * mapa_bancadas_reservar e ainda vai marcar a bancada como ocupada.
+ */
+static bool mapa_tomar(Bancada* bancada) {
+    if (!bancada->mapa) return true;
+    uint64_t bit;
+    _Atomic uint64_t* palavra = mapa_palavra(bancada, &bit);
+    return (atomic_fetch_and_explicit(palavra, ~bit, memory_order_acq_rel) & bit) != 0;
+}
+
+/* Acende o bit de livre (requer o mutex) */
+static void mapa_devolver(Bancada* bancada) {
+    if (!bancada->mapa) return;
+    uint64_t bit;
+    _Atomic uint64_t* palavra = mapa_palavra(bancada, &bit);
+    atomic_fetch_or_explicit(palavra, bit, memory_order_release);
+}
+
+/* Retira 'espera' da fila (requer o mutex) */
+static void fila_retirar(Bancada* bancada, EsperaBancada* espera) {
+    EsperaBancada* ant = NULL;
+    for (EsperaBancada* e = bancada->fila_inicio; e; ant = e, e = e->prox) {
+        if (e != espera) continue;
+        if (ant) ant->prox = e->prox;
+        else bancada->fila_inicio = e->prox;
+        if (bancada->fila_fim == e) bancada->fila_fim = ant;
+        bancada->esperando--;
+        return;
+    }
+}
+
+/* Passa a bancada a 'espera' e acorda o dono (requer o mutex) */
+static void conceder(Bancada* bancada, EsperaBancada* espera) {
+    bancada->estado = ESTADO_OCUPADO;
+    bancada->tedax_id = espera->tedax_id;
+    bancada->modulo_atual = espera->modulo;
+    bancada_publicar(bancada);
+    espera->concedida = true;
+    espera->prox = NULL;
+    if (espera->executor) executor_acordar(espera->executor, espera->tarefa);
+    else pthread_cond_signal(&espera->cond);
+}
+
+bool bancada_ocupar(Bancada* bancada, int tedax_id, ModuloHandle modulo) {
     if (!bancada) return false;
 
     pthread_mutex_lock(&bancada->mutex);
 
-    if (bancada->estado != ESTADO_LIVRE) {
+    if (bancada->estado != ESTADO_LIVRE || !mapa_tomar(bancada)) {
         pthread_mutex_unlock(&bancada->mutex);
         return false;
     }
@@ -51,6 +121,7 @@ bool bancada_ocupar(Bancada* bancada, int tedax_id, Modulo* modulo) {
     bancada->estado = ESTADO_OCUPADO;
     bancada->tedax_id = tedax_id;
     bancada->modulo_atual = modulo;
+    bancada_publicar(bancada);
 
     pthread_mutex_unlock(&bancada->mutex);
     return true;
@@ -67,9 +138,20 @@ bool bancada_liberar(Bancada* bancada, int tedax_id) {
         return false;
     }
 
+    /* Entrega direta ao primeiro da fila: a bancada nao fica livre no meio */
+    EsperaBancada* proximo = bancada->fila_inicio;
+    if (proximo) {
+        fila_retirar(bancada, proximo);
+        conceder(bancada, proximo);
+        pthread_mutex_unlock(&bancada->mutex);
+        return true;
+    }
+
     bancada->estado = ESTADO_LIVRE;
     bancada->tedax_id = -1;
-    bancada->modulo_atual = NULL;
+    bancada->modulo_atual = MODULO_HANDLE_NULO;
+    bancada_publicar(bancada);
+    mapa_devolver(bancada);
 
     /* Sinaliza que a bancada esta livre */
     pthread_cond_broadcast(&bancada->cond_livre);
@@ -78,6 +160,67 @@ bool bancada_liberar(Bancada* bancada, int tedax_id) {
     return true;
 }
 
+void bancada_entrar_fila(Bancada* bancada, EsperaBancada* espera) {
+    if (!bancada || !espera) return;
+
+    pthread_mutex_lock(&bancada->mutex);
+    espera->concedida = false;
+    espera->prox = NULL;
+    if (bancada->estado == ESTADO_LIVRE && mapa_tomar(bancada)) {
+        conceder(bancada, espera);
+    } else {
+        if (bancada->fila_fim) bancada->fila_fim->prox = espera;
+        else bancada->fila_inicio = espera;
+        bancada->fila_fim = espera;
+        bancada->esperando++;
+    }
+    pthread_mutex_unlock(&bancada->mutex);
+}
+
+bool bancada_aguardar_vez(Bancada* bancada, EsperaBancada* espera, int timeout_ms) {
+    if (!bancada || !espera) return false;
+
+    pthread_mutex_lock(&bancada->mutex);
+    if (timeout_ms <= 0) {
+        while (!espera->concedida) pthread_cond_wait(&espera->cond, &bancada->mutex);
+    } else {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        ts.tv_sec += timeout_ms / 1000;
+        ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        int ret = 0;
+        while (!espera->concedida && ret != ETIMEDOUT) {
+            ret = pthread_cond_timedwait(&espera->cond, &bancada->mutex, &ts);
+        }
+    }
+    bool concedida = espera->concedida;
+    pthread_mutex_unlock(&bancada->mutex);
+    return concedida;
+}
+
+bool bancada_vez_concedida(Bancada* bancada, EsperaBancada* espera) {
+    if (!bancada || !espera) return false;
+
+    pthread_mutex_lock(&bancada->mutex);
+    bool concedida = espera->concedida;
+    pthread_mutex_unlock(&bancada->mutex);
+    return concedida;
+}
+
+bool bancada_sair_fila(Bancada* bancada, EsperaBancada* espera) {
+    if (!bancada || !espera) return false;
+
+    pthread_mutex_lock(&bancada->mutex);
+    bool concedida = espera->concedida;
+    if (!concedida) fila_retirar(bancada, espera);
+    pthread_mutex_unlock(&bancada->mutex);
+    return concedida;
+}
+
 bool bancada_aguardar_livre(Bancada* bancada, int timeout_ms) {
     if (!bancada) return false;
 
@@ -120,6 +263,17 @@ bool bancada_aguardar_livre(Bancada* bancada, int timeout_ms) {
     return livre;
 }
 
+void bancada_publicar(Bancada* bancada) {
+    RetratoBancada retrato = { .estado = bancada->estado, .tedax_id = bancada->tedax_id };
+    Modulo* modulo = pool_modulos_obter(bancada->modulo_atual);
+    if (modulo) snprintf(retrato.modulo, sizeof(retrato.modulo), "%s", modulo->nome);
+    retrato_publicar(&bancada->seq_retrato, bancada->retrato, &retrato, sizeof(RetratoBancada));
+}
+
+int bancada_ler_retrato(Bancada* bancada, RetratoBancada* retrato) {
+    return retrato_ler(&bancada->seq_retrato, bancada->retrato, retrato, sizeof(RetratoBancada));
+}
+
 const char* bancada_estado_str(Bancada* bancada) {
     if (!bancada) return "Invalida";
 
@@ -134,9 +288,127 @@ const char* bancada_estado_str(Bancada* bancada) {
     }
 }
 
+int mapa_bancadas_init(MapaBancadas* mapa, Bancada* bancadas, int num_bancadas) {
+    if (!mapa || !bancadas || num_bancadas <= 0) return -1;
+
+    int num_palavras = (num_bancadas + BITS_PALAVRA_MAPA - 1) / BITS_PALAVRA_MAPA;
+    mapa->palavras = calloc(num_palavras, sizeof(_Atomic uint64_t));
+    if (!mapa->palavras) return -1;
+    mapa->num_palavras = num_palavras;
+    mapa->num_bancadas = num_bancadas;
+    mapa->bancadas = bancadas;
+    for (int i = 0; i < num_bancadas; i++) bancadas[i].mapa = mapa;
+
+    mapa_bancadas_sincronizar(mapa);
+    return 0;
+}
+
+void mapa_bancadas_destroy(MapaBancadas* mapa) {
+    if (!mapa || !mapa->palavras) return;
+
+    for (int i = 0; i < mapa->num_bancadas; i++) mapa->bancadas[i].mapa = NULL;
+    free((void*)mapa->palavras);
+    mapa->palavras = NULL;
+    mapa->num_palavras = 0;
+    mapa->num_bancadas = 0;
+}
+
+void mapa_bancadas_sincronizar(MapaBancadas* mapa) {
+    if (!mapa || !mapa->palavras) return;
+
+    for (int w = 0; w < mapa->num_palavras; w++) atomic_store(&mapa->palavras[w], 0);
+    for (int i = 0; i < mapa->num_bancadas; i++) {
+        Bancada* b = &mapa->bancadas[i];
+        pthread_mutex_lock(&b->mutex);
+        if (b->estado == ESTADO_LIVRE) mapa_devolver(b);
+        pthread_mutex_unlock(&b->mutex);
+    }
+}
+
+/* Bits da palavra 'w' que cobrem as bancadas [0, limite), sem 'exceto' */
+static uint64_t mascara_palavra(int w, int limite, int exceto) {
+    int base = w * BITS_PALAVRA_MAPA;
+    if (limite <= base) return 0;
+    uint64_t mascara = limite - base >= BITS_PALAVRA_MAPA ? ~0ULL : (1ULL << (limite - base)) - 1;
+    if (exceto >= base && exceto < base + BITS_PALAVRA_MAPA) mascara &= ~(1ULL << (exceto - base));
+    return mascara;
+}
+
+int mapa_bancadas_reservar(MapaBancadas* mapa, int limite, int inicio, int exceto, int tedax_id,
+                           ModuloHandle modulo) {
+    if (!mapa || !mapa->palavras) return -1;
+    if (limite > mapa->num_bancadas) limite = mapa->num_bancadas;
+    if (limite <= 0) return -1;
+    if (inicio < 0 || inicio >= limite) inicio = 0;
+
+    /*
+     * Uma volta a partir de 'inicio': na palavra dele primeiro os bits de
+     * 'inicio' para cima e, depois das outras palavras, os de baixo.
+     */
+    int num_palavras = (limite + BITS_PALAVRA_MAPA - 1) / BITS_PALAVRA_MAPA;
+    int w0 = inicio / BITS_PALAVRA_MAPA;
+    uint64_t a_partir = ~0ULL << (inicio % BITS_PALAVRA_MAPA);
+    for (int k = 0; k <= num_palavras; k++) {
+        int w = (w0 + k) % num_palavras;
+        uint64_t mascara = mascara_palavra(w, limite, exceto);
+        if (k == 0) mascara &= a_partir;
+        else if (k == num_palavras) mascara &= ~a_partir;
+
+        _Atomic uint64_t* palavra = &mapa->palavras[w];
+        uint64_t atual = atomic_load_explicit(palavra, memory_order_acquire);
+        while (atual & mascara) {
+            int bit = __builtin_ctzll(atual & mascara);
+            if (!atomic_compare_exchange_weak_explicit(palavra, &atual, atual & ~(1ULL << bit),
+                                                       memory_order_acq_rel, memory_order_acquire)) {
+                continue;
+            }
+            /* O bit e a posse: ninguem mais ocupa a bancada ate ela ser liberada */
+            int id = w * BITS_PALAVRA_MAPA + bit;
+            Bancada* b = &mapa->bancadas[id];
+            pthread_mutex_lock(&b->mutex);
+            b->estado = ESTADO_OCUPADO;
+            b->tedax_id = tedax_id;
+            b->modulo_atual = modulo;
+            bancada_publicar(b);
+            pthread_mutex_unlock(&b->mutex);
+            return id;
+        }
+    }
+    return -1;
+}
+
+int mapa_bancadas_livres(MapaBancadas* mapa, int limite) {
+    if (!mapa || !mapa->palavras) return 0;
+    if (limite > mapa->num_bancadas) limite = mapa->num_bancadas;
+
+    int livres = 0;
+    for (int w = 0; w * BITS_PALAVRA_MAPA < limite; w++) {
+        uint64_t bits = atomic_load_explicit(&mapa->palavras[w], memory_order_relaxed);
+        livres += __builtin_popcountll(bits & mascara_palavra(w, limite, -1));
+    }
+    return livres;
+}
+
+/* Mapa que cobre exatamente este array de bancadas, ou NULL */
+static MapaBancadas* mapa_de(Bancada* bancadas, int num_bancadas) {
+    MapaBancadas* mapa = bancadas[0].mapa;
+    if (!mapa || mapa->bancadas != bancadas || mapa->num_bancadas < num_bancadas) return NULL;
+    return mapa;
+}
+
 int encontrar_bancada_livre(Bancada* bancadas, int num_bancadas) {
     if (!bancadas || num_bancadas <= 0) return -1;
 
+    MapaBancadas* mapa = mapa_de(bancadas, num_bancadas);
+    if (mapa) {
+        for (int w = 0; w * BITS_PALAVRA_MAPA < num_bancadas; w++) {
+            uint64_t bits = atomic_load_explicit(&mapa->palavras[w], memory_order_relaxed);
+            bits &= mascara_palavra(w, num_bancadas, -1);
+            if (bits) return w * BITS_PALAVRA_MAPA + __builtin_ctzll(bits);
+        }
+        return -1;
+    }
+
     for (int i = 0; i < num_bancadas; i++) {
         if (bancada_livre(&bancadas[i])) {
             return i;
@@ -149,6 +421,9 @@ int encontrar_bancada_livre(Bancada* bancadas, int num_bancadas) {
 int contar_bancadas_ocupadas(Bancada* bancadas, int num_bancadas) {
     if (!bancadas || num_bancadas <= 0) return 0;
 
+    MapaBancadas* mapa = mapa_de(bancadas, num_bancadas);
+    if (mapa) return num_bancadas - mapa_bancadas_livres(mapa, num_bancadas);
+
     int count = 0;
     for (int i = 0; i < num_bancadas; i++) {
         if (!bancada_livre(&bancadas[i])) {
@@ -0,0 +1,181 @@
+/*
+ * chegadas.c - Modelos de chegada de modulos (uniforme, Poisson, rajadas, trace)
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#include "../include/chegadas.h"
+#include "../include/aleatorio.h"
+#include "../include/modulos.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const char* nomes_modelos[] = {
+    "uniforme",
+    "poisson",
+    "rajadas",
+    "trace"
+};
+
+/* Intervalo exponencial com 'taxa' chegadas por minuto */
+static double exponencial(GeradorAleatorio* gerador, double taxa_por_min) {
+    if (taxa_por_min <= 0) return INFINITY;
+    return -log(1.0 - aleatorio_unitario(gerador)) * 60.0 / taxa_por_min;
+}
+
+/* Le "instante tipo parametro" por linha; '#' comenta e ',' separa */
+static int carregar_trace(GeradorChegadas* chegadas, const char* arquivo) {
+    FILE* f = fopen(arquivo, "r");
+    if (!f) return -1;
+
+    int capacidade = 64;
+    chegadas->trace = malloc(sizeof(RegistroTrace) * capacidade);
+    chegadas->tam_trace = 0;
+    if (!chegadas->trace) {
+        fclose(f);
+        return -1;
+    }
+
+    char linha[256];
+    while (fgets(linha, sizeof(linha), f)) {
+        for (char* c = linha; *c; c++) {
+            if (*c == ',') *c = ' ';
+            if (*c == '#') *c = '\0';
+            if (*c == '\0') break;
+        }
+
+        double instante;
+        char tipo[16];
+        int parametro = 0;
+        if (sscanf(linha, "%lf %15s %d", &instante, tipo, &parametro) < 2) continue;
+
+        /* Tipo pela letra do comando (f, b, s, i) ou pelo numero */
+        int t = -1;
+        if (tipo[1] == '\0') t = (int)tipo_modulo_por_char(tipo[0]);
+        if (t < 0 && tipo[0] >= '0' && tipo[0] <= '9') t = atoi(tipo);
+        if (t < 0 || t >= MODULO_TOTAL || instante < 0) continue;
+
+        if (chegadas->tam_trace == capacidade) {
+            capacidade *= 2;
+            RegistroTrace* maior = realloc(chegadas->trace, sizeof(RegistroTrace) * capacidade);
+            if (!maior) break;
+            chegadas->trace = maior;
+        }
+        RegistroTrace* r = &chegadas->trace[chegadas->tam_trace++];
+        r->instante = instante;
+        r->tipo = t;
+        r->parametro = parametro;
+    }
+
+    fclose(f);
+    return 0;
+}
+
+int chegadas_init(GeradorChegadas* chegadas, const ConfigJogo* config, uint64_t semente) {
+    if (!chegadas || !config) return -1;
+
+    memset(chegadas, 0, sizeof(GeradorChegadas));
+    chegadas->modelo = config->modelo_chegada;
+    chegadas->taxa = config->taxa_chegada;
+    chegadas->taxa_rajada = config->taxa_rajada;
+    chegadas->duracao_rajada = config->duracao_rajada;
+    chegadas->duracao_calmaria = config->duracao_calmaria;
+    aleatorio_semear(&chegadas->gerador, semente, FLUXO_CHEGADAS);
+
+    if (chegadas->modelo == CHEGADA_RAJADAS) {
+        /* Comeca em calmaria, com duracao ja sorteada */
+        chegadas->em_rajada = false;
+        chegadas->resta_estado = -log(1.0 - aleatorio_unitario(&chegadas->gerador)) *
+                                 chegadas->duracao_calmaria;
+    }
+
+    if (chegadas->modelo == CHEGADA_TRACE) {
+        return carregar_trace(chegadas, config->arquivo_trace);
+    }
+    return 0;
+}
+
+void chegadas_destroy(GeradorChegadas* chegadas) {
+    if (!chegadas) return;
+    free(chegadas->trace);
+    chegadas->trace = NULL;
+    chegadas->tam_trace = 0;
+}
+
+bool chegadas_proxima(GeradorChegadas* chegadas, int dificuldade, Chegada* chegada) {
+    if (!chegadas || !chegada) return false;
+
+    chegada->tipo = -1;
+    chegada->parametro = 0;
+    GeradorAleatorio* g = &chegadas->gerador;
+
+    switch (chegadas->modelo) {
+        case CHEGADA_POISSON:
+            chegada->intervalo = exponencial(g, chegadas->taxa);
+            return isfinite(chegada->intervalo);
+
+        case CHEGADA_RAJADAS: {
+            /*
+             * Sorteia a proxima chegada no estado atual; se ela cair depois
+             * do fim do estado, avanca ate a troca e sorteia de novo (as
+             * exponenciais nao tem memoria, entao isso e exato).
+             */
+            double decorrido = 0.0;
+            for (;;) {
+                double taxa = chegadas->em_rajada ? chegadas->taxa_rajada : chegadas->taxa;
+                double ate_chegada = exponencial(g, taxa);
+                if (ate_chegada < chegadas->resta_estado) {
+                    chegadas->resta_estado -= ate_chegada;
+                    chegada->intervalo = decorrido + ate_chegada;
+                    return true;
+                }
+                decorrido += chegadas->resta_estado;
+                chegadas->em_rajada = !chegadas->em_rajada;
+                double media = chegadas->em_rajada ? chegadas->duracao_rajada
+                                                   : chegadas->duracao_calmaria;
+                chegadas->resta_estado = -log(1.0 - aleatorio_unitario(g)) * media;
+            }
+        }
+
+        case CHEGADA_TRACE: {
+            if (chegadas->pos_trace >= chegadas->tam_trace) return false;
+            RegistroTrace* r = &chegadas->trace[chegadas->pos_trace++];
+            double intervalo = r->instante - chegadas->instante_anterior;
+            chegada->intervalo = intervalo > 0 ? intervalo : 0.0;
+            chegada->tipo = r->tipo;
+            chegada->parametro = r->parametro;
+            chegadas->instante_anterior = r->instante;
+            return true;
+        }
+
+        case CHEGADA_UNIFORME:
+        default: {
+            /* Primeiro modulo logo no inicio da partida, como antes */
+            if (!chegadas->iniciado) {
+                chegadas->iniciado = true;
+                chegada->intervalo = 0.0;
+                return true;
+            }
+            int intervalo = INTERVALO_GERACAO_MIN +
+                           aleatorio_intervalo(g, INTERVALO_GERACAO_MAX - INTERVALO_GERACAO_MIN + 1);
+            intervalo = intervalo - dificuldade + 1;
+            if (intervalo < 2) intervalo = 2;
+            chegada->intervalo = intervalo;
+            return true;
+        }
+    }
+}
+
+int chegadas_modelo_por_nome(const char* nome) {
+    if (!nome) return -1;
+    for (int i = 0; i < CHEGADA_TOTAL; i++) {
+        if (strcmp(nomes_modelos[i], nome) == 0) return i;
+    }
+    return -1;
+}
+
+const char* chegadas_nome_modelo(ModeloChegada modelo) {
+    if (modelo >= 0 && modelo < CHEGADA_TOTAL) return nomes_modelos[modelo];
+    return "desconhecido";
+}
@@ -0,0 +1,94 @@
+/*
+ * diario.c - Anel de mensagens: fetch_add no numero, slot escrito como retrato
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#include "../include/diario.h"
+#include "../include/retrato.h"
+#include <stdio.h>
+
+#define MASCARA_DIARIO (CAPACIDADE_DIARIO - 1)
+
+void diario_init(Diario* diario) {
+    if (!diario) return;
+    atomic_init(&diario->proximo, 1);
+    atomic_init(&diario->descartadas, 0);
+    atomic_init(&diario->visto_ate, 0);
+    atomic_init(&diario->sobrescritas, 0);
+    for (int i = 0; i < CAPACIDADE_DIARIO; i++) {
+        SlotDiario* slot = &diario->slots[i];
+        atomic_init(&slot->ocupado, false);
+        atomic_init(&slot->numero, 0);
+        retrato_init(&slot->seq, slot->entrada, sizeof(EntradaDiario));
+    }
+}
+
+bool diario_publicar(Diario* diario, long long instante_ns, const char* texto) {
+    if (!diario || !texto) return false;
+    uint64_t numero = atomic_fetch_add_explicit(&diario->proximo, 1, memory_order_relaxed);
+    SlotDiario* slot = &diario->slots[numero & MASCARA_DIARIO];
+
+    /* Outro escritor no slot (o anel deu a volta no meio da escrita): descarta em vez de esperar */
+    if (atomic_exchange_explicit(&slot->ocupado, true, memory_order_acquire)) {
+        atomic_fetch_add_explicit(&diario->descartadas, 1, memory_order_relaxed);
+        return false;
+    }
+
+    /* Um produtor da volta seguinte ja escreveu aqui: nao volta o slot para tras */
+    if (atomic_load_explicit(&slot->numero, memory_order_relaxed) > numero) {
+        atomic_store_explicit(&slot->ocupado, false, memory_order_release);
+        atomic_fetch_add_explicit(&diario->descartadas, 1, memory_order_relaxed);
+        return false;
+    }
+
+    EntradaDiario entrada = { .numero = numero, .instante_ns = instante_ns };
+    snprintf(entrada.texto, sizeof(entrada.texto), "%s", texto);
+    retrato_publicar(&slot->seq, slot->entrada, &entrada, sizeof(EntradaDiario));
+    atomic_store_explicit(&slot->numero, numero, memory_order_relaxed);
+    atomic_store_explicit(&slot->ocupado, false, memory_order_release);
+    return true;
+}
+
+/* Entre o ultimo alcance de um leitor e a entrada mais antiga ainda no anel, ninguem leu */
+static void contar_sobrescritas(Diario* diario, uint64_t ultimo) {
+    uint64_t visto = atomic_load_explicit(&diario->visto_ate, memory_order_relaxed);
+    while (visto < ultimo) {
+        if (atomic_compare_exchange_weak_explicit(&diario->visto_ate, &visto, ultimo, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            uint64_t mais_antiga = ultimo >= CAPACIDADE_DIARIO ? ultimo - CAPACIDADE_DIARIO + 1 : 1;
+            if (mais_antiga > visto + 1) {
+                atomic_fetch_add_explicit(&diario->sobrescritas, (long)(mais_antiga - visto - 1),
+                                          memory_order_relaxed);
+            }
+            return;
+        }
+    }
+}
+
+int diario_recentes(Diario* diario, EntradaDiario* destino, int max) {
+    if (!diario || !destino || max <= 0) return 0;
+    if (max > CAPACIDADE_DIARIO) max = CAPACIDADE_DIARIO;
+
+    /* Numeros abaixo de 'proximo' ja foram entregues (alguns ainda sendo escritos) */
+    uint64_t ultimo = atomic_load_explicit(&diario->proximo, memory_order_relaxed) - 1;
+    contar_sobrescritas(diario, ultimo);
+
+    uint64_t inicio = ultimo >= (uint64_t)max ? ultimo - max + 1 : 1;
+    int copiadas = 0;
+    for (uint64_t numero = inicio; numero <= ultimo; numero++) {
+        SlotDiario* slot = &diario->slots[numero & MASCARA_DIARIO];
+        retrato_ler(&slot->seq, slot->entrada, &destino[copiadas], sizeof(EntradaDiario));
+        /* Outro numero: a escrita ainda nao terminou ou a volta seguinte ja passou */
+        if (destino[copiadas].numero == numero) copiadas++;
+    }
+    return copiadas;
+}
+
+EstatisticasDiario diario_estatisticas(Diario* diario) {
+    EstatisticasDiario e = { 0 };
+    if (!diario) return e;
+    e.publicadas = (long)(atomic_load_explicit(&diario->proximo, memory_order_relaxed) - 1);
+    e.descartadas = atomic_load_explicit(&diario->descartadas, memory_order_relaxed);
+    e.sobrescritas = atomic_load_explicit(&diario->sobrescritas, memory_order_relaxed);
+    return e;
+}
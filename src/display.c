@@ -5,9 +5,13 @@
 
 #include "../include/display.h"
 #include "../include/modulos.h"
+#include "../include/pool_modulos.h"
 #include "../include/bancada.h"
 #include "../include/tedax.h"
 #include "../include/jogo.h"
+#include "../include/metricas.h"
+#include "../include/instrucao.h"
+#include "../include/diario.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,6 +20,31 @@
 
 extern EstadoJogoCompleto* jogo;
 
+/* Custo das leituras da partida atual (so a thread principal desenha) */
+static EstatisticasTela tela;
+static long long leitura_quadro_ns;
+
+static void registrar_leitura(long long inicio, int releituras) {
+    leitura_quadro_ns += relogio_ns() - inicio;
+    tela.releituras += releituras;
+}
+
+void display_zerar_estatisticas(void) {
+    memset(&tela, 0, sizeof(tela));
+    leitura_quadro_ns = 0;
+}
+
+void display_fechar_quadro(void) {
+    tela.quadros++;
+    tela.leitura_ns += leitura_quadro_ns;
+    if (leitura_quadro_ns > tela.leitura_max_ns) tela.leitura_max_ns = leitura_quadro_ns;
+    leitura_quadro_ns = 0;
+}
+
+EstatisticasTela display_estatisticas(void) {
+    return tela;
+}
+
 int display_init(void) {
     setlocale(LC_ALL, "");
     initscr();
@@ -103,9 +132,10 @@ void display_modulos_pendentes(EstadoJogoCompleto* estado, int linha) {
     int largura = COLS - 4;
     desenhar_caixa(linha, 2, ALTURA_MODULOS, largura, "MODULOS PENDENTES - Copie a INSTRUCAO para seu comando!");
 
-    if (pthread_mutex_trylock(&estado->fila_modulos.mutex) != 0) return;
+    Modulo visiveis[6];
+    int mostrados = fila_modulos_listar(&estado->fila_modulos, visiveis, 6);
+    int qtd = fila_modulos_quantidade(&estado->fila_modulos);
 
-    int qtd = estado->fila_modulos.quantidade;
     if (qtd == 0) {
         attron(COLOR_PAIR(COR_SUCESSO) | A_BOLD);
         mvprintw(linha + 2, 4, "Nenhum modulo pendente! Aguarde novos modulos...");
@@ -116,10 +146,8 @@ void display_modulos_pendentes(EstadoJogoCompleto* estado, int linha) {
         attroff(COLOR_PAIR(COR_INFO));
         int lin = linha + 2;
         int col = 4;
-        int mostrados = 0;
-        for (int i = 0; i < qtd && mostrados < 6; i++) {
-            int idx = (estado->fila_modulos.inicio + i) % MAX_MODULOS_PENDENTES;
-            Modulo* m = &estado->fila_modulos.modulos[idx];
+        for (int i = 0; i < mostrados; i++) {
+            Modulo* m = &visiveis[i];
             attron(COLOR_PAIR(COR_ALERTA) | A_BOLD);
             mvprintw(lin, col, "[%d]", m->id);
             attroff(COLOR_PAIR(COR_ALERTA) | A_BOLD);
@@ -127,11 +155,12 @@ void display_modulos_pendentes(EstadoJogoCompleto* estado, int linha) {
             mvprintw(lin, col + 5, "%c:", char_tipo_modulo(m->tipo));
             attroff(COLOR_PAIR(COR_SUCESSO));
             attron(COLOR_PAIR(COR_ERRO) | A_BOLD);
-            mvprintw(lin, col + 8, "%s", m->instrucao);
+            char instrucao[MAX_SIMBOLOS_INSTRUCAO + 1];
+            instrucao_decodificar(&m->instrucao, instrucao, sizeof(instrucao));
+            mvprintw(lin, col + 8, "%s", instrucao);
             attroff(COLOR_PAIR(COR_ERRO) | A_BOLD);
             col += 22;
-            mostrados++;
-            if (mostrados % 4 == 0) { col = 4; lin++; }
+            if ((i + 1) % 4 == 0) { col = 4; lin++; }
         }
         if (qtd > 6) {
             attron(COLOR_PAIR(COR_ALERTA));
@@ -139,41 +168,51 @@ void display_modulos_pendentes(EstadoJogoCompleto* estado, int linha) {
             attroff(COLOR_PAIR(COR_ALERTA));
         }
     }
-    pthread_mutex_unlock(&estado->fila_modulos.mutex);
-    attron(COLOR_PAIR(qtd >= MAX_MODULOS_PENDENTES - 2 ? COR_ERRO : COR_INFO) | A_BOLD);
-    mvprintw(linha, largura - 10, " [%d/%d] ", qtd, MAX_MODULOS_PENDENTES);
-    attroff(COLOR_PAIR(qtd >= MAX_MODULOS_PENDENTES - 2 ? COR_ERRO : COR_INFO) | A_BOLD);
+    int capacidade = fila_modulos_capacidade(&estado->fila_modulos);
+    attron(COLOR_PAIR(qtd >= capacidade - 2 ? COR_ERRO : COR_INFO) | A_BOLD);
+    mvprintw(linha, largura - 16, " [%d/%d] ", qtd, capacidade);
+    attroff(COLOR_PAIR(qtd >= capacidade - 2 ? COR_ERRO : COR_INFO) | A_BOLD);
+}
+
+/* Colunas que cabem na largura (as primeiras 'n' ou menos) */
+static int colunas_visiveis(int n, int largura) {
+    int cabem = (largura - 6) / LARGURA_MIN_COLUNA;
+    if (cabem < 1) cabem = 1;
+    return n < cabem ? n : cabem;
 }
 
 void display_bancadas(EstadoJogoCompleto* estado, int linha) {
     if (!estado) return;
     int largura = COLS - 4;
-    desenhar_caixa(linha, 2, ALTURA_BANCADAS, largura, "BANCADAS");
-    int num_bancadas = estado->config.num_bancadas;
+    int num_bancadas = colunas_visiveis(estado->config.num_bancadas, largura);
+    /* Ocupacao pelo popcount do mapa, sem travar as bancadas */
+    char titulo[64];
+    snprintf(titulo, sizeof(titulo), "BANCADAS (%d/%d ocupadas)",
+             contar_bancadas_ocupadas(estado->bancadas, estado->config.num_bancadas), estado->config.num_bancadas);
+    desenhar_caixa(linha, 2, ALTURA_BANCADAS, largura, titulo);
     int largura_bancada = (largura - 6) / num_bancadas;
 
     for (int i = 0; i < num_bancadas; i++) {
-        Bancada* b = &estado->bancadas[i];
+        RetratoBancada b;
+        long long inicio = relogio_ns();
+        registrar_leitura(inicio, bancada_ler_retrato(&estado->bancadas[i], &b));
         int x = 4 + i * largura_bancada;
-        
-        if (pthread_mutex_trylock(&b->mutex) == 0) {
-            attron(COLOR_PAIR(COR_BANCADA));
-            mvprintw(linha + 1, x, "Bancada %d", i + 1);
-            attroff(COLOR_PAIR(COR_BANCADA));
-            if (b->estado == ESTADO_LIVRE) {
-                attron(COLOR_PAIR(COR_SUCESSO));
-                mvprintw(linha + 2, x, "[LIVRE]");
-                attroff(COLOR_PAIR(COR_SUCESSO));
-            } else {
-                attron(COLOR_PAIR(COR_ERRO));
-                mvprintw(linha + 2, x, "[OCUPADA]");
-                attroff(COLOR_PAIR(COR_ERRO));
-                if (b->modulo_atual) {
-                    mvprintw(linha + 3, x, "Modulo: %s", b->modulo_atual->nome);
-                }
-                mvprintw(linha + 4, x, "Tedax: %d", b->tedax_id + 1);
+
+        attron(COLOR_PAIR(COR_BANCADA));
+        mvprintw(linha + 1, x, "Bancada %d", i + 1);
+        attroff(COLOR_PAIR(COR_BANCADA));
+        if (b.estado == ESTADO_LIVRE) {
+            attron(COLOR_PAIR(COR_SUCESSO));
+            mvprintw(linha + 2, x, "[LIVRE]");
+            attroff(COLOR_PAIR(COR_SUCESSO));
+        } else {
+            attron(COLOR_PAIR(COR_ERRO));
+            mvprintw(linha + 2, x, "[OCUPADA]");
+            attroff(COLOR_PAIR(COR_ERRO));
+            if (b.modulo[0]) {
+                mvprintw(linha + 3, x, "Modulo: %s", b.modulo);
             }
-            pthread_mutex_unlock(&b->mutex);
+            mvprintw(linha + 4, x, "Tedax: %d", b.tedax_id + 1);
         }
     }
 }
@@ -181,34 +220,40 @@ void display_bancadas(EstadoJogoCompleto* estado, int linha) {
 void display_tedax(EstadoJogoCompleto* estado, int linha) {
     if (!estado) return;
     int largura = COLS - 4;
-    desenhar_caixa(linha, 2, ALTURA_TEDAX, largura, "TEDAX");
-    int num_tedax = estado->config.num_tedax;
+    int num_tedax = colunas_visiveis(estado->config.num_tedax, largura);
+    char titulo[48];
+    if (num_tedax < estado->config.num_tedax) {
+        snprintf(titulo, sizeof(titulo), "TEDAX (%d primeiros de %d)", num_tedax, estado->config.num_tedax);
+    } else {
+        snprintf(titulo, sizeof(titulo), "TEDAX");
+    }
+    desenhar_caixa(linha, 2, ALTURA_TEDAX, largura, titulo);
     int largura_tedax = (largura - 6) / num_tedax;
 
     for (int i = 0; i < num_tedax; i++) {
-        Tedax* t = &estado->tedax[i];
+        RetratoTedax t;
+        long long inicio = relogio_ns();
+        registrar_leitura(inicio, tedax_ler_retrato(&estado->tedax[i], &t));
         int x = 4 + i * largura_tedax;
-        
-        if (pthread_mutex_trylock(&t->mutex) == 0) {
-            attron(COLOR_PAIR(COR_INFO) | A_BOLD);
-            mvprintw(linha + 1, x, "Tedax %d", i + 1);
-            attroff(COLOR_PAIR(COR_INFO) | A_BOLD);
-            if (t->estado == ESTADO_LIVRE) {
-                attron(COLOR_PAIR(COR_TEDAX_LIVRE));
-                mvprintw(linha + 2, x, "[DISPONIVEL]");
-                attroff(COLOR_PAIR(COR_TEDAX_LIVRE));
-            } else if (t->estado == ESTADO_AGUARDANDO_BANCADA) {
-                attron(COLOR_PAIR(COR_ALERTA));
-                mvprintw(linha + 2, x, "[AGUARDANDO]");
-                attroff(COLOR_PAIR(COR_ALERTA));
-            } else {
-                attron(COLOR_PAIR(COR_TEDAX_OCUP));
-                mvprintw(linha + 2, x, "[TRABALHANDO]");
-                attroff(COLOR_PAIR(COR_TEDAX_OCUP));
-            }
-            mvprintw(linha + 3, x, "OK: %d  Falha: %d", t->modulos_desarmados, t->modulos_falhados);
-            pthread_mutex_unlock(&t->mutex);
+
+        attron(COLOR_PAIR(COR_INFO) | A_BOLD);
+        mvprintw(linha + 1, x, "Tedax %d", i + 1);
+        attroff(COLOR_PAIR(COR_INFO) | A_BOLD);
+        if (t.estado == ESTADO_LIVRE) {
+            attron(COLOR_PAIR(COR_TEDAX_LIVRE));
+            mvprintw(linha + 2, x, "[DISPONIVEL]");
+            attroff(COLOR_PAIR(COR_TEDAX_LIVRE));
+        } else if (t.estado == ESTADO_AGUARDANDO_BANCADA) {
+            attron(COLOR_PAIR(COR_ALERTA));
+            mvprintw(linha + 2, x, "[AGUARDANDO]");
+            attroff(COLOR_PAIR(COR_ALERTA));
+        } else {
+            attron(COLOR_PAIR(COR_TEDAX_OCUP));
+            mvprintw(linha + 2, x, "[TRABALHANDO]");
+            attroff(COLOR_PAIR(COR_TEDAX_OCUP));
         }
+        mvprintw(linha + 3, x, "OK: %d  Falha: %d", t.desarmados, t.falhados);
+        mvprintw(linha + 4, x, "Caixa: %d/%d", tedax_quantidade_caixa(&estado->tedax[i]), CAPACIDADE_CAIXA_TEDAX);
     }
 }
 
@@ -217,32 +262,62 @@ void display_status(EstadoJogoCompleto* estado, int linha) {
     int largura = COLS - 4;
     desenhar_caixa(linha, 2, ALTURA_STATUS, largura, "STATUS");
 
-    if (pthread_mutex_trylock(&estado->mutex_estado) == 0) {
-        char tempo_str[16];
-        formatar_tempo(estado->stats.tempo_restante, tempo_str, sizeof(tempo_str));
-        int cor_tempo = COR_SUCESSO;
-        if (estado->stats.tempo_restante < 30) cor_tempo = COR_ALERTA;
-        if (estado->stats.tempo_restante < 10) cor_tempo = COR_ERRO;
-        attron(COLOR_PAIR(cor_tempo) | A_BOLD);
-        mvprintw(linha + 1, 4, "TEMPO: %s", tempo_str);
-        attroff(COLOR_PAIR(cor_tempo) | A_BOLD);
-        mvprintw(linha + 1, 30, "Gerados: %d", estado->stats.modulos_gerados);
-        mvprintw(linha + 1, 50, "Desarmados: %d", estado->stats.modulos_desarmados);
-        mvprintw(linha + 1, 75, "Falhas: %d", estado->stats.modulos_falhados);
-        if (!estado->config.modo_infinito) {
-            attron(COLOR_PAIR(COR_INFO));
-            mvprintw(linha + 2, 4, "Objetivo: Desarmar %d modulos", estado->config.modulos_para_vencer);
-            attroff(COLOR_PAIR(COR_INFO));
-        }
-        if (strlen(estado->mensagem_feedback) > 0) {
-            time_t agora = time(NULL);
-            if (agora - estado->tempo_mensagem < 5) {
-                attron(COLOR_PAIR(COR_ALERTA));
-                mvprintw(linha + 2, 35, ">> %s", estado->mensagem_feedback);
-                attroff(COLOR_PAIR(COR_ALERTA));
-            }
-        }
-        pthread_mutex_unlock(&estado->mutex_estado);
+    RetratoStatus status;
+    long long inicio = relogio_ns();
+    registrar_leitura(inicio, jogo_ler_status(estado, &status));
+
+    char tempo_str[16];
+    formatar_tempo(status.stats.tempo_restante, tempo_str, sizeof(tempo_str));
+    int cor_tempo = COR_SUCESSO;
+    if (status.stats.tempo_restante < 30) cor_tempo = COR_ALERTA;
+    if (status.stats.tempo_restante < 10) cor_tempo = COR_ERRO;
+    attron(COLOR_PAIR(cor_tempo) | A_BOLD);
+    mvprintw(linha + 1, 4, "TEMPO: %s", tempo_str);
+    attroff(COLOR_PAIR(cor_tempo) | A_BOLD);
+    mvprintw(linha + 1, 30, "Gerados: %d", status.stats.modulos_gerados);
+    mvprintw(linha + 1, 50, "Desarmados: %d", status.stats.modulos_desarmados);
+    mvprintw(linha + 1, 75, "Falhas: %d", status.stats.modulos_falhados);
+    if (!estado->config.modo_infinito) {
+        attron(COLOR_PAIR(COR_INFO));
+        mvprintw(linha + 2, 4, "Objetivo: Desarmar %d modulos", estado->config.modulos_para_vencer);
+        attroff(COLOR_PAIR(COR_INFO));
+    }
+}
+
+void display_ultima_mensagem(EstadoJogoCompleto* estado, int linha) {
+    if (!estado) return;
+    EntradaDiario entrada;
+    long long inicio = relogio_ns();
+    int qtd = diario_recentes(&estado->diario, &entrada, 1);
+    registrar_leitura(inicio, 0);
+    if (qtd == 0) return;
+    attron(COLOR_PAIR(COR_ALERTA));
+    mvprintw(linha + 2, 35, ">> %.*s", COLS - 42, entrada.texto);
+    attroff(COLOR_PAIR(COR_ALERTA));
+}
+
+void display_mensagens(EstadoJogoCompleto* estado, int linha) {
+    if (!estado) return;
+    int largura = COLS - 4;
+    desenhar_caixa(linha, 2, ALTURA_MENSAGENS, largura, "MENSAGENS");
+
+    EntradaDiario entradas[ALTURA_MENSAGENS - 2];
+    long long inicio = relogio_ns();
+    int qtd = diario_recentes(&estado->diario, entradas, ALTURA_MENSAGENS - 2);
+    EstatisticasDiario e = diario_estatisticas(&estado->diario);
+    registrar_leitura(inicio, 0);
+
+    for (int i = 0; i < qtd; i++) {
+        long long desde = entradas[i].instante_ns - estado->inicio_ns;
+        int segundos = desde > 0 ? (int)(desde / 1000000000LL) : 0;
+        bool mais_nova = i == qtd - 1;
+        if (mais_nova) attron(COLOR_PAIR(COR_ALERTA));
+        mvprintw(linha + 1 + i, 4, "[%02d:%02d] %.*s", segundos / 60, segundos % 60, largura - 14,
+                 entradas[i].texto);
+        if (mais_nova) attroff(COLOR_PAIR(COR_ALERTA));
+    }
+    if (e.descartadas > 0 || e.sobrescritas > 0) {
+        mvprintw(linha, largura - 36, " descartadas %ld, sobrescritas %ld ", e.descartadas, e.sobrescritas);
     }
 }
 
@@ -315,8 +390,10 @@ void display_configuracao(ConfigJogo* config, int campo_selecionado) {
 void display_fim_jogo(EstadoJogoCompleto* estado) {
     if (!estado) return;
     clear();
-    pthread_mutex_lock(&estado->mutex_estado);
-    EstadoJogo est = estado->estado;
+    /* As threads ja pararam; o retrato final foi publicado por jogo_parar_partida */
+    RetratoStatus status;
+    jogo_ler_status(estado, &status);
+    EstadoJogo est = status.estado;
     int linha = 8;
     if (est == JOGO_VITORIA) {
         attron(COLOR_PAIR(COR_SUCESSO) | A_BOLD);
@@ -328,22 +405,43 @@ void display_fim_jogo(EstadoJogoCompleto* estado) {
         attroff(COLOR_PAIR(COR_ERRO) | A_BOLD);
     }
     linha += 4;
-    if (strlen(estado->motivo_final) > 0) {
+    if (strlen(status.motivo) > 0) {
         attron(COLOR_PAIR(COR_ALERTA));
-        mvprintw(linha++, (COLS - 40) / 2, "%s", estado->motivo_final);
+        mvprintw(linha++, (COLS - 40) / 2, "%s", status.motivo);
         attroff(COLOR_PAIR(COR_ALERTA));
         linha++;
     }
     mvprintw(linha++, 20, "=== ESTATISTICAS ===");
-    mvprintw(linha++, 20, "Modulos gerados:    %d", estado->stats.modulos_gerados);
-    mvprintw(linha++, 20, "Modulos desarmados: %d", estado->stats.modulos_desarmados);
-    mvprintw(linha++, 20, "Falhas:             %d", estado->stats.modulos_falhados);
+    mvprintw(linha++, 20, "Modulos gerados:    %d", status.stats.modulos_gerados);
+    mvprintw(linha++, 20, "Modulos desarmados: %d", status.stats.modulos_desarmados);
+    mvprintw(linha++, 20, "Falhas:             %d", status.stats.modulos_falhados);
+    mvprintw(linha++, 20, "Alocacoes de heap:  %ld (pool de modulos)", pool_modulos_estatisticas().alocacoes_heap);
+    mvprintw(linha++, 20, "Semente:            %llu", (unsigned long long)estado->semente);
+    int duracao = estado->config.tempo_partida - status.stats.tempo_restante;
+    mvprintw(linha++, 20, "Despertares mural:  %ld (%.2f/s)", status.stats.despertares_mural,
+             duracao > 0 ? (double)status.stats.despertares_mural / duracao : 0.0);
+    EstatisticasDiario diario = diario_estatisticas(&estado->diario);
+    mvprintw(linha++, 20, "Mensagens:          %ld (%ld descartadas, %ld sobrescritas sem serem lidas)",
+             diario.publicadas, diario.descartadas, diario.sobrescritas);
+    if (tela.quadros > 0) {
+        mvprintw(linha++, 20, "Leitura da tela:    %.1f us/quadro (pior %.1f us), %ld releituras em %ld quadros",
+                 tela.leitura_ns / 1e3 / tela.quadros, tela.leitura_max_ns / 1e3, tela.releituras, tela.quadros);
+    }
     linha += 2;
     mvprintw(linha++, 20, "=== DESEMPENHO DOS TEDAX ===");
-    for (int i = 0; i < estado->config.num_tedax; i++) {
-        mvprintw(linha++, 20, "Tedax %d: %d desarmados, %d falhas", i + 1, estado->tedax[i].modulos_desarmados, estado->tedax[i].modulos_falhados);
+    /* Com muitos tedax, os que cabem acima do rodape */
+    for (int i = 0; i < estado->config.num_tedax && linha < LINES - 3; i++) {
+        Tedax* t = &estado->tedax[i];
+        mvprintw(linha++, 20, "Tedax %d: %d desarmados, %d falhas, ocioso %.2fs em media entre tarefas", i + 1,
+                 atomic_load_explicit(&t->modulos_desarmados, memory_order_relaxed),
+                 atomic_load_explicit(&t->modulos_falhados, memory_order_relaxed), t->trocas > 0 ? t->ocioso_ns / 1e9 / t->trocas : 0.0);
+        if (estado->config.tedax_autonomos) {
+            mvprintw(linha++, 22, "puxados %ld, roubados %ld, espera na fila p50 %.1fs p99 %.1fs",
+                     t->modulos_puxados, t->modulos_roubados,
+                     histograma_percentil(&t->latencia_fila, 50) / 1e9,
+                     histograma_percentil(&t->latencia_fila, 99) / 1e9);
+        }
     }
-    pthread_mutex_unlock(&estado->mutex_estado);
     attron(COLOR_PAIR(COR_INFO));
     mvprintw(LINES - 2, (COLS - 30) / 2, "Pressione qualquer tecla...");
     attroff(COLOR_PAIR(COR_INFO));
@@ -397,11 +495,7 @@ void display_atualizar(EstadoJogoCompleto* estado) {
 void display_mensagem(EstadoJogoCompleto* estado, const char* mensagem, int tipo) {
     (void)tipo;
     if (!estado || !mensagem) return;
-    if (pthread_mutex_trylock(&estado->mutex_estado) == 0) {
-        strncpy(estado->mensagem_feedback, mensagem, sizeof(estado->mensagem_feedback) - 1);
-        estado->tempo_mensagem = time(NULL);
-        pthread_mutex_unlock(&estado->mutex_estado);
-    }
+    diario_publicar(&estado->diario, relogio_ns(), mensagem);
 }
 
 void* thread_display(void* arg) {
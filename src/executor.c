@@ -0,0 +1,275 @@
+/*
+ * executor.c - Pool fixo de threads com fila de prontas e heap de timers
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#include "../include/executor.h"
+#include "../include/metricas.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CAPACIDADE_TIMERS_INICIAL 64
+
+/* ==================== HEAP DE TIMERS (requer o mutex) ==================== */
+
+static void timers_trocar(Executor* e, int a, int b) {
+    TarefaExecutor* t = e->timers[a];
+    e->timers[a] = e->timers[b];
+    e->timers[b] = t;
+    e->timers[a]->pos_heap = a;
+    e->timers[b]->pos_heap = b;
+}
+
+static void timers_subir(Executor* e, int i) {
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (e->timers[pai]->prazo <= e->timers[i]->prazo) break;
+        timers_trocar(e, i, pai);
+        i = pai;
+    }
+}
+
+static void timers_descer(Executor* e, int i) {
+    for (;;) {
+        int menor = i;
+        int esq = 2 * i + 1;
+        int dir = esq + 1;
+        if (esq < e->tam_timers && e->timers[esq]->prazo < e->timers[menor]->prazo) menor = esq;
+        if (dir < e->tam_timers && e->timers[dir]->prazo < e->timers[menor]->prazo) menor = dir;
+        if (menor == i) return;
+        timers_trocar(e, i, menor);
+        i = menor;
+    }
+}
+
+static bool timers_inserir(Executor* e, TarefaExecutor* t) {
+    if (e->tam_timers == e->capacidade_timers) {
+        int nova = e->capacidade_timers * 2;
+        TarefaExecutor** v = realloc(e->timers, sizeof(TarefaExecutor*) * nova);
+        if (!v) return false;
+        e->timers = v;
+        e->capacidade_timers = nova;
+    }
+    t->pos_heap = e->tam_timers++;
+    e->timers[t->pos_heap] = t;
+    timers_subir(e, t->pos_heap);
+    return true;
+}
+
+static void timers_remover(Executor* e, TarefaExecutor* t) {
+    int i = t->pos_heap;
+    int ultimo = --e->tam_timers;
+    if (i != ultimo) {
+        timers_trocar(e, i, ultimo);
+        timers_subir(e, i);
+        timers_descer(e, i);
+    }
+    t->pos_heap = -1;
+}
+
+/* ==================== FILA DE PRONTAS (requer o mutex) ==================== */
+
+static void prontas_inserir(Executor* e, TarefaExecutor* t) {
+    t->estado = TAREFA_PRONTA;
+    t->prox = NULL;
+    if (e->prontas_fim) e->prontas_fim->prox = t;
+    else e->prontas_inicio = t;
+    e->prontas_fim = t;
+
+    /* Acorda um ocioso; se o unico ocioso e o vigia, acorda o vigia */
+    if (e->ociosos > 0) pthread_cond_signal(&e->cond_trabalho);
+    else if (e->ha_vigia) pthread_cond_signal(&e->cond_vigia);
+}
+
+static TarefaExecutor* prontas_retirar(Executor* e) {
+    TarefaExecutor* t = e->prontas_inicio;
+    if (!t) return NULL;
+    e->prontas_inicio = t->prox;
+    if (!e->prontas_inicio) e->prontas_fim = NULL;
+    return t;
+}
+
+/* Agenda a tarefa para 'prazo' (ou ja, se venceu) */
+static void agendar(Executor* e, TarefaExecutor* t, long long prazo, long long agora) {
+    if (prazo <= agora) {
+        prontas_inserir(e, t);
+        return;
+    }
+    t->estado = TAREFA_DORMINDO;
+    t->prazo = prazo;
+    if (!timers_inserir(e, t)) {
+        /* Sem memoria para o heap: degrada para espera ativa */
+        prontas_inserir(e, t);
+        return;
+    }
+    /* Novo topo: o vigia precisa encurtar a espera */
+    if (t->pos_heap == 0) pthread_cond_signal(&e->cond_vigia);
+}
+
+static void* thread_trabalhador(void* arg) {
+    Executor* e = (Executor*)arg;
+
+    pthread_mutex_lock(&e->mutex);
+    while (!e->parando) {
+        /* Prazos vencidos voltam para a fila de prontas */
+        long long agora = relogio_ns();
+        while (e->tam_timers > 0 && e->timers[0]->prazo <= agora) {
+            TarefaExecutor* t = e->timers[0];
+            timers_remover(e, t);
+            prontas_inserir(e, t);
+        }
+
+        TarefaExecutor* t = prontas_retirar(e);
+        if (t) {
+            /* Sem vigia enquanto este passo roda: passa o papel a um ocioso */
+            if (e->tam_timers > 0 && !e->ha_vigia && e->ociosos > 0) {
+                pthread_cond_signal(&e->cond_trabalho);
+            }
+            t->estado = TAREFA_RODANDO;
+            t->acordar_pendente = false;
+            e->passos++;
+            pthread_mutex_unlock(&e->mutex);
+
+            long long proximo = t->passo(t->arg);
+
+            pthread_mutex_lock(&e->mutex);
+            if (proximo == EXECUTOR_CONCLUIDA) {
+                t->estado = TAREFA_CONCLUIDA;
+                pthread_cond_broadcast(&e->cond_concluida);
+            } else if (t->acordar_pendente) {
+                prontas_inserir(e, t);
+            } else if (proximo == EXECUTOR_ESTACIONAR) {
+                t->estado = TAREFA_ESTACIONADA;
+            } else {
+                agendar(e, t, proximo, relogio_ns());
+            }
+            continue;
+        }
+
+        if (e->tam_timers > 0 && !e->ha_vigia) {
+            /* Vigia: dorme ate o prazo mais proximo */
+            e->ha_vigia = true;
+            struct timespec ts = timespec_de_ns(e->timers[0]->prazo);
+            pthread_cond_timedwait(&e->cond_vigia, &e->mutex, &ts);
+            e->ha_vigia = false;
+        } else {
+            e->ociosos++;
+            pthread_cond_wait(&e->cond_trabalho, &e->mutex);
+            e->ociosos--;
+        }
+    }
+    pthread_mutex_unlock(&e->mutex);
+
+    if (e->ao_sair) e->ao_sair();
+    return NULL;
+}
+
+int executor_num_cpus(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+int executor_init(Executor* executor, int num_trabalhadores, void (*ao_sair)(void)) {
+    if (!executor) return -1;
+    memset(executor, 0, sizeof(Executor));
+    if (num_trabalhadores <= 0) num_trabalhadores = executor_num_cpus();
+
+    executor->timers = malloc(sizeof(TarefaExecutor*) * CAPACIDADE_TIMERS_INICIAL);
+    executor->trabalhadores = malloc(sizeof(pthread_t) * num_trabalhadores);
+    if (!executor->timers || !executor->trabalhadores) {
+        free(executor->timers);
+        free(executor->trabalhadores);
+        return -1;
+    }
+    executor->capacidade_timers = CAPACIDADE_TIMERS_INICIAL;
+    executor->ao_sair = ao_sair;
+
+    pthread_mutex_init(&executor->mutex, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&executor->cond_trabalho, &attr);
+    pthread_cond_init(&executor->cond_vigia, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_cond_init(&executor->cond_concluida, NULL);
+
+    for (int i = 0; i < num_trabalhadores; i++) {
+        if (pthread_create(&executor->trabalhadores[i], NULL, thread_trabalhador, executor) != 0) {
+            break;
+        }
+        executor->num_trabalhadores++;
+    }
+    if (executor->num_trabalhadores == 0) {
+        executor_destroy(executor);
+        return -1;
+    }
+    return 0;
+}
+
+void executor_destroy(Executor* executor) {
+    if (!executor || !executor->timers) return;
+
+    pthread_mutex_lock(&executor->mutex);
+    executor->parando = true;
+    pthread_cond_broadcast(&executor->cond_trabalho);
+    pthread_cond_broadcast(&executor->cond_vigia);
+    pthread_mutex_unlock(&executor->mutex);
+
+    for (int i = 0; i < executor->num_trabalhadores; i++) {
+        pthread_join(executor->trabalhadores[i], NULL);
+    }
+
+    pthread_mutex_destroy(&executor->mutex);
+    pthread_cond_destroy(&executor->cond_trabalho);
+    pthread_cond_destroy(&executor->cond_vigia);
+    pthread_cond_destroy(&executor->cond_concluida);
+    free(executor->timers);
+    free(executor->trabalhadores);
+    executor->timers = NULL;
+    executor->trabalhadores = NULL;
+    executor->num_trabalhadores = 0;
+}
+
+void executor_submeter(Executor* executor, TarefaExecutor* tarefa, PassoTarefa passo, void* arg) {
+    if (!executor || !tarefa || !passo) return;
+    tarefa->passo = passo;
+    tarefa->arg = arg;
+    tarefa->pos_heap = -1;
+    tarefa->acordar_pendente = false;
+
+    pthread_mutex_lock(&executor->mutex);
+    prontas_inserir(executor, tarefa);
+    pthread_mutex_unlock(&executor->mutex);
+}
+
+void executor_acordar(Executor* executor, TarefaExecutor* tarefa) {
+    if (!executor || !tarefa) return;
+
+    pthread_mutex_lock(&executor->mutex);
+    switch (tarefa->estado) {
+        case TAREFA_DORMINDO:
+            timers_remover(executor, tarefa);
+            prontas_inserir(executor, tarefa);
+            break;
+        case TAREFA_ESTACIONADA:
+            prontas_inserir(executor, tarefa);
+            break;
+        case TAREFA_RODANDO:
+            tarefa->acordar_pendente = true;
+            break;
+        default:
+            break;
+    }
+    pthread_mutex_unlock(&executor->mutex);
+}
+
+void executor_aguardar(Executor* executor, TarefaExecutor* tarefa) {
+    if (!executor || !tarefa) return;
+
+    pthread_mutex_lock(&executor->mutex);
+    while (tarefa->estado != TAREFA_CONCLUIDA && !executor->parando) {
+        pthread_cond_wait(&executor->cond_concluida, &executor->mutex);
+    }
+    pthread_mutex_unlock(&executor->mutex);
+}
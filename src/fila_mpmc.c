@@ -0,0 +1,86 @@
+/*
+ * fila_mpmc.c - Fila circular lock-free com slots numerados por sequencia
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#include "../include/fila_mpmc.h"
+#include <stdint.h>
+
+int fila_mpmc_init(FilaMPMC* fila, SlotFilaMPMC* slots, size_t capacidade) {
+    if (!fila || !slots || capacidade < 2 || (capacidade & (capacidade - 1)) != 0) {
+        return -1;
+    }
+
+    fila->slots = slots;
+    fila->mascara = capacidade - 1;
+
+    /* Slot i fica livre para o produtor da posicao i */
+    for (size_t i = 0; i < capacidade; i++) {
+        atomic_init(&slots[i].sequencia, i);
+    }
+
+    atomic_init(&fila->pos_escrita, 0);
+    atomic_init(&fila->pos_leitura, 0);
+    return 0;
+}
+
+bool fila_mpmc_enfileirar(FilaMPMC* fila, ModuloHandle modulo) {
+    SlotFilaMPMC* slot;
+    size_t pos = atomic_load_explicit(&fila->pos_escrita, memory_order_relaxed);
+
+    for (;;) {
+        slot = &fila->slots[pos & fila->mascara];
+        size_t seq = atomic_load_explicit(&slot->sequencia, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+        if (dif == 0) {
+            /* Slot livre: tenta reservar a posicao */
+            if (atomic_compare_exchange_weak_explicit(&fila->pos_escrita, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            /* Slot ainda nao consumido da volta anterior: fila cheia */
+            return false;
+        } else {
+            /* Outro produtor reservou esta posicao */
+            pos = atomic_load_explicit(&fila->pos_escrita, memory_order_relaxed);
+        }
+    }
+
+    slot->modulo = modulo;
+    atomic_store_explicit(&slot->sequencia, pos + 1, memory_order_release);
+    return true;
+}
+
+bool fila_mpmc_desenfileirar(FilaMPMC* fila, ModuloHandle* modulo) {
+    SlotFilaMPMC* slot;
+    size_t pos = atomic_load_explicit(&fila->pos_leitura, memory_order_relaxed);
+
+    for (;;) {
+        slot = &fila->slots[pos & fila->mascara];
+        size_t seq = atomic_load_explicit(&slot->sequencia, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (dif == 0) {
+            /* Slot publicado: tenta reservar a posicao */
+            if (atomic_compare_exchange_weak_explicit(&fila->pos_leitura, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            /* Nada publicado nesta posicao: fila vazia */
+            return false;
+        } else {
+            /* Outro consumidor retirou esta posicao */
+            pos = atomic_load_explicit(&fila->pos_leitura, memory_order_relaxed);
+        }
+    }
+
+    *modulo = slot->modulo;
+    /* Libera o slot para o produtor da proxima volta */
+    atomic_store_explicit(&slot->sequencia, pos + fila->mascara + 1, memory_order_release);
+    return true;
+}
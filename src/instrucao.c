@@ -0,0 +1,118 @@
+/*
+ * instrucao.c - Instrucoes codificadas com 2 bits por simbolo
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#include "../include/instrucao.h"
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/* Alfabeto de cada TipoModulo; o valor do simbolo e a posicao na string */
+static const char* alfabetos[MODULO_TOTAL] = { "rgby", "p", "1234", "udlr" };
+
+_Static_assert(sizeof(InstrucaoCodificada) == 16, "InstrucaoCodificada deve ter 16 bytes sem preenchimento");
+
+int instrucao_tamanho_alfabeto(TipoModulo tipo) {
+    if (tipo < 0 || tipo >= MODULO_TOTAL) return 0;
+    return (int)strlen(alfabetos[tipo]);
+}
+
+static void invalidar(TipoModulo tipo, InstrucaoCodificada* instrucao) {
+    instrucao->simbolos = 0;
+    instrucao->tamanho = 0;
+    instrucao->tipo = (uint32_t)tipo;
+}
+
+bool instrucao_codificar(TipoModulo tipo, const char* texto, InstrucaoCodificada* instrucao) {
+    if (!instrucao) return false;
+    invalidar(tipo, instrucao);
+    if (!texto || tipo < 0 || tipo >= MODULO_TOTAL) return false;
+
+    size_t tamanho = strlen(texto);
+    if (tamanho == 0 || tamanho > MAX_SIMBOLOS_INSTRUCAO) return false;
+
+    uint64_t simbolos = 0;
+    for (size_t i = 0; i < tamanho; i++) {
+        const char* pos = strchr(alfabetos[tipo], texto[i]);
+        if (!pos) return false;
+        simbolos |= (uint64_t)(pos - alfabetos[tipo]) << (2 * i);
+    }
+    instrucao->simbolos = simbolos;
+    instrucao->tamanho = (uint32_t)tamanho;
+    return true;
+}
+
+void instrucao_montar(TipoModulo tipo, const int* valores, int tamanho, InstrucaoCodificada* instrucao) {
+    if (!instrucao) return;
+    invalidar(tipo, instrucao);
+    if (!valores || tamanho < 1 || tamanho > MAX_SIMBOLOS_INSTRUCAO) return;
+
+    uint64_t simbolos = 0;
+    for (int i = 0; i < tamanho; i++) simbolos |= (uint64_t)(valores[i] & 3) << (2 * i);
+    instrucao->simbolos = simbolos;
+    instrucao->tamanho = (uint32_t)tamanho;
+}
+
+void instrucao_decodificar(const InstrucaoCodificada* instrucao, char* texto, size_t tam) {
+    if (!texto || tam == 0) return;
+    texto[0] = '\0';
+    if (!instrucao || instrucao->tipo >= MODULO_TOTAL) return;
+
+    const char* alfabeto = alfabetos[instrucao->tipo];
+    int n = (int)strlen(alfabeto);
+    size_t i;
+    for (i = 0; i < instrucao->tamanho && i + 1 < tam; i++) {
+        int valor = (int)((instrucao->simbolos >> (2 * i)) & 3);
+        texto[i] = valor < n ? alfabeto[valor] : '?';
+    }
+    texto[i] = '\0';
+}
+
+bool instrucao_conferir(const InstrucaoCodificada* esperada, const InstrucaoCodificada* recebida) {
+    if (!esperada || !recebida || esperada->tamanho == 0) return false;
+    /* '&' em vez de '&&': sem desvios que o preditor erraria em metade dos pares */
+    return (esperada->simbolos == recebida->simbolos) & (esperada->tamanho == recebida->tamanho) &
+           (esperada->tipo == recebida->tipo);
+}
+
+int instrucao_verificar_lote(const InstrucaoCodificada* esperadas, const InstrucaoCodificada* recebidas, int n,
+                             uint8_t* resultados) {
+    if (!esperadas || !recebidas || n <= 0) return 0;
+    int conferem = 0;
+    int i = 0;
+
+#if defined(__AVX2__)
+    /* Dois pares por comparacao: 16 bits da mascara para cada par */
+    for (; i + 2 <= n; i += 2) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)&esperadas[i]);
+        __m256i b = _mm256_loadu_si256((const __m256i*)&recebidas[i]);
+        uint32_t iguais = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+        int ok0 = ((iguais & 0xFFFFu) == 0xFFFFu) & (esperadas[i].tamanho != 0);
+        int ok1 = ((iguais >> 16) == 0xFFFFu) & (esperadas[i + 1].tamanho != 0);
+        if (resultados) {
+            resultados[i] = (uint8_t)ok0;
+            resultados[i + 1] = (uint8_t)ok1;
+        }
+        conferem += ok0 + ok1;
+    }
+#elif defined(__SSE2__)
+    for (; i < n; i++) {
+        __m128i a = _mm_loadu_si128((const __m128i*)&esperadas[i]);
+        __m128i b = _mm_loadu_si128((const __m128i*)&recebidas[i]);
+        int ok = (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF) & (esperadas[i].tamanho != 0);
+        if (resultados) resultados[i] = (uint8_t)ok;
+        conferem += ok;
+    }
+#endif
+
+    /* Resto (ou tudo, sem SIMD) */
+    for (; i < n; i++) {
+        int ok = instrucao_conferir(&esperadas[i], &recebidas[i]);
+        if (resultados) resultados[i] = (uint8_t)ok;
+        conferem += ok;
+    }
+    return conferem;
+}
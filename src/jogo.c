@@ -5,9 +5,19 @@
 
 #include "../include/jogo.h"
 #include "../include/modulos.h"
+#include "../include/pool_modulos.h"
+#include "../include/aleatorio.h"
+#include "../include/chegadas.h"
+#include "../include/metricas.h"
+#include "../include/executor.h"
 #include "../include/bancada.h"
 #include "../include/tedax.h"
 #include "../include/display.h"
+#include "../include/afinidade.h"
+#include "../include/instrucao.h"
+#include "../include/piloto.h"
+#include "../include/retrato.h"
+#include "../include/diario.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,6 +25,8 @@
 #include <stdarg.h>
 #include <ctype.h>
 
+#define NS_POR_SEGUNDO 1000000000LL
+
 extern EstadoJogoCompleto* jogo;
 
 ConfigJogo config_padrao(void) {
@@ -25,21 +37,42 @@ ConfigJogo config_padrao(void) {
     config.dificuldade = 1;
     config.modulos_para_vencer = 10;
     config.modo_infinito = false;
+    config.capacidade_fila = MAX_MODULOS_PENDENTES;
+    config.fila_crescente = false;
+    config.politica_fila = FILA_FIFO;
+    config.semente = 0;
+    config.modelo_chegada = CHEGADA_UNIFORME;
+    config.taxa_chegada = TAXA_CHEGADA_PADRAO;
+    config.taxa_rajada = TAXA_RAJADA_PADRAO;
+    config.duracao_rajada = DURACAO_RAJADA_PADRAO;
+    config.duracao_calmaria = DURACAO_CALMARIA_PADRAO;
+    config.arquivo_trace[0] = '\0';
+    config.tedax_autonomos = false;
+    config.tedax_em_pool = false;
+    config.trabalhadores_pool = 0;
+    config.piloto = PILOTO_DESLIGADO;
+    memset(config.afinidade, 0, sizeof(config.afinidade));
     return config;
 }
 
+void config_normalizar(ConfigJogo* config) {
+    if (!config) return;
+    if (config->num_tedax < 1) config->num_tedax = 1;
+    if (config->num_tedax > MAX_TEDAX) config->num_tedax = MAX_TEDAX;
+    if (config->num_bancadas < 1) config->num_bancadas = 1;
+    if (config->num_bancadas > MAX_BANCADAS) config->num_bancadas = MAX_BANCADAS;
+    if (config->dificuldade < 1) config->dificuldade = 1;
+    if (config->dificuldade > 3) config->dificuldade = 3;
+    if (config->capacidade_fila < 1) config->capacidade_fila = MAX_MODULOS_PENDENTES;
+}
+
 int jogo_init(EstadoJogoCompleto* estado, ConfigJogo* config) {
     if (!estado || !config) return -1;
 
     memset(estado, 0, sizeof(EstadoJogoCompleto));
 
     memcpy(&estado->config, config, sizeof(ConfigJogo));
-    if (estado->config.num_tedax < 1) estado->config.num_tedax = 1;
-    if (estado->config.num_tedax > MAX_TEDAX) estado->config.num_tedax = MAX_TEDAX;
-    if (estado->config.num_bancadas < 1) estado->config.num_bancadas = 1;
-    if (estado->config.num_bancadas > MAX_BANCADAS) estado->config.num_bancadas = MAX_BANCADAS;
-    if (estado->config.dificuldade < 1) estado->config.dificuldade = 1;
-    if (estado->config.dificuldade > 3) estado->config.dificuldade = 3;
+    config_normalizar(&estado->config);
 
     estado->estado = JOGO_MENU;
     estado->executando = true;
@@ -47,28 +80,44 @@ int jogo_init(EstadoJogoCompleto* estado, ConfigJogo* config) {
 
     memset(&estado->stats, 0, sizeof(Estatisticas));
     estado->stats.tempo_restante = estado->config.tempo_partida;
+    atomic_init(&estado->gerados_mural, 0);
+    atomic_init(&estado->despertares_mural, 0);
 
     pthread_mutex_init(&estado->mutex_estado, NULL);
     pthread_mutex_init(&estado->mutex_display, NULL);
     pthread_mutex_init(&estado->mutex_comando, NULL);
     pthread_cond_init(&estado->cond_fim_jogo, NULL);
 
-    fila_modulos_init(&estado->fila_modulos);
+    /* Esperas com prazo absoluto no relogio monotonico (thread do mural) */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&estado->cond_estado, &attr);
+    pthread_condattr_destroy(&attr);
 
-    for (int i = 0; i < MAX_BANCADAS; i++) {
-        bancada_init(&estado->bancadas[i], i);
+    if (pool_modulos_init() != 0) {
+        return -1;
     }
 
-    for (int i = 0; i < MAX_TEDAX; i++) {
-        tedax_init(&estado->tedax[i], i);
+    if (fila_modulos_init(&estado->fila_modulos, estado->config.capacidade_fila,
+                          estado->config.fila_crescente, estado->config.politica_fila) != 0) {
+        pool_modulos_destroy();
+        return -1;
+    }
+
+    if (jogo_dimensionar(estado) != 0) {
+        fila_modulos_destroy(&estado->fila_modulos);
+        pool_modulos_destroy();
+        return -1;
     }
 
     memset(estado->buffer_comando, 0, sizeof(estado->buffer_comando));
     estado->pos_buffer = 0;
 
-    memset(estado->mensagem_feedback, 0, sizeof(estado->mensagem_feedback));
-    estado->tempo_mensagem = 0;
+    diario_init(&estado->diario);
     memset(estado->motivo_final, 0, sizeof(estado->motivo_final));
+    retrato_init(&estado->seq_status, estado->status_publicado, sizeof(RetratoStatus));
+    jogo_publicar_status(estado);
 
     return 0;
 }
@@ -79,39 +128,156 @@ void jogo_finalizar(EstadoJogoCompleto* estado) {
     estado->executando = false;
     jogo_parar_partida(estado);
 
-    for (int i = 0; i < MAX_BANCADAS; i++) bancada_destroy(&estado->bancadas[i]);
-    for (int i = 0; i < MAX_TEDAX; i++) tedax_destroy(&estado->tedax[i]);
+    jogo_liberar_elementos(estado);
     fila_modulos_destroy(&estado->fila_modulos);
+    pool_modulos_destroy();
 
     pthread_mutex_destroy(&estado->mutex_estado);
     pthread_mutex_destroy(&estado->mutex_display);
     pthread_mutex_destroy(&estado->mutex_comando);
     pthread_cond_destroy(&estado->cond_fim_jogo);
+    pthread_cond_destroy(&estado->cond_estado);
+}
+
+int jogo_dimensionar(EstadoJogoCompleto* estado) {
+    if (!estado) return -1;
+    int num_tedax = estado->config.num_tedax;
+    int num_bancadas = estado->config.num_bancadas;
+    if (estado->tedax && num_tedax <= estado->capacidade_tedax && num_bancadas <= estado->capacidade_bancadas) {
+        return 0;
+    }
+    jogo_liberar_elementos(estado);
+
+    /* O menu sobe ate os seus limites sem realocar */
+    int capacidade_tedax = num_tedax > MAX_TEDAX_MENU ? num_tedax : MAX_TEDAX_MENU;
+    int capacidade_bancadas = num_bancadas > MAX_BANCADAS_MENU ? num_bancadas : MAX_BANCADAS_MENU;
+    Tedax* tedax = aligned_alloc(TAMANHO_LINHA_CACHE, sizeof(Tedax) * capacidade_tedax);
+    Bancada* bancadas = aligned_alloc(TAMANHO_LINHA_CACHE, sizeof(Bancada) * capacidade_bancadas);
+    if (!tedax || !bancadas) {
+        free(tedax);
+        free(bancadas);
+        return -1;
+    }
+    memset(tedax, 0, sizeof(Tedax) * capacidade_tedax);
+    memset(bancadas, 0, sizeof(Bancada) * capacidade_bancadas);
+    for (int i = 0; i < capacidade_bancadas; i++) bancada_init(&bancadas[i], i);
+    for (int i = 0; i < capacidade_tedax; i++) tedax_init(&tedax[i], i);
+
+    estado->tedax = tedax;
+    estado->bancadas = bancadas;
+    estado->capacidade_tedax = capacidade_tedax;
+    estado->capacidade_bancadas = capacidade_bancadas;
+    if (mapa_bancadas_init(&estado->mapa_bancadas, bancadas, capacidade_bancadas) != 0) {
+        jogo_liberar_elementos(estado);
+        return -1;
+    }
+    return 0;
+}
+
+void jogo_liberar_elementos(EstadoJogoCompleto* estado) {
+    if (!estado) return;
+
+    mapa_bancadas_destroy(&estado->mapa_bancadas);
+    for (int i = 0; i < estado->capacidade_bancadas; i++) bancada_destroy(&estado->bancadas[i]);
+    for (int i = 0; i < estado->capacidade_tedax; i++) {
+        /* Modulos ainda nas caixas e deques voltam ao pool */
+        Tedax* t = &estado->tedax[i];
+        tedax_esvaziar_caixa(t);
+        for (int k = 0; k < t->deque_qtd; k++) {
+            pool_modulos_liberar(t->deque[(t->deque_inicio + k) % CAPACIDADE_DEQUE_TEDAX]);
+        }
+        t->deque_qtd = 0;
+        tedax_destroy(t);
+    }
+    free(estado->bancadas);
+    free(estado->tedax);
+    estado->bancadas = NULL;
+    estado->tedax = NULL;
+    estado->capacidade_bancadas = 0;
+    estado->capacidade_tedax = 0;
 }
 
 int jogo_iniciar_partida(EstadoJogoCompleto* estado) {
     if (!estado) return -1;
 
+    /* Vetores de tedax e bancadas do tamanho pedido nas configuracoes */
+    if (jogo_dimensionar(estado) != 0) return -1;
+
+    /* Descarta os pendentes da partida anterior */
+    fila_modulos_limpar(&estado->fila_modulos);
+
+    /* Mensagens e contadores do diario sao da partida (nenhum produtor rodando) */
+    diario_init(&estado->diario);
+
+    /* Recria a fila se a capacidade ou a politica mudaram nas configuracoes */
+    if (estado->config.capacidade_fila < 1) estado->config.capacidade_fila = MAX_MODULOS_PENDENTES;
+    if (estado->fila_modulos.limite != estado->config.capacidade_fila ||
+        estado->fila_modulos.crescente != estado->config.fila_crescente ||
+        estado->fila_modulos.politica != estado->config.politica_fila) {
+        fila_modulos_destroy(&estado->fila_modulos);
+        if (fila_modulos_init(&estado->fila_modulos, estado->config.capacidade_fila,
+                              estado->config.fila_crescente, estado->config.politica_fila) != 0) {
+            return -1;
+        }
+    }
+
+    /* Modelo de chegada da partida (le o trace antes de iniciar as threads) */
+    uint64_t semente = estado->config.semente ? estado->config.semente : aleatorio_semente_relogio();
+    chegadas_destroy(&estado->chegadas);
+    if (chegadas_init(&estado->chegadas, &estado->config, semente) != 0) {
+        return -1;
+    }
+
+    /* Tedax como maquinas de estados multiplexadas em poucas threads */
+    if (estado->config.tedax_em_pool &&
+        executor_init(&estado->executor, estado->config.trabalhadores_pool,
+                      pool_modulos_devolver_cache) != 0) {
+        chegadas_destroy(&estado->chegadas);
+        return -1;
+    }
+    for (int i = 0; i < estado->executor.num_trabalhadores; i++) {
+        char nome[24];
+        snprintf(nome, sizeof(nome), "executor-%d", i + 1);
+        afinidade_aplicar(estado->executor.trabalhadores[i], &estado->config, PAPEL_TEDAX, nome);
+    }
+
     pthread_mutex_lock(&estado->mutex_estado);
     memset(&estado->stats, 0, sizeof(Estatisticas));
     estado->stats.tempo_restante = estado->config.tempo_partida;
     estado->stats.inicio_partida = time(NULL);
+    atomic_store_explicit(&estado->gerados_mural, 0, memory_order_relaxed);
+    atomic_store_explicit(&estado->despertares_mural, 0, memory_order_relaxed);
     estado->proximo_id_modulo = 1;
+    estado->semente = semente;
+    estado->inicio_ns = relogio_ns();
     estado->estado = JOGO_RODANDO;
     memset(estado->motivo_final, 0, sizeof(estado->motivo_final));
+    jogo_publicar_status(estado);
+    pthread_cond_broadcast(&estado->cond_estado);
     pthread_mutex_unlock(&estado->mutex_estado);
 
-    while (!fila_modulos_vazia(&estado->fila_modulos)) {
-        Modulo m;
-        fila_modulos_remover(&estado->fila_modulos, &m);
-    }
-
     for (int i = 0; i < estado->config.num_tedax; i++) {
+        /* Designacoes nao iniciadas na partida anterior */
+        tedax_esvaziar_caixa(&estado->tedax[i]);
         pthread_mutex_lock(&estado->tedax[i].mutex);
         estado->tedax[i].estado = ESTADO_LIVRE;
-        estado->tedax[i].modulos_desarmados = 0;
-        estado->tedax[i].modulos_falhados = 0;
-        estado->tedax[i].tarefa_pendente = false;
+        atomic_store_explicit(&estado->tedax[i].modulos_desarmados, 0, memory_order_relaxed);
+        atomic_store_explicit(&estado->tedax[i].modulos_falhados, 0, memory_order_relaxed);
+        estado->tedax[i].modulo_atual = MODULO_HANDLE_NULO;
+        estado->tedax[i].livre_desde_ns = 0;
+        estado->tedax[i].ocioso_ns = 0;
+        estado->tedax[i].trocas = 0;
+        /* Deque local (modo autonomo) */
+        for (int k = 0; k < estado->tedax[i].deque_qtd; k++) {
+            int pos = (estado->tedax[i].deque_inicio + k) % CAPACIDADE_DEQUE_TEDAX;
+            pool_modulos_liberar(estado->tedax[i].deque[pos]);
+        }
+        estado->tedax[i].deque_inicio = 0;
+        estado->tedax[i].deque_qtd = 0;
+        estado->tedax[i].modulos_puxados = 0;
+        estado->tedax[i].modulos_roubados = 0;
+        histograma_zerar(&estado->tedax[i].latencia_fila);
+        tedax_publicar(&estado->tedax[i]);
         pthread_mutex_unlock(&estado->tedax[i].mutex);
     }
 
@@ -119,16 +285,31 @@ int jogo_iniciar_partida(EstadoJogoCompleto* estado) {
         pthread_mutex_lock(&estado->bancadas[i].mutex);
         estado->bancadas[i].estado = ESTADO_LIVRE;
         estado->bancadas[i].tedax_id = -1;
-        estado->bancadas[i].modulo_atual = NULL;
+        estado->bancadas[i].modulo_atual = MODULO_HANDLE_NULO;
+        estado->bancadas[i].fila_inicio = NULL;
+        estado->bancadas[i].fila_fim = NULL;
+        estado->bancadas[i].esperando = 0;
+        bancada_publicar(&estado->bancadas[i]);
         pthread_mutex_unlock(&estado->bancadas[i].mutex);
     }
+    mapa_bancadas_sincronizar(&estado->mapa_bancadas);
 
-    for (int i = 0; i < estado->config.num_tedax; i++) {
-        tedax_iniciar_thread(&estado->tedax[i]);
+    if (estado->config.tedax_em_pool) {
+        for (int i = 0; i < estado->config.num_tedax; i++) {
+            tedax_iniciar_tarefa(&estado->tedax[i], &estado->executor);
+        }
+    } else {
+        for (int i = 0; i < estado->config.num_tedax; i++) {
+            tedax_iniciar_thread(&estado->tedax[i]);
+        }
     }
 
-    pthread_create(&estado->thread_mural, NULL, thread_mural_modulos, estado);
-    pthread_create(&estado->thread_timer, NULL, thread_timer, estado);
+    afinidade_criar_thread(&estado->thread_mural, &estado->config, PAPEL_MURAL, -1, thread_mural_modulos, estado);
+    afinidade_criar_thread(&estado->thread_timer, &estado->config, PAPEL_TIMER, -1, thread_timer, estado);
+    if (estado->config.piloto != PILOTO_DESLIGADO) {
+        afinidade_criar_thread(&estado->thread_coordenador, &estado->config, PAPEL_COORDENADOR, -1,
+                               thread_coordenador, estado);
+    }
 
     jogo_feedback(estado, "Partida iniciada! Boa sorte!");
 
@@ -149,21 +330,35 @@ void jogo_parar_partida(EstadoJogoCompleto* estado) {
      */
     pthread_mutex_lock(&estado->mutex_estado);
     estado->executando = false;
+    pthread_cond_broadcast(&estado->cond_estado); /* Tedax autonomos parados */
     pthread_mutex_unlock(&estado->mutex_estado);
 
     for (int i = 0; i < estado->config.num_tedax; i++) {
         tedax_parar_thread(&estado->tedax[i]);
     }
+    if (estado->executor.trabalhadores) executor_destroy(&estado->executor);
 
     pthread_mutex_lock(&estado->mutex_estado);
     if (estado->estado == JOGO_RODANDO || estado->estado == JOGO_PAUSADO) {
         estado->estado = JOGO_SAINDO;
     }
     pthread_cond_broadcast(&estado->cond_fim_jogo);
+    pthread_cond_broadcast(&estado->cond_estado);
     pthread_mutex_unlock(&estado->mutex_estado);
 
+    /* Libera quem estiver bloqueado esperando a fila */
+    fila_modulos_despertar(&estado->fila_modulos);
+
     pthread_join(estado->thread_mural, NULL);
     pthread_join(estado->thread_timer, NULL);
+    if (estado->config.piloto != PILOTO_DESLIGADO) pthread_join(estado->thread_coordenador, NULL);
+
+    /* Retrato final para a tela de fim, com as threads ja paradas */
+    pthread_mutex_lock(&estado->mutex_estado);
+    jogo_publicar_status(estado);
+    pthread_mutex_unlock(&estado->mutex_estado);
+
+    chegadas_destroy(&estado->chegadas);
 }
 
 void jogo_pausar(EstadoJogoCompleto* estado) {
@@ -184,48 +379,95 @@ void jogo_pausar(EstadoJogoCompleto* estado) {
     }
 
     if (msg) {
-        strncpy(estado->mensagem_feedback, msg, sizeof(estado->mensagem_feedback) - 1);
-        estado->tempo_mensagem = time(NULL);
+        diario_publicar(&estado->diario, relogio_ns(), msg);
+        jogo_publicar_status(estado);
+        pthread_cond_broadcast(&estado->cond_estado);
     }
 
     pthread_mutex_unlock(&estado->mutex_estado);
+
+    /* Modo pool: as tarefas nao dormem em cond_estado; acorda todas para reverem o estado */
+    if (msg && estado->executor.trabalhadores) {
+        for (int i = 0; i < estado->config.num_tedax; i++) {
+            executor_acordar(&estado->executor, &estado->tedax[i].tarefa);
+        }
+    }
+}
+
+int jogo_modulos_pendentes(EstadoJogoCompleto* estado) {
+    if (!estado) return 0;
+    int qtd = fila_modulos_quantidade(&estado->fila_modulos);
+    for (int i = 0; i < estado->config.num_tedax; i++) {
+        qtd += tedax_quantidade_caixa(&estado->tedax[i]);
+    }
+    if (estado->config.tedax_autonomos) {
+        for (int i = 0; i < estado->config.num_tedax; i++) {
+            qtd += tedax_quantidade_deque(&estado->tedax[i]);
+        }
+    }
+    return qtd;
+}
+
+void jogo_somar_contadores(EstadoJogoCompleto* estado, Estatisticas* stats) {
+    if (!estado || !stats) return;
+    int desarmados = 0, falhados = 0;
+    for (int i = 0; i < estado->config.num_tedax; i++) {
+        desarmados += atomic_load_explicit(&estado->tedax[i].modulos_desarmados, memory_order_relaxed);
+        falhados += atomic_load_explicit(&estado->tedax[i].modulos_falhados, memory_order_relaxed);
+    }
+    stats->modulos_desarmados = desarmados;
+    stats->modulos_falhados = falhados;
+    stats->modulos_gerados = atomic_load_explicit(&estado->gerados_mural, memory_order_relaxed);
+    stats->despertares_mural = atomic_load_explicit(&estado->despertares_mural, memory_order_relaxed);
+}
+
+bool jogo_avaliar_fim(const ConfigJogo* config, const Estatisticas* stats, int pendentes,
+                      EstadoJogo* novo_estado, char* motivo, size_t tam_motivo) {
+    if (!config || !stats) return false;
+
+    if (!config->modo_infinito && stats->modulos_desarmados >= config->modulos_para_vencer) {
+        *novo_estado = JOGO_VITORIA;
+        snprintf(motivo, tam_motivo, "Objetivo alcancado (%d modulos desarmados)",
+                 config->modulos_para_vencer);
+        return true;
+    }
+
+    if (stats->tempo_restante <= 0) {
+        *novo_estado = JOGO_DERROTA;
+        snprintf(motivo, tam_motivo, "Tempo esgotado");
+        return true;
+    }
+
+    if (pendentes >= config->capacidade_fila) {
+        *novo_estado = JOGO_DERROTA;
+        snprintf(motivo, tam_motivo, "Fila cheia: %d modulos pendentes", pendentes);
+        return true;
+    }
+    return false;
 }
 
 bool jogo_verificar_fim(EstadoJogoCompleto* estado) {
     if (!estado) return true;
 
+    /* Conta e soma antes de tomar mutex_estado (as deques tem mutex proprio) */
+    int pendentes = jogo_modulos_pendentes(estado);
+    Estatisticas stats;
+    jogo_somar_contadores(estado, &stats);
+
     pthread_mutex_lock(&estado->mutex_estado);
-    bool fim = false;
+    stats.inicio_partida = estado->stats.inicio_partida;
+    stats.tempo_restante = estado->stats.tempo_restante;
+    stats.modulos_pendentes = pendentes;
     EstadoJogo novo_estado = estado->estado;
+    bool fim = jogo_avaliar_fim(&estado->config, &stats, pendentes, &novo_estado,
+                                estado->motivo_final, sizeof(estado->motivo_final));
 
-    if (!estado->config.modo_infinito &&
-        estado->stats.modulos_desarmados >= estado->config.modulos_para_vencer) {
-        novo_estado = JOGO_VITORIA;
-        snprintf(estado->motivo_final, sizeof(estado->motivo_final),
-                 "Objetivo alcancado (%d modulos desarmados)",
-                 estado->config.modulos_para_vencer);
-        fim = true;
-    }
-
-    if (!fim && estado->stats.tempo_restante <= 0) {
-        novo_estado = JOGO_DERROTA;
-        snprintf(estado->motivo_final, sizeof(estado->motivo_final),
-                 "Tempo esgotado");
-        fim = true;
-    }
-
-    if (!fim) {
-        int pendentes = fila_modulos_quantidade(&estado->fila_modulos);
-        if (pendentes >= MAX_MODULOS_PENDENTES) {
-            novo_estado = JOGO_DERROTA;
-            snprintf(estado->motivo_final, sizeof(estado->motivo_final),
-                     "Fila cheia: %d modulos pendentes", pendentes);
-            fim = true;
-        }
+    if (fim) {
+        estado->estado = novo_estado;
+        jogo_publicar_status(estado);
+        pthread_cond_broadcast(&estado->cond_estado);
     }
 
-    if (fim) estado->estado = novo_estado;
-
     pthread_mutex_unlock(&estado->mutex_estado);
     return fim;
 }
@@ -299,59 +541,43 @@ bool jogo_processar_comando(EstadoJogoCompleto* estado, const char* comando) {
         return false;
     }
 
-    Tedax* tedax = &estado->tedax[tedax_num - 1];
-    if (!tedax_disponivel(tedax)) {
-        jogo_feedback(estado, "Tedax %d esta ocupado!", tedax_num);
+    /* A caixa do tedax e SPSC: com o piloto ligado, so ele designa */
+    if (estado->config.piloto != PILOTO_DESLIGADO) {
+        jogo_feedback(estado, "Piloto automatico (%s) no comando!", piloto_nome_politica(estado->config.piloto));
         return false;
     }
 
-    Modulo modulo_encontrado;
-    bool encontrou = false;
-
-    /* Usa trylock para nao bloquear */
-    if (pthread_mutex_trylock(&estado->fila_modulos.mutex) != 0) {
-        jogo_feedback(estado, "Sistema ocupado, tente novamente!");
+    Tedax* tedax = &estado->tedax[tedax_num - 1];
+    if (tedax_quantidade_caixa(tedax) >= CAPACIDADE_CAIXA_TEDAX) {
+        jogo_feedback(estado, "Tedax %d ja tem %d tarefas na fila!", tedax_num, CAPACIDADE_CAIXA_TEDAX);
         return false;
     }
 
-    for (int i = 0; i < estado->fila_modulos.quantidade; i++) {
-        int idx = (estado->fila_modulos.inicio + i) % MAX_MODULOS_PENDENTES;
-        if (estado->fila_modulos.modulos[idx].tipo == tipo) {
-            memcpy(&modulo_encontrado, &estado->fila_modulos.modulos[idx], sizeof(Modulo));
-            encontrou = true;
-            for (int j = i; j < estado->fila_modulos.quantidade - 1; j++) {
-                int idx_atual = (estado->fila_modulos.inicio + j) % MAX_MODULOS_PENDENTES;
-                int idx_prox = (estado->fila_modulos.inicio + j + 1) % MAX_MODULOS_PENDENTES;
-                memcpy(&estado->fila_modulos.modulos[idx_atual], &estado->fila_modulos.modulos[idx_prox], sizeof(Modulo));
-            }
-            estado->fila_modulos.fim = (estado->fila_modulos.fim - 1 + MAX_MODULOS_PENDENTES) % MAX_MODULOS_PENDENTES;
-            estado->fila_modulos.quantidade--;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&estado->fila_modulos.mutex);
+    ModuloHandle modulo_encontrado;
+    bool encontrou = fila_modulos_remover_por_tipo(&estado->fila_modulos, tipo, &modulo_encontrado);
 
     if (!encontrou) {
         jogo_feedback(estado, "Nenhum modulo do tipo '%c' na fila!", tipo_char);
         return false;
     }
 
-    if (!tedax_designar_modulo(tedax, &modulo_encontrado, bancada_num - 1, instrucao)) {
-        fila_modulos_adicionar(&estado->fila_modulos, &modulo_encontrado);
-        jogo_feedback(estado, "Erro ao designar modulo para Tedax %d!", tedax_num);
-        return false;
-    }
-
-    jogo_feedback(estado, "Tedax %d designado: %s -> Bancada %d", tedax_num, modulo_encontrado.nome, bancada_num);
+    /* Copia o nome: depois de designado, o modulo pertence ao tedax */
+    char nome_modulo[MAX_NOME_MODULO];
+    strcpy(nome_modulo, pool_modulos_obter(modulo_encontrado)->nome);
 
-    int qtd = fila_modulos_quantidade(&estado->fila_modulos);
+    /* Simbolo fora do alfabeto vira instrucao invalida: o modulo falha na bancada */
+    InstrucaoCodificada codificada;
+    instrucao_codificar(tipo, instrucao, &codificada);
 
-    /* Atualiza estatisticas sem bloquear */
-    if (pthread_mutex_trylock(&estado->mutex_estado) == 0) {
-        estado->stats.modulos_pendentes = qtd;
-        pthread_mutex_unlock(&estado->mutex_estado);
+    if (!tedax_designar_modulo(tedax, modulo_encontrado, bancada_num - 1, &codificada)) {
+        if (!fila_modulos_adicionar(&estado->fila_modulos, modulo_encontrado)) {
+            pool_modulos_liberar(modulo_encontrado);
+        }
+        jogo_feedback(estado, "Erro ao designar modulo para Tedax %d!", tedax_num);
+        return false;
     }
 
+    jogo_feedback(estado, "Tedax %d designado: %s -> Bancada %d", tedax_num, nome_modulo, bancada_num);
     return true;
 }
 
@@ -381,17 +607,26 @@ bool jogo_executar_comando(EstadoJogoCompleto* estado) {
 
 void jogo_feedback(EstadoJogoCompleto* estado, const char* formato, ...) {
     if (!estado || !formato) return;
+    char texto[MAX_TEXTO_DIARIO];
     va_list args;
     va_start(args, formato);
+    vsnprintf(texto, sizeof(texto), formato, args);
+    va_end(args);
 
-    /* Usa trylock para nao bloquear */
-    if (pthread_mutex_trylock(&estado->mutex_estado) == 0) {
-        vsnprintf(estado->mensagem_feedback, sizeof(estado->mensagem_feedback), formato, args);
-        estado->tempo_mensagem = time(NULL);
-        pthread_mutex_unlock(&estado->mutex_estado);
-    }
+    /* Sem trava: no pior caso a entrada e descartada e contada */
+    diario_publicar(&estado->diario, relogio_ns(), texto);
+}
 
-    va_end(args);
+void jogo_publicar_status(EstadoJogoCompleto* estado) {
+    RetratoStatus retrato = { .estado = estado->estado, .stats = estado->stats };
+    memcpy(retrato.motivo, estado->motivo_final, sizeof(retrato.motivo));
+    retrato_publicar(&estado->seq_status, estado->status_publicado, &retrato, sizeof(RetratoStatus));
+}
+
+int jogo_ler_status(EstadoJogoCompleto* estado, RetratoStatus* retrato) {
+    int releituras = retrato_ler(&estado->seq_status, estado->status_publicado, retrato, sizeof(RetratoStatus));
+    jogo_somar_contadores(estado, &retrato->stats);
+    return releituras;
 }
 
 EstadoJogo jogo_obter_estado(EstadoJogoCompleto* estado) {
@@ -404,34 +639,48 @@ void jogo_definir_estado(EstadoJogoCompleto* estado, EstadoJogo novo_estado) {
     if (!estado) return;
     pthread_mutex_lock(&estado->mutex_estado);
     estado->estado = novo_estado;
+    jogo_publicar_status(estado);
+    pthread_cond_broadcast(&estado->cond_estado);
     pthread_mutex_unlock(&estado->mutex_estado);
 }
 
+/*
+ * Thread do temporizador. Cada segundo e um prazo absoluto contado de
+ * inicio_ns (sem deriva, como o mural), atrasado de FASE_TIMER_MS: as
+ * chegadas e os trabalhos que vencem no mesmo segundo cheio ja aconteceram
+ * quando o tique verifica o fim, na partida real e na simulacao. A pausa
+ * adia os prazos pelo tempo pausado.
+ */
 void* thread_timer(void* arg) {
     EstadoJogoCompleto* estado = (EstadoJogoCompleto*)arg;
     if (!estado) return NULL;
 
-    while (estado->executando) {
-        pthread_mutex_lock(&estado->mutex_estado);
-        EstadoJogo est = estado->estado;
-        pthread_mutex_unlock(&estado->mutex_estado);
+    long long prazo = estado->inicio_ns + NS_POR_SEGUNDO + FASE_TIMER_MS * 1000000LL;
 
-        if (est == JOGO_RODANDO) {
-            sleep(1);
-            pthread_mutex_lock(&estado->mutex_estado);
-            if (estado->stats.tempo_restante > 0) estado->stats.tempo_restante--;
-            pthread_mutex_unlock(&estado->mutex_estado);
-            if (jogo_verificar_fim(estado)) break;
-        } else if (est == JOGO_PAUSADO) {
-            usleep(100000);
-        } else {
-            break;
+    pthread_mutex_lock(&estado->mutex_estado);
+    while (estado->executando) {
+        if (estado->estado == JOGO_PAUSADO) {
+            long long inicio_pausa = relogio_ns();
+            while (estado->executando && estado->estado == JOGO_PAUSADO) {
+                pthread_cond_wait(&estado->cond_estado, &estado->mutex_estado);
+            }
+            prazo += relogio_ns() - inicio_pausa;
+            continue;
         }
-    }
-    return NULL;
-}
+        if (estado->estado != JOGO_RODANDO) break;
+
+        struct timespec ts = timespec_de_ns(prazo);
+        pthread_cond_timedwait(&estado->cond_estado, &estado->mutex_estado, &ts);
+        /* Acordou antes do prazo: mudanca de estado (ou despertar espurio) */
+        if (estado->estado != JOGO_RODANDO || relogio_ns() < prazo) continue;
 
-void* thread_coordenador(void* arg) {
-    (void)arg;
+        if (estado->stats.tempo_restante > 0) estado->stats.tempo_restante--;
+        jogo_publicar_status(estado);
+        prazo += NS_POR_SEGUNDO;
+        pthread_mutex_unlock(&estado->mutex_estado);
+        if (jogo_verificar_fim(estado)) return NULL;
+        pthread_mutex_lock(&estado->mutex_estado);
+    }
+    pthread_mutex_unlock(&estado->mutex_estado);
     return NULL;
 }
@@ -18,9 +18,17 @@
 #include "../include/modulos.h"
 #include "../include/tedax.h"
 #include "../include/bancada.h"
+#include "../include/chegadas.h"
+#include "../include/aleatorio.h"
+#include "../include/simulacao.h"
+#include "../include/afinidade.h"
+#include "../include/metricas.h"
+#include "../include/piloto.h"
 
 EstadoJogoCompleto* jogo = NULL;
 static volatile sig_atomic_t sinal_recebido = 0;
+static int partidas_simuladas = 0; /* --simular N: sem ncurses nem threads */
+static bool sem_tela = false;      /* --sem-tela: uma partida real sem ncurses */
 
 void handler_sinal(int sig) {
     (void)sig;
@@ -89,8 +97,8 @@ void menu_configuracoes(ConfigJogo* config) {
                 } break;
             case KEY_RIGHT: case 'd': case 'D':
                 switch (campo) {
-                    case 0: if (config->num_tedax < MAX_TEDAX) config->num_tedax++; break;
-                    case 1: if (config->num_bancadas < MAX_BANCADAS) config->num_bancadas++; break;
+                    case 0: if (config->num_tedax < MAX_TEDAX_MENU) config->num_tedax++; break;
+                    case 1: if (config->num_bancadas < MAX_BANCADAS_MENU) config->num_bancadas++; break;
                     case 2: if (config->tempo_partida < 300) config->tempo_partida += 30; break;
                     case 3: if (config->dificuldade < 3) config->dificuldade++; break;
                     case 4: if (config->modulos_para_vencer < 50) config->modulos_para_vencer += 5; break;
@@ -115,6 +123,7 @@ bool loop_partida(void) {
     
     /* IMPORTANTE: flushinp aqui APENAS no inicio, nunca dentro do loop */
     flushinp(); 
+    display_zerar_estatisticas();
 
     while (jogo->executando) {
         EstadoJogo estado = jogo_obter_estado(jogo);
@@ -146,7 +155,18 @@ bool loop_partida(void) {
         display_tedax(jogo, linha);
         linha += ALTURA_TEDAX + 1;
         display_status(jogo, linha);
+        int linha_status = linha;
         linha += ALTURA_STATUS + 1;
+        /* Painel de mensagens so se couber com o comando; senao, a ultima vai no status */
+        if (LINES >= linha + ALTURA_MENSAGENS + 1 + ALTURA_COMANDO + 2) {
+            display_mensagens(jogo, linha);
+            linha += ALTURA_MENSAGENS + 1;
+        } else {
+            display_ultima_mensagem(jogo, linha_status);
+        }
+        /* A caixa de comando fica sempre visivel, mesmo em terminal baixo */
+        if (linha > LINES - (ALTURA_COMANDO + 2)) linha = LINES - (ALTURA_COMANDO + 2);
+        if (linha < 0) linha = 0;
         display_comando(jogo, linha);
 
         if (estado == JOGO_PAUSADO) {
@@ -155,6 +175,7 @@ bool loop_partida(void) {
             attroff(COLOR_PAIR(COR_ALERTA) | A_BOLD | A_BLINK);
         }
         refresh();
+        display_fechar_quadro();
         /* -------------------- */
 
         /* Leitura de Input - Loop para ler buffer rapido */
@@ -223,25 +244,274 @@ bool loop_partida(void) {
     return false;
 }
 
+void uso(const char* programa) {
+    fprintf(stderr, "Uso: %s [opcoes]\n", programa);
+    fprintf(stderr, "  --tedax N             Numero de tedax (o menu vai ate %d; aqui ate %d)\n", MAX_TEDAX_MENU,
+            MAX_TEDAX);
+    fprintf(stderr, "  --bancadas N          Numero de bancadas (o menu vai ate %d; aqui ate %d)\n", MAX_BANCADAS_MENU,
+            MAX_BANCADAS);
+    fprintf(stderr, "  --capacidade-fila N   Modulos pendentes que causam derrota (padrao %d)\n",
+            MAX_MODULOS_PENDENTES);
+    fprintf(stderr, "  --fila-crescente      Aloca a fila sob demanda ate a capacidade\n");
+    fprintf(stderr, "  --politica-fila P     fifo (mais antigo) ou edf (prazo mais proximo)\n");
+    fprintf(stderr, "  --seed N              Semente da geracao de modulos (reproduzivel)\n");
+    fprintf(stderr, "  --chegadas M          uniforme, poisson, rajadas ou trace\n");
+    fprintf(stderr, "  --taxa R              Modulos/min (poisson; calmaria em rajadas; padrao %.0f)\n",
+            TAXA_CHEGADA_PADRAO);
+    fprintf(stderr, "  --taxa-rajada R       Modulos/min durante as rajadas (padrao %.0f)\n",
+            TAXA_RAJADA_PADRAO);
+    fprintf(stderr, "  --rajada S            Duracao media das rajadas em segundos (padrao %.0f)\n",
+            DURACAO_RAJADA_PADRAO);
+    fprintf(stderr, "  --calmaria S          Duracao media das calmarias em segundos (padrao %.0f)\n",
+            DURACAO_CALMARIA_PADRAO);
+    fprintf(stderr, "  --trace ARQUIVO       Linhas 'instante tipo parametro' (implica --chegadas trace)\n");
+    fprintf(stderr, "  --tedax-autonomos     Tedax puxam modulos da fila (e roubam uns dos outros)\n");
+    fprintf(stderr, "  --tedax-pool [N]      Tedax como tarefas em N threads (padrao: numero de CPUs)\n");
+    fprintf(stderr, "  --piloto P            Piloto automatico no lugar do jogador: fifo, sjf ou carga\n");
+    fprintf(stderr, "  --sem-tela            Joga uma partida real sem ncurses (requer --piloto ou --tedax-autonomos)\n");
+    fprintf(stderr, "  --simular N           Joga N partidas em tempo virtual (piloto ou tedax autonomos) e sai\n");
+    fprintf(stderr, "  --afinidade P=CPUS    Fixa o papel P (interface, mural, timer, tedax, coordenador) nas CPUs (ex.: tedax=2-3)\n");
+}
+
+int processar_argumentos(int argc, char* argv[], ConfigJogo* config) {
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "--tedax") == 0 || strcmp(argv[i], "--bancadas") == 0) && i + 1 < argc) {
+            bool tedax = strcmp(argv[i], "--tedax") == 0;
+            int valor = atoi(argv[++i]);
+            int limite = tedax ? MAX_TEDAX : MAX_BANCADAS;
+            if (valor < 1 || valor > limite) {
+                fprintf(stderr, "Numero de %s invalido: %s (1 a %d)\n", tedax ? "tedax" : "bancadas", argv[i], limite);
+                return -1;
+            }
+            if (tedax) config->num_tedax = valor;
+            else config->num_bancadas = valor;
+        } else if (strcmp(argv[i], "--capacidade-fila") == 0 && i + 1 < argc) {
+            config->capacidade_fila = atoi(argv[++i]);
+            if (config->capacidade_fila < 1) {
+                fprintf(stderr, "Capacidade da fila invalida: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--fila-crescente") == 0) {
+            config->fila_crescente = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            char* fim;
+            config->semente = strtoull(argv[++i], &fim, 10);
+            if (*fim != '\0' || config->semente == 0) {
+                fprintf(stderr, "Semente invalida: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--chegadas") == 0 && i + 1 < argc) {
+            int modelo = chegadas_modelo_por_nome(argv[++i]);
+            if (modelo < 0) {
+                fprintf(stderr, "Modelo de chegada invalido: %s\n", argv[i]);
+                return -1;
+            }
+            config->modelo_chegada = modelo;
+        } else if ((strcmp(argv[i], "--taxa") == 0 || strcmp(argv[i], "--taxa-rajada") == 0 ||
+                    strcmp(argv[i], "--rajada") == 0 || strcmp(argv[i], "--calmaria") == 0) &&
+                   i + 1 < argc) {
+            const char* opcao = argv[i];
+            double valor = atof(argv[++i]);
+            if (valor <= 0) {
+                fprintf(stderr, "Valor invalido para %s: %s\n", opcao, argv[i]);
+                return -1;
+            }
+            if (strcmp(opcao, "--taxa") == 0) config->taxa_chegada = valor;
+            else if (strcmp(opcao, "--taxa-rajada") == 0) config->taxa_rajada = valor;
+            else if (strcmp(opcao, "--rajada") == 0) config->duracao_rajada = valor;
+            else config->duracao_calmaria = valor;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            strncpy(config->arquivo_trace, argv[++i], MAX_CAMINHO - 1);
+            config->arquivo_trace[MAX_CAMINHO - 1] = '\0';
+            config->modelo_chegada = CHEGADA_TRACE;
+        } else if (strcmp(argv[i], "--tedax-autonomos") == 0) {
+            config->tedax_autonomos = true;
+        } else if (strcmp(argv[i], "--tedax-pool") == 0) {
+            config->tedax_em_pool = true;
+            /* Numero de threads opcional */
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                config->trabalhadores_pool = atoi(argv[++i]);
+                if (config->trabalhadores_pool < 1) {
+                    fprintf(stderr, "Numero de threads do pool invalido: %s\n", argv[i]);
+                    return -1;
+                }
+            }
+        } else if (strcmp(argv[i], "--piloto") == 0 && i + 1 < argc) {
+            int politica = piloto_politica_por_nome(argv[++i]);
+            if (politica < 0) {
+                fprintf(stderr, "Politica do piloto invalida: %s (use fifo, sjf ou carga)\n", argv[i]);
+                return -1;
+            }
+            config->piloto = politica;
+        } else if (strcmp(argv[i], "--sem-tela") == 0) {
+            sem_tela = true;
+        } else if (strcmp(argv[i], "--simular") == 0 && i + 1 < argc) {
+            partidas_simuladas = atoi(argv[++i]);
+            if (partidas_simuladas < 1) {
+                fprintf(stderr, "Numero de partidas invalido: %s\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--afinidade") == 0 && i + 1 < argc) {
+            if (afinidade_ler(argv[++i], config) != 0) {
+                fprintf(stderr, "Afinidade invalida: %s (use papel=lista, ex.: tedax=2-3)\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--politica-fila") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "fifo") == 0) {
+                config->politica_fila = FILA_FIFO;
+            } else if (strcmp(argv[i], "edf") == 0) {
+                config->politica_fila = FILA_EDF;
+            } else {
+                fprintf(stderr, "Politica de fila invalida: %s\n", argv[i]);
+                return -1;
+            }
+        } else {
+            uso(argv[0]);
+            return -1;
+        }
+    }
+
+    if (config->piloto != PILOTO_DESLIGADO && config->tedax_autonomos) {
+        fprintf(stderr, "Use --piloto ou --tedax-autonomos, nao os dois\n");
+        return -1;
+    }
+    if (sem_tela && config->piloto == PILOTO_DESLIGADO && !config->tedax_autonomos) {
+        fprintf(stderr, "--sem-tela requer --piloto ou --tedax-autonomos (nao ha jogador)\n");
+        return -1;
+    }
+    if (config->modelo_chegada == CHEGADA_TRACE && access(config->arquivo_trace, R_OK) != 0) {
+        fprintf(stderr, "Modelo trace requer --trace com um arquivo legivel\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Partidas em tempo virtual com sementes consecutivas; imprime o resumo */
+int executar_simulacoes(ConfigJogo* config, int partidas) {
+    /* Sem jogador, desarma o piloto ou, sem ele, os tedax autonomos */
+    if (config->piloto == PILOTO_DESLIGADO) config->tedax_autonomos = true;
+    uint64_t semente = config->semente ? config->semente : aleatorio_semente_relogio();
+
+    int vitorias = 0, tempo_esgotado = 0, fila_cheia = 0;
+    long long desarmados = 0, gerados = 0;
+    long eventos = 0;
+    long long inicio = relogio_ns();
+
+    for (int i = 0; i < partidas && !sinal_recebido; i++) {
+        ResultadoSimulacao r;
+        if (simulacao_executar(config, semente + (uint64_t)i, &r) != 0) {
+            fprintf(stderr, "Falha ao preparar a simulacao (semente %llu)\n",
+                    (unsigned long long)(semente + (uint64_t)i));
+            return -1;
+        }
+        if (r.estado_final == JOGO_VITORIA) vitorias++;
+        else if (strncmp(r.motivo, "Fila cheia", 10) == 0) fila_cheia++;
+        else tempo_esgotado++;
+        desarmados += r.stats.modulos_desarmados;
+        gerados += r.stats.modulos_gerados;
+        eventos += r.eventos;
+
+        if (partidas <= 20) {
+            printf("semente %-20llu %-8s %4d s  gerados %3d  desarmados %3d  (%s)\n",
+                   (unsigned long long)r.semente, r.estado_final == JOGO_VITORIA ? "vitoria" : "derrota",
+                   r.segundos, r.stats.modulos_gerados, r.stats.modulos_desarmados, r.motivo);
+        }
+    }
+
+    double segundos = (relogio_ns() - inicio) / 1e9;
+    printf("%d partidas: %d vitorias, %d por tempo, %d por fila cheia\n",
+           partidas, vitorias, tempo_esgotado, fila_cheia);
+    printf("media: %.1f gerados, %.1f desarmados, %.0f eventos por partida\n",
+           (double)gerados / partidas, (double)desarmados / partidas, (double)eventos / partidas);
+    printf("%.3f s, %.0f partidas/s\n", segundos, segundos > 0 ? partidas / segundos : 0.0);
+    return 0;
+}
+
+/* Uma partida real sem ncurses; imprime o desfecho e a vazao */
+int executar_sem_tela(ConfigJogo* config) {
+    jogo = aligned_alloc(TAMANHO_LINHA_CACHE, sizeof(EstadoJogoCompleto));
+    if (!jogo) return -1;
+    if (jogo_init(jogo, config) != 0) {
+        free(jogo);
+        jogo = NULL;
+        return -1;
+    }
+    jogo->executando = true;
+    if (jogo_iniciar_partida(jogo) != 0) {
+        jogo_finalizar(jogo);
+        free(jogo);
+        jogo = NULL;
+        return -1;
+    }
+
+    EstadoJogo estado = jogo_obter_estado(jogo);
+    while (!sinal_recebido && (estado == JOGO_RODANDO || estado == JOGO_PAUSADO)) {
+        usleep(50000);
+        estado = jogo_obter_estado(jogo);
+    }
+    double segundos = (relogio_ns() - jogo->inicio_ns) / 1e9;
+    jogo_parar_partida(jogo);
+
+    Estatisticas contadores = jogo->stats;
+    jogo_somar_contadores(jogo, &contadores);
+    Estatisticas* st = &contadores;
+    printf("semente %-20llu %-8s %4d s  gerados %3d  desarmados %3d  falhas %d  (%s)\n",
+           (unsigned long long)jogo->semente, estado == JOGO_VITORIA ? "vitoria" : "derrota",
+           jogo->config.tempo_partida - st->tempo_restante, st->modulos_gerados, st->modulos_desarmados,
+           st->modulos_falhados, jogo->motivo_final[0] ? jogo->motivo_final : "interrompida");
+    for (int i = 0; i < jogo->config.num_tedax; i++) {
+        Tedax* t = &jogo->tedax[i];
+        printf("  tedax %d: %d desarmados, ocioso %.2f s em media entre tarefas\n", i + 1,
+               atomic_load_explicit(&t->modulos_desarmados, memory_order_relaxed),
+               t->trocas > 0 ? t->ocioso_ns / 1e9 / t->trocas : 0.0);
+    }
+    printf("piloto %s: %.3f modulos desarmados/s em %.1f s\n", piloto_nome_politica(jogo->config.piloto),
+           segundos > 0 ? st->modulos_desarmados / segundos : 0.0, segundos);
+
+    jogo_finalizar(jogo);
+    free(jogo);
+    jogo = NULL;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
-    (void)argc; (void)argv;
+    ConfigJogo config = config_padrao();
+    if (processar_argumentos(argc, argv, &config) != 0) {
+        return 1;
+    }
 
     signal(SIGINT, handler_sinal);
     signal(SIGTERM, handler_sinal);
-    srand(time(NULL));
+
+    if (partidas_simuladas > 0) {
+        return executar_simulacoes(&config, partidas_simuladas) == 0 ? 0 : 1;
+    }
+
+    /* Relatorio antes do ncurses (redirecione stderr para guarda-lo); a principal mantem o nome do processo */
+    for (int papel = 0; papel < PAPEL_TOTAL; papel++) {
+        if (config.afinidade[papel]) {
+            afinidade_relatorio(stderr, &config);
+            break;
+        }
+    }
+    afinidade_aplicar(pthread_self(), &config, PAPEL_INTERFACE, NULL);
+
+    if (sem_tela) {
+        return executar_sem_tela(&config) == 0 ? 0 : 1;
+    }
 
     if (display_init() != 0) {
         fprintf(stderr, "Erro ncurses!\n");
         return 1;
     }
 
-    jogo = malloc(sizeof(EstadoJogoCompleto));
+    jogo = aligned_alloc(TAMANHO_LINHA_CACHE, sizeof(EstadoJogoCompleto));
     if (!jogo) {
         display_finalizar();
         return 1;
     }
 
-    ConfigJogo config = config_padrao();
     if (jogo_init(jogo, &config) != 0) {
         free(jogo);
         display_finalizar();
@@ -0,0 +1,69 @@
+/*
+ * metricas.c - Relogio monotonico e histogramas logaritmicos de latencia
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#include "../include/metricas.h"
+#include <string.h>
+#include <time.h>
+
+long long relogio_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+struct timespec timespec_de_ns(long long ns) {
+    struct timespec ts;
+    ts.tv_sec = ns / 1000000000LL;
+    ts.tv_nsec = ns % 1000000000LL;
+    return ts;
+}
+
+void histograma_zerar(HistogramaLatencia* histograma) {
+    if (!histograma) return;
+    memset(histograma, 0, sizeof(HistogramaLatencia));
+}
+
+/* Balde: expoente de 2 mais os 2 bits seguintes ao bit mais alto */
+static int balde_de(unsigned long long ns) {
+    if (ns < SUBBALDES_HISTOGRAMA) return (int)ns;
+    int expoente = 63 - __builtin_clzll(ns);
+    int sub = (int)((ns >> (expoente - 2)) & (SUBBALDES_HISTOGRAMA - 1));
+    int b = (expoente - 1) * SUBBALDES_HISTOGRAMA + sub;
+    return b < BALDES_HISTOGRAMA ? b : BALDES_HISTOGRAMA - 1;
+}
+
+/* Maior valor que cai no balde b */
+static long long limite_do_balde(int b) {
+    if (b < SUBBALDES_HISTOGRAMA) return b;
+    int expoente = b / SUBBALDES_HISTOGRAMA + 1;
+    int sub = b % SUBBALDES_HISTOGRAMA;
+    return (long long)(((unsigned long long)(SUBBALDES_HISTOGRAMA + sub + 1) << (expoente - 2)) - 1);
+}
+
+void histograma_registrar(HistogramaLatencia* histograma, long long ns) {
+    if (!histograma) return;
+    histograma->baldes[balde_de(ns > 0 ? (unsigned long long)ns : 0)]++;
+    histograma->total++;
+}
+
+void histograma_somar(HistogramaLatencia* destino, const HistogramaLatencia* origem) {
+    if (!destino || !origem) return;
+    for (int b = 0; b < BALDES_HISTOGRAMA; b++) destino->baldes[b] += origem->baldes[b];
+    destino->total += origem->total;
+}
+
+long long histograma_percentil(const HistogramaLatencia* histograma, double p) {
+    if (!histograma || histograma->total == 0) return 0;
+
+    long alvo = (long)(p / 100.0 * histograma->total + 0.5);
+    if (alvo < 1) alvo = 1;
+
+    long acumulado = 0;
+    for (int b = 0; b < BALDES_HISTOGRAMA; b++) {
+        acumulado += histograma->baldes[b];
+        if (acumulado >= alvo) return limite_do_balde(b);
+    }
+    return limite_do_balde(BALDES_HISTOGRAMA - 1);
+}
@@ -4,12 +4,18 @@
  */
 
 #include "../include/modulos.h"
+#include "../include/fila_mpmc.h"
+#include "../include/pool_modulos.h"
+#include "../include/chegadas.h"
+#include "../include/metricas.h"
 #include "../include/jogo.h"
+#include "../include/instrucao.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <errno.h>
 
 /* Nomes dos tipos de modulos */
 static const char* nomes_modulos[] = {
@@ -22,159 +28,605 @@ static const char* nomes_modulos[] = {
 /* Caracteres identificadores */
 static const char chars_modulos[] = {'f', 'b', 's', 'i'};
 
-void fila_modulos_init(FilaModulos* fila) {
-    if (!fila) return;
+/* Menor potencia de 2 maior ou igual a n */
+static int proxima_potencia_2(int n) {
+    int p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
 
-    fila->inicio = 0;
-    fila->fim = 0;
-    fila->quantidade = 0;
+/* Encadeia os nos [de, ate) na lista de livres */
+static void fila_modulos_encadear_livres(FilaModulos* fila, int de, int ate) {
+    for (int i = de; i < ate; i++) {
+        fila->nos[i].prox = (i + 1 < ate) ? i + 1 : fila->livre;
+    }
+    if (de < ate) fila->livre = de;
+}
 
-    pthread_mutex_init(&fila->mutex, NULL);
-    pthread_cond_init(&fila->cond_nao_vazia, NULL);
-    pthread_cond_init(&fila->cond_nao_cheia, NULL);
+int fila_modulos_init(FilaModulos* fila, int capacidade, bool crescente, PoliticaFila politica) {
+    if (!fila || capacidade < 1) return -1;
+
+    memset(fila, 0, sizeof(FilaModulos));
+
+    int cap_entrada = proxima_potencia_2(capacidade);
+    if (cap_entrada < 2) cap_entrada = 2;
+    if (cap_entrada > CAPACIDADE_ENTRADA_MAX) cap_entrada = CAPACIDADE_ENTRADA_MAX;
 
-    memset(fila->modulos, 0, sizeof(fila->modulos));
+    int cap_nos = proxima_potencia_2(capacidade);
+    if (crescente && cap_nos > CAPACIDADE_NOS_INICIAL) cap_nos = CAPACIDADE_NOS_INICIAL;
+
+    fila->politica = politica;
+    fila->slots_entrada = malloc(sizeof(SlotFilaMPMC) * cap_entrada);
+    fila->nos = malloc(sizeof(NoFila) * cap_nos);
+    fila->indice_id = malloc(sizeof(int) * cap_nos * 2);
+    bool ok = fila->slots_entrada && fila->nos && fila->indice_id;
+    if (politica == FILA_EDF) {
+        for (int t = 0; t < MODULO_TOTAL; t++) {
+            fila->heap[t] = malloc(sizeof(int) * cap_nos);
+            ok = ok && fila->heap[t];
+        }
+    }
+    if (!ok) {
+        fila_modulos_destroy(fila);
+        return -1;
+    }
+
+    fila_mpmc_init(&fila->entrada, fila->slots_entrada, cap_entrada);
+
+    fila->capacidade_nos = cap_nos;
+    fila->limite = capacidade;
+    fila->crescente = crescente;
+    fila->livre = -1;
+    fila_modulos_encadear_livres(fila, 0, cap_nos);
+    fila->mascara_indice = cap_nos * 2 - 1;
+    for (int i = 0; i <= fila->mascara_indice; i++) fila->indice_id[i] = INDICE_VAZIO;
+    fila->primeiro = -1;
+    fila->ultimo = -1;
+    for (int t = 0; t < MODULO_TOTAL; t++) {
+        fila->primeiro_tipo[t] = -1;
+        fila->ultimo_tipo[t] = -1;
+    }
+    fila->consolidados = 0;
+    atomic_init(&fila->quantidade, 0);
+    atomic_init(&fila->aguardando_item, 0);
+    fila->despertares = 0;
+
+    /* Relogio monotonico: as esperas nao saltam com ajustes de hora */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&fila->mutex, NULL);
+    pthread_cond_init(&fila->cond_nao_vazia, &attr);
+    pthread_cond_init(&fila->cond_nao_cheia, &attr);
+    pthread_condattr_destroy(&attr);
+    return 0;
 }
 
 void fila_modulos_destroy(FilaModulos* fila) {
     if (!fila) return;
 
+    free(fila->slots_entrada);
+    free(fila->nos);
+    free(fila->indice_id);
+    fila->slots_entrada = NULL;
+    fila->nos = NULL;
+    fila->indice_id = NULL;
+    for (int t = 0; t < MODULO_TOTAL; t++) {
+        free(fila->heap[t]);
+        fila->heap[t] = NULL;
+    }
+
     pthread_mutex_destroy(&fila->mutex);
     pthread_cond_destroy(&fila->cond_nao_vazia);
     pthread_cond_destroy(&fila->cond_nao_cheia);
 }
 
-bool fila_modulos_adicionar(FilaModulos* fila, Modulo* modulo) {
-    if (!fila || !modulo) return false;
+/* ---- Indice ID -> no. Todas requerem o mutex. ---- */
 
-    pthread_mutex_lock(&fila->mutex);
+static int indice_posicao(FilaModulos* fila, int id) {
+    return (int)(((unsigned)id * 2654435761u) & (unsigned)fila->mascara_indice);
+}
 
-    if (fila->quantidade >= MAX_MODULOS_PENDENTES) {
-        pthread_mutex_unlock(&fila->mutex);
-        return false;
+static void indice_inserir(FilaModulos* fila, int n) {
+    int p = indice_posicao(fila, fila->nos[n].id);
+    while (fila->indice_id[p] >= 0) p = (p + 1) & fila->mascara_indice;
+    if (fila->indice_id[p] == INDICE_LAPIDE) fila->lapides--;
+    fila->indice_id[p] = n;
+}
+
+/* Posicao do no de um ID no indice, ou -1 */
+static int indice_buscar(FilaModulos* fila, int id) {
+    int p = indice_posicao(fila, id);
+    while (fila->indice_id[p] != INDICE_VAZIO) {
+        int n = fila->indice_id[p];
+        if (n >= 0 && fila->nos[n].id == id) return p;
+        p = (p + 1) & fila->mascara_indice;
     }
+    return -1;
+}
+
+/* Refaz o indice a partir da lista global, descartando as lapides */
+static void indice_reconstruir(FilaModulos* fila) {
+    for (int i = 0; i <= fila->mascara_indice; i++) fila->indice_id[i] = INDICE_VAZIO;
+    fila->lapides = 0;
+    for (int n = fila->primeiro; n >= 0; n = fila->nos[n].prox) indice_inserir(fila, n);
+}
+
+static void indice_remover(FilaModulos* fila, int n) {
+    /* IDs podem repetir (modulo devolvido a fila): procura o proprio no */
+    int p = indice_posicao(fila, fila->nos[n].id);
+    while (fila->indice_id[p] != n) p = (p + 1) & fila->mascara_indice;
+    fila->indice_id[p] = INDICE_LAPIDE;
+    if (++fila->lapides > (fila->mascara_indice + 1) / 4) indice_reconstruir(fila);
+}
 
-    /* Copia o modulo para a fila */
-    memcpy(&fila->modulos[fila->fim], modulo, sizeof(Modulo));
-    fila->fim = (fila->fim + 1) % MAX_MODULOS_PENDENTES;
-    fila->quantidade++;
+/* Dobra o vetor de nos (modo crescente). Requer o mutex. */
+static bool fila_modulos_crescer(FilaModulos* fila) {
+    if (!fila->crescente) return false;
 
-    /* Sinaliza que a fila nao esta mais vazia */
-    pthread_cond_signal(&fila->cond_nao_vazia);
+    int nova = fila->capacidade_nos * 2;
+    if (nova > proxima_potencia_2(fila->limite)) return false;
 
-    pthread_mutex_unlock(&fila->mutex);
+    /* Os nos sao referenciados por indice, entao realloc e seguro */
+    NoFila* nos = realloc(fila->nos, sizeof(NoFila) * nova);
+    if (!nos) return false;
+
+    fila->nos = nos;
+
+    int* indice = realloc(fila->indice_id, sizeof(int) * nova * 2);
+    if (!indice) return false;
+    fila->indice_id = indice;
+
+    if (fila->politica == FILA_EDF) {
+        for (int t = 0; t < MODULO_TOTAL; t++) {
+            int* heap = realloc(fila->heap[t], sizeof(int) * nova);
+            if (!heap) return false;
+            fila->heap[t] = heap;
+        }
+    }
+
+    fila_modulos_encadear_livres(fila, fila->capacidade_nos, nova);
+    fila->capacidade_nos = nova;
+    fila->mascara_indice = nova * 2 - 1;
+    indice_reconstruir(fila);
     return true;
 }
 
-bool fila_modulos_remover(FilaModulos* fila, Modulo* modulo) {
-    if (!fila || !modulo) return false;
+/* Retira um no da lista de livres, crescendo se preciso. Requer o mutex. */
+static int fila_modulos_alocar_no(FilaModulos* fila) {
+    if (fila->livre < 0 && !fila_modulos_crescer(fila)) return -1;
+    int n = fila->livre;
+    fila->livre = fila->nos[n].prox;
+    return n;
+}
 
-    pthread_mutex_lock(&fila->mutex);
+/* ---- Heap de prazos por tipo (modo EDF). Todas requerem o mutex. ---- */
+
+/* true se o no 'a' e mais urgente que o no 'b' */
+static bool no_mais_urgente(FilaModulos* fila, int a, int b) {
+    NoFila* na = &fila->nos[a];
+    NoFila* nb = &fila->nos[b];
+    if (na->prazo != nb->prazo) return na->prazo < nb->prazo;
+    return na->ordem < nb->ordem;
+}
+
+static void heap_colocar(FilaModulos* fila, int tipo, int pos, int n) {
+    fila->heap[tipo][pos] = n;
+    fila->nos[n].pos_heap = pos;
+}
+
+static void heap_subir(FilaModulos* fila, int tipo, int pos) {
+    int n = fila->heap[tipo][pos];
+    while (pos > 0) {
+        int pai = (pos - 1) / 2;
+        if (!no_mais_urgente(fila, n, fila->heap[tipo][pai])) break;
+        heap_colocar(fila, tipo, pos, fila->heap[tipo][pai]);
+        pos = pai;
+    }
+    heap_colocar(fila, tipo, pos, n);
+}
+
+static void heap_descer(FilaModulos* fila, int tipo, int pos) {
+    int tam = fila->tam_heap[tipo];
+    int n = fila->heap[tipo][pos];
+    for (;;) {
+        int filho = 2 * pos + 1;
+        if (filho >= tam) break;
+        if (filho + 1 < tam &&
+            no_mais_urgente(fila, fila->heap[tipo][filho + 1], fila->heap[tipo][filho])) {
+            filho++;
+        }
+        if (!no_mais_urgente(fila, fila->heap[tipo][filho], n)) break;
+        heap_colocar(fila, tipo, pos, fila->heap[tipo][filho]);
+        pos = filho;
+    }
+    heap_colocar(fila, tipo, pos, n);
+}
+
+static void heap_inserir(FilaModulos* fila, int tipo, int n) {
+    int pos = fila->tam_heap[tipo]++;
+    heap_colocar(fila, tipo, pos, n);
+    heap_subir(fila, tipo, pos);
+}
+
+static void heap_remover(FilaModulos* fila, int tipo, int pos) {
+    int ultimo = --fila->tam_heap[tipo];
+    if (pos == ultimo) return;
+    heap_colocar(fila, tipo, pos, fila->heap[tipo][ultimo]);
+    heap_subir(fila, tipo, pos);
+    heap_descer(fila, tipo, fila->nos[fila->heap[tipo][pos]].pos_heap);
+}
+
+/* Liga um no livre ao fim da lista global e da lista do seu tipo. Requer o mutex. */
+static void fila_modulos_ligar(FilaModulos* fila, int n) {
+    NoFila* no = &fila->nos[n];
+    Modulo* m = pool_modulos_obter(no->modulo);
+    int tipo = m->tipo;
+
+    no->tipo = tipo;
+    no->id = m->id;
+    no->ordem = fila->proxima_ordem++;
+    no->ant = fila->ultimo;
+    no->prox = -1;
+    if (fila->ultimo >= 0) fila->nos[fila->ultimo].prox = n;
+    else fila->primeiro = n;
+    fila->ultimo = n;
+
+    no->ant_tipo = fila->ultimo_tipo[tipo];
+    no->prox_tipo = -1;
+    if (fila->ultimo_tipo[tipo] >= 0) fila->nos[fila->ultimo_tipo[tipo]].prox_tipo = n;
+    else fila->primeiro_tipo[tipo] = n;
+    fila->ultimo_tipo[tipo] = n;
+
+    if (fila->politica == FILA_EDF) {
+        no->prazo = modulo_prazo(m);
+        heap_inserir(fila, tipo, n);
+    }
+    indice_inserir(fila, n);
+
+    fila->consolidados++;
+}
+
+/*
+ * Transfere os modulos publicados na entrada para os nos. Deve ser
+ * chamada com fila->mutex travado. Como 'quantidade' limita o total a
+ * 'limite', sempre ha (ou pode ser alocado) um no para cada publicado.
+ */
+static void fila_modulos_consolidar(FilaModulos* fila) {
+    while (atomic_load(&fila->quantidade) > fila->consolidados) {
+        if (fila->livre < 0 && !fila_modulos_crescer(fila)) break;
+        if (!fila_mpmc_desenfileirar(&fila->entrada, &fila->nos[fila->livre].modulo)) break;
+        fila_modulos_ligar(fila, fila_modulos_alocar_no(fila));
+    }
+}
+
+/*
+ * Desliga o no das duas listas, entrega o handle e devolve o no. Requer o
+ * mutex; o chamador sinaliza cond_nao_cheia (ainda com o mutex) depois de
+ * retirar o lote.
+ */
+static void fila_modulos_retirar_no(FilaModulos* fila, int n, ModuloHandle* modulo) {
+    NoFila* no = &fila->nos[n];
+    int tipo = no->tipo;
+
+    *modulo = no->modulo;
+
+    if (no->ant >= 0) fila->nos[no->ant].prox = no->prox;
+    else fila->primeiro = no->prox;
+    if (no->prox >= 0) fila->nos[no->prox].ant = no->ant;
+    else fila->ultimo = no->ant;
+
+    if (no->ant_tipo >= 0) fila->nos[no->ant_tipo].prox_tipo = no->prox_tipo;
+    else fila->primeiro_tipo[tipo] = no->prox_tipo;
+    if (no->prox_tipo >= 0) fila->nos[no->prox_tipo].ant_tipo = no->ant_tipo;
+    else fila->ultimo_tipo[tipo] = no->ant_tipo;
+
+    if (fila->politica == FILA_EDF) heap_remover(fila, tipo, no->pos_heap);
+    indice_remover(fila, n);
+
+    no->prox = fila->livre;
+    fila->livre = n;
+    fila->consolidados--;
+    atomic_fetch_sub(&fila->quantidade, 1);
+}
+
+/* Proximo no a sair segundo a politica (-1 se vazia). Requer o mutex. */
+static int fila_modulos_proximo(FilaModulos* fila) {
+    if (fila->politica != FILA_EDF) return fila->primeiro;
+
+    /* O mais urgente de todos e o mais urgente entre os topos dos heaps */
+    int n = -1;
+    for (int t = 0; t < MODULO_TOTAL; t++) {
+        if (fila->tam_heap[t] == 0) continue;
+        int topo = fila->heap[t][0];
+        if (n < 0 || no_mais_urgente(fila, topo, n)) n = topo;
+    }
+    return n;
+}
 
-    if (fila->quantidade == 0) {
+int fila_modulos_adicionar_lote(FilaModulos* fila, const ModuloHandle* modulos, int n) {
+    if (!fila || !modulos || n <= 0) return 0;
+
+    /* Reserva as vagas do lote inteiro com um unico CAS */
+    int qtd = atomic_load(&fila->quantidade);
+    int k;
+    do {
+        k = fila->limite - qtd;
+        if (k <= 0) return 0;
+        if (k > n) k = n;
+    } while (!atomic_compare_exchange_weak(&fila->quantidade, &qtd, qtd + k));
+
+    /* Marca a entrada na fila (uma leitura do relogio por lote) */
+    long long agora = relogio_ns();
+    for (int i = 0; i < k; i++) {
+        Modulo* m = pool_modulos_obter(modulos[i]);
+        if (m) m->enfileirado_ns = agora;
+    }
+
+    int publicados = 0;
+    while (publicados < k && fila_mpmc_enfileirar(&fila->entrada, modulos[publicados])) {
+        publicados++;
+    }
+
+    if (publicados < k) {
+        /*
+         * Entrada lotada (fila maior que CAPACIDADE_ENTRADA_MAX, ou um
+         * consumidor ainda liberando o slot): insere o resto direto nos
+         * nos, depois de transferir o que ja foi publicado.
+         */
+        pthread_mutex_lock(&fila->mutex);
+        fila_modulos_consolidar(fila);
+        for (; publicados < k; publicados++) {
+            int no = fila_modulos_alocar_no(fila);
+            if (no < 0) break;
+            fila->nos[no].modulo = modulos[publicados];
+            fila_modulos_ligar(fila, no);
+        }
+
+        /* Devolve as vagas reservadas que nao foram usadas, ainda sob o mutex */
+        if (publicados < k) {
+            atomic_fetch_sub(&fila->quantidade, k - publicados);
+            fila->despertares++;
+            pthread_cond_broadcast(&fila->cond_nao_cheia);
+        }
         pthread_mutex_unlock(&fila->mutex);
-        return false;
     }
 
-    /* Copia o modulo do inicio */
-    memcpy(modulo, &fila->modulos[fila->inicio], sizeof(Modulo));
-    fila->inicio = (fila->inicio + 1) % MAX_MODULOS_PENDENTES;
-    fila->quantidade--;
+    /*
+     * Sinaliza que a fila nao esta mais vazia. O caminho rapido nao toma o
+     * mutex: quem espera incrementa aguardando_item antes de testar a
+     * quantidade, e aqui a quantidade ja foi incrementada antes de ler
+     * aguardando_item, entao ao menos um dos lados ve o outro. Tomar o
+     * mutex garante que a espera ja esta dentro do pthread_cond_wait.
+     */
+    if (publicados > 0 && atomic_load(&fila->aguardando_item) > 0) {
+        pthread_mutex_lock(&fila->mutex);
+        if (publicados == 1) pthread_cond_signal(&fila->cond_nao_vazia);
+        else pthread_cond_broadcast(&fila->cond_nao_vazia);
+        pthread_mutex_unlock(&fila->mutex);
+    }
+    return publicados;
+}
+
+int fila_modulos_remover_lote(FilaModulos* fila, ModuloHandle* destino, int max) {
+    if (!fila || !destino || max <= 0) return 0;
+
+    pthread_mutex_lock(&fila->mutex);
+    fila_modulos_consolidar(fila);
+
+    int qtd = 0;
+    int n;
+    while (qtd < max && (n = fila_modulos_proximo(fila)) >= 0) {
+        fila_modulos_retirar_no(fila, n, &destino[qtd++]);
+    }
 
     /* Sinaliza que a fila nao esta mais cheia */
-    pthread_cond_signal(&fila->cond_nao_cheia);
+    if (qtd == 1) pthread_cond_signal(&fila->cond_nao_cheia);
+    else if (qtd > 1) pthread_cond_broadcast(&fila->cond_nao_cheia);
 
     pthread_mutex_unlock(&fila->mutex);
-    return true;
+    return qtd;
 }
 
-bool fila_modulos_remover_por_id(FilaModulos* fila, int id, Modulo* modulo) {
-    if (!fila || !modulo) return false;
+int fila_modulos_limpar(FilaModulos* fila) {
+    if (!fila) return 0;
 
     pthread_mutex_lock(&fila->mutex);
+    fila_modulos_consolidar(fila);
 
-    if (fila->quantidade == 0) {
-        pthread_mutex_unlock(&fila->mutex);
-        return false;
+    /* Devolve todos os modulos e reencadeia os nos de uma vez */
+    int qtd = 0;
+    for (int n = fila->primeiro; n >= 0; n = fila->nos[n].prox) {
+        pool_modulos_liberar(fila->nos[n].modulo);
+        qtd++;
     }
 
-    /* Procura o modulo pelo ID */
-    int encontrado = -1;
-    for (int i = 0; i < fila->quantidade; i++) {
-        int idx = (fila->inicio + i) % MAX_MODULOS_PENDENTES;
-        if (fila->modulos[idx].id == id) {
-            encontrado = i;
-            memcpy(modulo, &fila->modulos[idx], sizeof(Modulo));
-            break;
-        }
+    fila->livre = -1;
+    fila_modulos_encadear_livres(fila, 0, fila->capacidade_nos);
+    fila->primeiro = -1;
+    fila->ultimo = -1;
+    for (int t = 0; t < MODULO_TOTAL; t++) {
+        fila->primeiro_tipo[t] = -1;
+        fila->ultimo_tipo[t] = -1;
+        fila->tam_heap[t] = 0;
     }
+    indice_reconstruir(fila);
+    fila->consolidados -= qtd;
+    atomic_fetch_sub(&fila->quantidade, qtd);
 
-    if (encontrado == -1) {
-        pthread_mutex_unlock(&fila->mutex);
-        return false;
+    if (qtd > 0) pthread_cond_broadcast(&fila->cond_nao_cheia);
+
+    pthread_mutex_unlock(&fila->mutex);
+    return qtd;
+}
+
+bool fila_modulos_adicionar(FilaModulos* fila, ModuloHandle modulo) {
+    if (modulo == MODULO_HANDLE_NULO) return false;
+    return fila_modulos_adicionar_lote(fila, &modulo, 1) == 1;
+}
+
+bool fila_modulos_remover(FilaModulos* fila, ModuloHandle* modulo) {
+    return fila_modulos_remover_lote(fila, modulo, 1) == 1;
+}
+
+/* Prazo absoluto no relogio monotonico para uma espera de timeout_ms */
+static struct timespec prazo_espera(int timeout_ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
     }
+    return ts;
+}
+
+bool fila_modulos_aguardar_item(FilaModulos* fila, int timeout_ms) {
+    if (!fila) return false;
+    if (atomic_load(&fila->quantidade) > 0) return true;
+
+    struct timespec limite = prazo_espera(timeout_ms);
+    int ret = 0;
 
-    /* Remove o modulo, movendo os posteriores */
-    for (int i = encontrado; i < fila->quantidade - 1; i++) {
-        int idx_atual = (fila->inicio + i) % MAX_MODULOS_PENDENTES;
-        int idx_prox = (fila->inicio + i + 1) % MAX_MODULOS_PENDENTES;
-        memcpy(&fila->modulos[idx_atual], &fila->modulos[idx_prox], sizeof(Modulo));
+    pthread_mutex_lock(&fila->mutex);
+    unsigned despertar = fila->despertares;
+    atomic_fetch_add(&fila->aguardando_item, 1);
+    while (atomic_load(&fila->quantidade) == 0 && despertar == fila->despertares &&
+           ret != ETIMEDOUT) {
+        if (timeout_ms <= 0) pthread_cond_wait(&fila->cond_nao_vazia, &fila->mutex);
+        else ret = pthread_cond_timedwait(&fila->cond_nao_vazia, &fila->mutex, &limite);
     }
+    atomic_fetch_sub(&fila->aguardando_item, 1);
+    bool ha_item = atomic_load(&fila->quantidade) > 0;
+    pthread_mutex_unlock(&fila->mutex);
 
-    fila->fim = (fila->fim - 1 + MAX_MODULOS_PENDENTES) % MAX_MODULOS_PENDENTES;
-    fila->quantidade--;
+    return ha_item;
+}
 
-    pthread_cond_signal(&fila->cond_nao_cheia);
+bool fila_modulos_aguardar_espaco(FilaModulos* fila, int timeout_ms) {
+    if (!fila) return false;
+    if (atomic_load(&fila->quantidade) < fila->limite) return true;
 
+    struct timespec limite = prazo_espera(timeout_ms);
+    int ret = 0;
+
+    /* As vagas so abrem sob o mutex (consumidores e sobras de lote), entao nao ha corrida */
+    pthread_mutex_lock(&fila->mutex);
+    unsigned despertar = fila->despertares;
+    while (atomic_load(&fila->quantidade) >= fila->limite && despertar == fila->despertares &&
+           ret != ETIMEDOUT) {
+        if (timeout_ms <= 0) pthread_cond_wait(&fila->cond_nao_cheia, &fila->mutex);
+        else ret = pthread_cond_timedwait(&fila->cond_nao_cheia, &fila->mutex, &limite);
+    }
+    bool ha_vaga = atomic_load(&fila->quantidade) < fila->limite;
     pthread_mutex_unlock(&fila->mutex);
-    return true;
+
+    return ha_vaga;
 }
 
-bool fila_modulos_obter(FilaModulos* fila, int indice, Modulo* modulo) {
-    if (!fila || !modulo || indice < 0) return false;
+void fila_modulos_despertar(FilaModulos* fila) {
+    if (!fila) return;
 
     pthread_mutex_lock(&fila->mutex);
+    fila->despertares++;
+    pthread_cond_broadcast(&fila->cond_nao_vazia);
+    pthread_cond_broadcast(&fila->cond_nao_cheia);
+    pthread_mutex_unlock(&fila->mutex);
+}
 
-    if (indice >= fila->quantidade) {
-        pthread_mutex_unlock(&fila->mutex);
-        return false;
-    }
+bool fila_modulos_remover_por_id(FilaModulos* fila, int id, ModuloHandle* modulo) {
+    if (!fila || !modulo) return false;
+
+    pthread_mutex_lock(&fila->mutex);
+    fila_modulos_consolidar(fila);
 
-    int idx = (fila->inicio + indice) % MAX_MODULOS_PENDENTES;
-    memcpy(modulo, &fila->modulos[idx], sizeof(Modulo));
+    /* O indice leva direto ao no; as listas intrusivas o desligam em O(1) */
+    int p = indice_buscar(fila, id);
+    if (p >= 0) {
+        fila_modulos_retirar_no(fila, fila->indice_id[p], modulo);
+        pthread_cond_signal(&fila->cond_nao_cheia);
+    }
 
     pthread_mutex_unlock(&fila->mutex);
-    return true;
+    return p >= 0;
 }
 
-bool fila_modulos_vazia(FilaModulos* fila) {
-    if (!fila) return true;
+bool fila_modulos_remover_por_tipo(FilaModulos* fila, TipoModulo tipo, ModuloHandle* modulo) {
+    if (!fila || !modulo || tipo < 0 || tipo >= MODULO_TOTAL) return false;
 
     pthread_mutex_lock(&fila->mutex);
-    bool vazia = (fila->quantidade == 0);
+    fila_modulos_consolidar(fila);
+
+    /* O mais antigo do tipo e a cabeca da lista; o mais urgente, o topo do heap */
+    int n = fila->primeiro_tipo[tipo];
+    if (fila->politica == FILA_EDF) {
+        n = fila->tam_heap[tipo] > 0 ? fila->heap[tipo][0] : -1;
+    }
+    if (n >= 0) {
+        fila_modulos_retirar_no(fila, n, modulo);
+        pthread_cond_signal(&fila->cond_nao_cheia);
+    }
+
     pthread_mutex_unlock(&fila->mutex);
+    return n >= 0;
+}
 
-    return vazia;
+bool fila_modulos_obter(FilaModulos* fila, int indice, Modulo* modulo) {
+    if (!fila || !modulo || indice < 0) return false;
+
+    pthread_mutex_lock(&fila->mutex);
+    fila_modulos_consolidar(fila);
+
+    int n = fila->primeiro;
+    for (int i = 0; i < indice && n >= 0; i++) {
+        n = fila->nos[n].prox;
+    }
+    if (n >= 0) memcpy(modulo, pool_modulos_obter(fila->nos[n].modulo), sizeof(Modulo));
+
+    pthread_mutex_unlock(&fila->mutex);
+    return n >= 0;
 }
 
-bool fila_modulos_cheia(FilaModulos* fila) {
-    if (!fila) return true;
+int fila_modulos_listar(FilaModulos* fila, Modulo* destino, int max) {
+    if (!fila || !destino || max <= 0) return 0;
 
     pthread_mutex_lock(&fila->mutex);
-    bool cheia = (fila->quantidade >= MAX_MODULOS_PENDENTES);
+    fila_modulos_consolidar(fila);
+
+    int qtd = 0;
+    for (int n = fila->primeiro; n >= 0 && qtd < max; n = fila->nos[n].prox) {
+        memcpy(&destino[qtd++], pool_modulos_obter(fila->nos[n].modulo), sizeof(Modulo));
+    }
+
     pthread_mutex_unlock(&fila->mutex);
+    return qtd;
+}
 
-    return cheia;
+bool fila_modulos_vazia(FilaModulos* fila) {
+    if (!fila) return true;
+    return atomic_load(&fila->quantidade) == 0;
+}
+
+bool fila_modulos_cheia(FilaModulos* fila) {
+    if (!fila) return true;
+    return atomic_load(&fila->quantidade) >= fila->limite;
 }
 
 int fila_modulos_quantidade(FilaModulos* fila) {
     if (!fila) return 0;
+    return atomic_load(&fila->quantidade);
+}
 
-    pthread_mutex_lock(&fila->mutex);
-    int qtd = fila->quantidade;
-    pthread_mutex_unlock(&fila->mutex);
+int fila_modulos_capacidade(FilaModulos* fila) {
+    if (!fila) return 0;
+    return fila->limite;
+}
 
-    return qtd;
+time_t modulo_prazo(const Modulo* modulo) {
+    if (!modulo) return 0;
+    int dificuldade = modulo->dificuldade > 0 ? modulo->dificuldade : 1;
+    return modulo->criado_em + FOLGA_PRAZO_BASE / dificuldade + modulo->tempo_resolucao;
 }
 
 const char* nome_tipo_modulo(TipoModulo tipo) {
@@ -200,12 +652,23 @@ TipoModulo tipo_modulo_por_char(char c) {
     return -1;
 }
 
-Modulo gerar_modulo_aleatorio(int id, int dificuldade) {
+void gerar_modulo_aleatorio(GeradorAleatorio* gerador, Modulo* modulo, int id, int dificuldade) {
+    if (!gerador || !modulo) return;
+    gerar_modulo(gerador, modulo, id, dificuldade, aleatorio_intervalo(gerador, MODULO_TOTAL), 0);
+}
+
+void gerar_modulo(GeradorAleatorio* gerador, Modulo* modulo, int id, int dificuldade,
+                  TipoModulo tipo, int parametro) {
+    if (!gerador || !modulo) return;
     Modulo m;
     memset(&m, 0, sizeof(Modulo));
 
+    /* Parametro forcado (trace) limitado ao tamanho da instrucao */
+    if (parametro > MAX_SIMBOLOS_INSTRUCAO) parametro = MAX_SIMBOLOS_INSTRUCAO;
+    int valores[MAX_SIMBOLOS_INSTRUCAO] = { 0 };
+
     m.id = id;
-    m.tipo = rand() % MODULO_TOTAL;
+    m.tipo = tipo;
     m.dificuldade = dificuldade;
     m.resolvido = false;
     m.tentativas = 0;
@@ -214,123 +677,163 @@ Modulo gerar_modulo_aleatorio(int id, int dificuldade) {
     /* Configura baseado no tipo */
     switch (m.tipo) {
         case MODULO_FIOS:
-            m.parametro = 2 + (rand() % 3);
+            m.parametro = parametro > 0 ? parametro : 2 + aleatorio_intervalo(gerador, 3);
             m.tempo_resolucao = 3 + dificuldade;
             snprintf(m.nome, MAX_NOME_MODULO, "Fios #%d", id);
-            {
-                char cores[] = {'r', 'g', 'b', 'y'};
-                m.instrucao[0] = '\0';
-                for (int i = 0; i < m.parametro; i++) {
-                    char c[2] = {cores[rand() % 4], '\0'};
-                    strcat(m.instrucao, c);
-                }
-            }
+            /* Cores r, g, b, y */
+            for (int i = 0; i < m.parametro; i++) valores[i] = aleatorio_intervalo(gerador, 4);
             break;
 
         case MODULO_BOTAO:
-            m.parametro = 2 + (rand() % 4);
+            m.parametro = parametro > 0 ? parametro : 2 + aleatorio_intervalo(gerador, 4);
             m.tempo_resolucao = 2 + dificuldade;
             snprintf(m.nome, MAX_NOME_MODULO, "Botao #%d", id);
-            memset(m.instrucao, 'p', m.parametro);
-            m.instrucao[m.parametro] = '\0';
+            /* So 'p': todos os valores ficam 0 */
             break;
 
         case MODULO_SEQUENCIA:
-            m.parametro = 3 + (rand() % 3);
+            m.parametro = parametro > 0 ? parametro : 3 + aleatorio_intervalo(gerador, 3);
             m.tempo_resolucao = 4 + dificuldade;
             snprintf(m.nome, MAX_NOME_MODULO, "Seq #%d", id);
-            for (int i = 0; i < m.parametro; i++) {
-                m.instrucao[i] = '1' + (rand() % 4);
-            }
-            m.instrucao[m.parametro] = '\0';
+            /* Teclas 1 a 4 */
+            for (int i = 0; i < m.parametro; i++) valores[i] = aleatorio_intervalo(gerador, 4);
             break;
 
         case MODULO_SIMON:
-            m.parametro = 3 + (rand() % 2);
+            m.parametro = parametro > 0 ? parametro : 3 + aleatorio_intervalo(gerador, 2);
             m.tempo_resolucao = 5 + dificuldade;
             snprintf(m.nome, MAX_NOME_MODULO, "Simon #%d", id);
-            {
-                char dirs[] = {'u', 'd', 'l', 'r'};
-                for (int i = 0; i < m.parametro; i++) {
-                    m.instrucao[i] = dirs[rand() % 4];
-                }
-                m.instrucao[m.parametro] = '\0';
-            }
+            /* Direcoes u, d, l, r */
+            for (int i = 0; i < m.parametro; i++) valores[i] = aleatorio_intervalo(gerador, 4);
             break;
 
         default:
+            /* Tipo desconhecido: instrucao invalida, que nunca confere */
             snprintf(m.nome, MAX_NOME_MODULO, "Modulo #%d", id);
-            strcpy(m.instrucao, "x");
             m.tempo_resolucao = 3;
             break;
     }
+    instrucao_montar(m.tipo, valores, m.parametro, &m.instrucao);
+
+    *modulo = m;
+}
+
+/* Soma 'seg' segundos (podem ser negativos) a um instante */
+static void somar_segundos(struct timespec* ts, double seg) {
+    long long ns = (long long)ts->tv_nsec + (long long)(seg * 1e9);
+    ts->tv_sec += ns / 1000000000LL;
+    ns %= 1000000000LL;
+    if (ns < 0) {
+        ns += 1000000000LL;
+        ts->tv_sec--;
+    }
+    ts->tv_nsec = ns;
+}
 
-    return m;
+static double diferenca_segundos(const struct timespec* a, const struct timespec* b) {
+    return (a->tv_sec - b->tv_sec) + (a->tv_nsec - b->tv_nsec) / 1e9;
 }
 
-/* Thread que gera modulos aleatorios periodicamente */
+/*
+ * Thread que gera modulos segundo o modelo de chegada da partida.
+ *
+ * Dorme em cond_estado ate o prazo absoluto da proxima chegada (relogio
+ * monotonico), de modo que nao ha despertares entre chegadas. Pausa e
+ * encerramento chegam pelo mesmo cond_estado. Cada prazo e contado a
+ * partir do anterior, e nao do momento em que a thread acordou, entao
+ * os atrasos de escalonamento nao se acumulam.
+ */
 void* thread_mural_modulos(void* arg) {
     EstadoJogoCompleto* estado = (EstadoJogoCompleto*)arg;
     if (!estado) return NULL;
 
-    while (estado->executando) {
-        /* Verifica se o jogo esta rodando */
-        pthread_mutex_lock(&estado->mutex_estado);
-        EstadoJogo est = estado->estado;
-        pthread_mutex_unlock(&estado->mutex_estado);
+    /* Mesma base do timer: chegadas e segundos ficam na mesma escala */
+    struct timespec proxima = timespec_de_ns(estado->inicio_ns);
 
-        if (est != JOGO_RODANDO) {
-            usleep(100000); /* 100ms */
-            continue;
-        }
+    pthread_mutex_lock(&estado->mutex_estado);
 
-        /* Verifica se pode adicionar mais modulos */
-        /* Nota: fila_modulos_cheia usa seu proprio mutex */
-        if (!fila_modulos_cheia(&estado->fila_modulos)) {
-            /* Gera um novo modulo */
-            pthread_mutex_lock(&estado->mutex_estado);
-            int id = estado->proximo_id_modulo++;
-            int dif = estado->config.dificuldade;
-            pthread_mutex_unlock(&estado->mutex_estado);
-
-            Modulo novo = gerar_modulo_aleatorio(id, dif);
-
-            if (fila_modulos_adicionar(&estado->fila_modulos, &novo)) {
-                /* CORRECAO DEADLOCK: Pega quantidade SEM segurar mutex_estado */
-                int qtd_pendentes = fila_modulos_quantidade(&estado->fila_modulos);
-                
-                pthread_mutex_lock(&estado->mutex_estado);
-                estado->stats.modulos_gerados++;
-                estado->stats.modulos_pendentes = qtd_pendentes;
-                pthread_mutex_unlock(&estado->mutex_estado);
+    /* Fluxo proprio: a mesma semente reproduz a mesma sequencia de modulos */
+    GeradorAleatorio gerador;
+    aleatorio_semear(&gerador, estado->semente, FLUXO_MURAL);
 
-                jogo_feedback(estado, "Novo modulo: %s [%c] - Instrucao: %s",
-                             novo.nome, char_tipo_modulo(novo.tipo), novo.instrucao);
+    Chegada chegada;
+    bool ha_chegada = chegadas_proxima(&estado->chegadas, estado->config.dificuldade, &chegada);
+    if (ha_chegada) somar_segundos(&proxima, chegada.intervalo);
+
+    /* Sem mais chegadas (fim do trace) a thread simplesmente termina */
+    while (estado->executando && ha_chegada) {
+        if (estado->estado != JOGO_RODANDO) {
+            /* Pausado: dorme ate o estado mudar, preservando o intervalo restante */
+            struct timespec inicio_pausa, fim_pausa;
+            clock_gettime(CLOCK_MONOTONIC, &inicio_pausa);
+            while (estado->executando && estado->estado != JOGO_RODANDO) {
+                pthread_cond_wait(&estado->cond_estado, &estado->mutex_estado);
+                atomic_fetch_add_explicit(&estado->despertares_mural, 1, memory_order_relaxed);
             }
+            clock_gettime(CLOCK_MONOTONIC, &fim_pausa);
+            somar_segundos(&proxima, diferenca_segundos(&fim_pausa, &inicio_pausa));
+            continue;
         }
 
-        /* Intervalo aleatorio entre geracoes */
-        int intervalo = INTERVALO_GERACAO_MIN +
-                       (rand() % (INTERVALO_GERACAO_MAX - INTERVALO_GERACAO_MIN + 1));
+        pthread_cond_timedwait(&estado->cond_estado, &estado->mutex_estado, &proxima);
+        atomic_fetch_add_explicit(&estado->despertares_mural, 1, memory_order_relaxed);
+
+        /* Acordou antes do prazo: mudanca de estado (ou despertar espurio) */
+        struct timespec agora;
+        clock_gettime(CLOCK_MONOTONIC, &agora);
+        if (!estado->executando || estado->estado != JOGO_RODANDO ||
+            diferenca_segundos(&agora, &proxima) < 0) {
+            continue;
+        }
 
+        /* Espera brevemente por uma vaga caso a fila esteja cheia */
+        pthread_mutex_unlock(&estado->mutex_estado);
+        bool vaga = fila_modulos_aguardar_espaco(&estado->fila_modulos, ESPERA_VAGA_MURAL_MS);
         pthread_mutex_lock(&estado->mutex_estado);
+        if (!vaga) {
+            /* Sem vaga: a mesma chegada e o mesmo id na proxima volta (o prazo ja venceu) */
+            continue;
+        }
+
+        /* O id so e consumido com a vaga garantida: sem buracos na sequencia */
+        int id = estado->proximo_id_modulo++;
         int dif = estado->config.dificuldade;
         pthread_mutex_unlock(&estado->mutex_estado);
 
-        intervalo = intervalo - dif + 1;
-        if (intervalo < 2) intervalo = 2;
-
-        /* Aguarda o intervalo */
-        for (int i = 0; i < intervalo * 10 && estado->executando; i++) {
-            usleep(100000); /* 100ms */
+        ModuloHandle h = pool_modulos_alocar();
+        Modulo* novo = pool_modulos_obter(h);
+        if (novo) {
+            if (chegada.tipo >= 0) {
+                gerar_modulo(&gerador, novo, id, dif, chegada.tipo, chegada.parametro);
+            } else {
+                gerar_modulo_aleatorio(&gerador, novo, id, dif);
+            }
 
-            pthread_mutex_lock(&estado->mutex_estado);
-            est = estado->estado;
-            pthread_mutex_unlock(&estado->mutex_estado);
+            /* Copia para a mensagem: apos publicado, o modulo pode ser consumido */
+            char nome[MAX_NOME_MODULO];
+            char instrucao[MAX_SIMBOLOS_INSTRUCAO + 1];
+            char tipo = char_tipo_modulo(novo->tipo);
+            strcpy(nome, novo->nome);
+            instrucao_decodificar(&novo->instrucao, instrucao, sizeof(instrucao));
 
-            if (est != JOGO_RODANDO) break;
+            if (fila_modulos_adicionar(&estado->fila_modulos, h)) {
+                /* Contador proprio do mural, somado na leitura */
+                atomic_fetch_add_explicit(&estado->gerados_mural, 1, memory_order_relaxed);
+                jogo_feedback(estado, "Novo modulo: %s [%c] - Instrucao: %s",
+                             nome, tipo, instrucao);
+            } else {
+                pool_modulos_liberar(h);
+            }
         }
+
+        /* Proximo prazo a partir do anterior: sem deriva */
+        ha_chegada = chegadas_proxima(&estado->chegadas, dif, &chegada);
+        if (ha_chegada) somar_segundos(&proxima, chegada.intervalo);
+
+        pthread_mutex_lock(&estado->mutex_estado);
     }
 
+    pthread_mutex_unlock(&estado->mutex_estado);
+    pool_modulos_devolver_cache();
     return NULL;
-}
\ No newline at end of file
+}
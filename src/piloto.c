@@ -0,0 +1,206 @@
+/*
+ * piloto.c - Piloto automatico (thread do coordenador)
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#include "../include/piloto.h"
+#include "../include/jogo.h"
+#include "../include/modulos.h"
+#include "../include/tedax.h"
+#include "../include/bancada.h"
+#include "../include/pool_modulos.h"
+#include "../include/metricas.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NS_POR_MS 1000000LL
+
+static const char* nomes_politicas[PILOTO_TOTAL] = { "desligado", "fifo", "sjf", "carga" };
+
+int piloto_politica_por_nome(const char* nome) {
+    if (!nome) return -1;
+    for (int i = PILOTO_FIFO; i < PILOTO_TOTAL; i++) {
+        if (strcmp(nome, nomes_politicas[i]) == 0) return i;
+    }
+    return -1;
+}
+
+const char* piloto_nome_politica(PoliticaPiloto politica) {
+    if (politica < 0 || politica >= PILOTO_TOTAL) return "?";
+    return nomes_politicas[politica];
+}
+
+int piloto_ordenar_tedax(const Estado* estados, const bool* com_designacao, int num_tedax, int* ordem) {
+    int n = 0;
+    for (int i = 0; i < num_tedax; i++) {
+        if (!com_designacao[i] && estados[i] == ESTADO_LIVRE) ordem[n++] = i;
+    }
+    for (int i = 0; i < num_tedax; i++) {
+        if (!com_designacao[i] && estados[i] != ESTADO_LIVRE) ordem[n++] = i;
+    }
+    return n;
+}
+
+/* Ordem da fila: o primeiro que chegou ou, no EDF, o de menor prazo */
+static bool vem_antes(PoliticaFila politica_fila, const CandidatoPiloto* a, int ia, const CandidatoPiloto* b,
+                      int ib) {
+    if (politica_fila == FILA_EDF && a->prazo != b->prazo) return a->prazo < b->prazo;
+    return ia < ib;
+}
+
+int piloto_escolher_modulo(PoliticaPiloto politica, PoliticaFila politica_fila, const CandidatoPiloto* candidatos,
+                           int n) {
+    if (!candidatos || n <= 0) return -1;
+    int escolhido = 0;
+    for (int i = 1; i < n; i++) {
+        const CandidatoPiloto* c = &candidatos[i];
+        const CandidatoPiloto* e = &candidatos[escolhido];
+        if (politica == PILOTO_SJF && c->tempo_resolucao != e->tempo_resolucao) {
+            if (c->tempo_resolucao < e->tempo_resolucao) escolhido = i;
+        } else if (vem_antes(politica_fila, c, i, e, escolhido)) {
+            escolhido = i;
+        }
+    }
+    return escolhido;
+}
+
+int piloto_escolher_bancada(PoliticaPiloto politica, int tedax, const int* carga, int num_bancadas) {
+    int propria = tedax % num_bancadas;
+    if (politica != PILOTO_MENOS_CARREGADA || !carga) return propria;
+
+    /* Empate: a do proprio tedax e depois as seguintes, como tedax_tentar_bancada */
+    int escolhida = propria;
+    for (int i = 1; i < num_bancadas; i++) {
+        int b = (propria + i) % num_bancadas;
+        if (carga[b] < carga[escolhida]) escolhida = b;
+    }
+    return escolhida;
+}
+
+int piloto_rascunho_init(RascunhoPiloto* rascunho, const ConfigJogo* config) {
+    if (!rascunho || !config) return -1;
+    memset(rascunho, 0, sizeof(RascunhoPiloto));
+    rascunho->pendentes = malloc(sizeof(Modulo) * config->capacidade_fila);
+    rascunho->candidatos = malloc(sizeof(CandidatoPiloto) * config->capacidade_fila);
+    rascunho->estados = malloc(sizeof(Estado) * config->num_tedax);
+    rascunho->com_designacao = malloc(sizeof(bool) * config->num_tedax);
+    rascunho->ordem = malloc(sizeof(int) * config->num_tedax);
+    rascunho->carga = malloc(sizeof(int) * config->num_bancadas);
+    if (!rascunho->pendentes || !rascunho->candidatos || !rascunho->estados || !rascunho->com_designacao ||
+        !rascunho->ordem || !rascunho->carga) {
+        piloto_rascunho_destroy(rascunho);
+        return -1;
+    }
+    return 0;
+}
+
+void piloto_rascunho_destroy(RascunhoPiloto* rascunho) {
+    if (!rascunho) return;
+    free(rascunho->pendentes);
+    free(rascunho->candidatos);
+    free(rascunho->estados);
+    free(rascunho->com_designacao);
+    free(rascunho->ordem);
+    free(rascunho->carga);
+    memset(rascunho, 0, sizeof(RascunhoPiloto));
+}
+
+int piloto_rodada(EstadoJogoCompleto* estado, RascunhoPiloto* rascunho) {
+    if (!estado || !rascunho) return 0;
+    ConfigJogo* config = &estado->config;
+    Modulo* pendentes = rascunho->pendentes;
+    CandidatoPiloto* candidatos = rascunho->candidatos;
+    Estado* estados = rascunho->estados;
+    bool* com_designacao = rascunho->com_designacao;
+    int* ordem = rascunho->ordem;
+    int* carga = rascunho->carga;
+
+    for (int i = 0; i < config->num_tedax; i++) {
+        Tedax* t = &estado->tedax[i];
+        pthread_mutex_lock(&t->mutex);
+        estados[i] = t->estado;
+        pthread_mutex_unlock(&t->mutex);
+        com_designacao[i] = tedax_quantidade_caixa(t) > 0;
+    }
+    int elegiveis = piloto_ordenar_tedax(estados, com_designacao, config->num_tedax, ordem);
+    if (elegiveis == 0) return 0;
+
+    int n = fila_modulos_listar(&estado->fila_modulos, pendentes, config->capacidade_fila);
+    if (n == 0) return 0;
+    for (int i = 0; i < n; i++) {
+        candidatos[i].tempo_resolucao = pendentes[i].tempo_resolucao;
+        candidatos[i].prazo = modulo_prazo(&pendentes[i]);
+    }
+
+    for (int b = 0; b < config->num_bancadas; b++) carga[b] = bancada_carga(&estado->bancadas[b]);
+    for (int i = 0; i < config->num_tedax; i++) tedax_somar_designacoes(&estado->tedax[i], carga);
+
+    int designados = 0;
+    for (int k = 0; k < elegiveis && n > 0; k++) {
+        int id_tedax = ordem[k];
+        int escolhido = piloto_escolher_modulo(config->piloto, config->politica_fila, candidatos, n);
+        int bancada = piloto_escolher_bancada(config->piloto, id_tedax, carga, config->num_bancadas);
+
+        ModuloHandle h;
+        bool retirado = fila_modulos_remover_por_id(&estado->fila_modulos, pendentes[escolhido].id, &h);
+        n--;
+        memmove(&pendentes[escolhido], &pendentes[escolhido + 1], sizeof(Modulo) * (n - escolhido));
+        memmove(&candidatos[escolhido], &candidatos[escolhido + 1], sizeof(CandidatoPiloto) * (n - escolhido));
+        if (!retirado) {
+            /* Outro consumidor levou o modulo: o tedax tenta o seguinte */
+            k--;
+            continue;
+        }
+
+        Modulo* modulo = pool_modulos_obter(h);
+        if (!tedax_designar_modulo(&estado->tedax[id_tedax], h, bancada, &modulo->instrucao)) {
+            if (!fila_modulos_adicionar(&estado->fila_modulos, h)) pool_modulos_liberar(h);
+            continue;
+        }
+        carga[bancada]++;
+        designados++;
+    }
+    return designados;
+}
+
+/*
+ * Rodadas em prazos absolutos contados de inicio_ns, como o timer; a
+ * pausa adia os prazos pelo tempo pausado e o fim da partida acorda a
+ * espera em cond_estado.
+ */
+void* thread_coordenador(void* arg) {
+    EstadoJogoCompleto* estado = (EstadoJogoCompleto*)arg;
+    if (!estado) return NULL;
+
+    RascunhoPiloto rascunho;
+    if (piloto_rascunho_init(&rascunho, &estado->config) != 0) return NULL;
+
+    long long prazo = estado->inicio_ns + PERIODO_PILOTO_MS * NS_POR_MS;
+
+    pthread_mutex_lock(&estado->mutex_estado);
+    while (estado->executando) {
+        if (estado->estado == JOGO_PAUSADO) {
+            long long inicio_pausa = relogio_ns();
+            while (estado->executando && estado->estado == JOGO_PAUSADO) {
+                pthread_cond_wait(&estado->cond_estado, &estado->mutex_estado);
+            }
+            prazo += relogio_ns() - inicio_pausa;
+            continue;
+        }
+        if (estado->estado != JOGO_RODANDO) break;
+
+        struct timespec ts = timespec_de_ns(prazo);
+        pthread_cond_timedwait(&estado->cond_estado, &estado->mutex_estado, &ts);
+        if (estado->estado != JOGO_RODANDO || relogio_ns() < prazo) continue;
+
+        prazo += PERIODO_PILOTO_MS * NS_POR_MS;
+        pthread_mutex_unlock(&estado->mutex_estado);
+        piloto_rodada(estado, &rascunho);
+        pthread_mutex_lock(&estado->mutex_estado);
+    }
+    pthread_mutex_unlock(&estado->mutex_estado);
+
+    piloto_rascunho_destroy(&rascunho);
+    pool_modulos_devolver_cache();
+    return NULL;
+}
@@ -0,0 +1,147 @@
+/*
+ * pool_modulos.c - Pool de modulos em slabs com cache local por thread
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#include "../include/pool_modulos.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BITS_SLAB 8
+#define MODULOS_POR_SLAB (1 << BITS_SLAB)   /* 256 modulos por slab */
+#define MAX_SLABS 4096                      /* ~1M modulos */
+#define CACHE_POR_THREAD 32
+#define LOTE_CACHE (CACHE_POR_THREAD / 2)
+
+typedef struct {
+    Modulo modulos[MODULOS_POR_SLAB];
+    ModuloHandle proximo[MODULOS_POR_SLAB]; /* Encadeamento da lista global de livres */
+} Slab;
+
+typedef struct {
+    Slab* slabs[MAX_SLABS];
+    atomic_int num_slabs;
+    ModuloHandle livre;             /* Cabeca da lista global de livres */
+    atomic_long alocacoes_heap;
+    pthread_mutex_t mutex;          /* Protege 'livre' e o crescimento */
+} PoolModulos;
+
+typedef struct {
+    ModuloHandle handles[CACHE_POR_THREAD];
+    int quantidade;
+} CacheLocal;
+
+static PoolModulos pool;
+static _Thread_local CacheLocal cache;
+
+static ModuloHandle* proximo_de(ModuloHandle h) {
+    return &pool.slabs[h >> BITS_SLAB]->proximo[h & (MODULOS_POR_SLAB - 1)];
+}
+
+/* Aloca um novo slab e encadeia seus handles na lista global. Requer o mutex. */
+static bool pool_modulos_novo_slab(void) {
+    int n = atomic_load(&pool.num_slabs);
+    if (n >= MAX_SLABS) return false;
+
+    Slab* slab = malloc(sizeof(Slab));
+    if (!slab) return false;
+    atomic_fetch_add(&pool.alocacoes_heap, 1);
+
+    ModuloHandle base = (ModuloHandle)n << BITS_SLAB;
+    for (int i = 0; i < MODULOS_POR_SLAB; i++) {
+        slab->proximo[i] = (i + 1 < MODULOS_POR_SLAB) ? base + i + 1 : pool.livre;
+    }
+    pool.slabs[n] = slab;
+    pool.livre = base;
+
+    /* Publica o slab para leitores de pool_modulos_obter */
+    atomic_store(&pool.num_slabs, n + 1);
+    return true;
+}
+
+int pool_modulos_init(void) {
+    memset(&pool, 0, sizeof(pool));
+    pool.livre = MODULO_HANDLE_NULO;
+    atomic_init(&pool.num_slabs, 0);
+    atomic_init(&pool.alocacoes_heap, 0);
+    pthread_mutex_init(&pool.mutex, NULL);
+    cache.quantidade = 0;
+
+    pthread_mutex_lock(&pool.mutex);
+    bool ok = pool_modulos_novo_slab();
+    pthread_mutex_unlock(&pool.mutex);
+    return ok ? 0 : -1;
+}
+
+void pool_modulos_destroy(void) {
+    int n = atomic_load(&pool.num_slabs);
+    for (int i = 0; i < n; i++) {
+        free(pool.slabs[i]);
+        pool.slabs[i] = NULL;
+    }
+    atomic_store(&pool.num_slabs, 0);
+    pool.livre = MODULO_HANDLE_NULO;
+    cache.quantidade = 0;
+    pthread_mutex_destroy(&pool.mutex);
+}
+
+ModuloHandle pool_modulos_alocar(void) {
+    if (cache.quantidade == 0) {
+        /* Reabastece o cache com um lote da lista global */
+        pthread_mutex_lock(&pool.mutex);
+        while (cache.quantidade < LOTE_CACHE) {
+            if (pool.livre == MODULO_HANDLE_NULO && !pool_modulos_novo_slab()) break;
+            ModuloHandle h = pool.livre;
+            pool.livre = *proximo_de(h);
+            cache.handles[cache.quantidade++] = h;
+        }
+        pthread_mutex_unlock(&pool.mutex);
+
+        if (cache.quantidade == 0) return MODULO_HANDLE_NULO;
+    }
+
+    return cache.handles[--cache.quantidade];
+}
+
+void pool_modulos_liberar(ModuloHandle handle) {
+    if (handle == MODULO_HANDLE_NULO) return;
+
+    if (cache.quantidade == CACHE_POR_THREAD) {
+        /* Cache cheio: devolve metade a lista global */
+        pthread_mutex_lock(&pool.mutex);
+        while (cache.quantidade > LOTE_CACHE) {
+            ModuloHandle h = cache.handles[--cache.quantidade];
+            *proximo_de(h) = pool.livre;
+            pool.livre = h;
+        }
+        pthread_mutex_unlock(&pool.mutex);
+    }
+
+    cache.handles[cache.quantidade++] = handle;
+}
+
+Modulo* pool_modulos_obter(ModuloHandle handle) {
+    if (handle == MODULO_HANDLE_NULO) return NULL;
+    int slab = handle >> BITS_SLAB;
+    if (slab >= atomic_load_explicit(&pool.num_slabs, memory_order_acquire)) return NULL;
+    return &pool.slabs[slab]->modulos[handle & (MODULOS_POR_SLAB - 1)];
+}
+
+void pool_modulos_devolver_cache(void) {
+    if (cache.quantidade == 0) return;
+
+    pthread_mutex_lock(&pool.mutex);
+    while (cache.quantidade > 0) {
+        ModuloHandle h = cache.handles[--cache.quantidade];
+        *proximo_de(h) = pool.livre;
+        pool.livre = h;
+    }
+    pthread_mutex_unlock(&pool.mutex);
+}
+
+EstatisticasPool pool_modulos_estatisticas(void) {
+    EstatisticasPool e;
+    e.alocacoes_heap = atomic_load(&pool.alocacoes_heap);
+    e.handles_total = (long)atomic_load(&pool.num_slabs) * MODULOS_POR_SLAB;
+    return e;
+}
@@ -0,0 +1,64 @@
+/*
+ * retrato.c - Seqlock de duas copias sobre palavras atomicas relaxadas
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#include "../include/retrato.h"
+#include <sched.h>
+#include <string.h>
+
+/* Releituras seguidas antes de ceder a CPU aos escritores */
+#define RELEITURAS_ANTES_DE_CEDER 64
+
+static size_t palavras_por_copia(size_t bytes) {
+    return (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+}
+
+static void escrever_copia(_Atomic uint64_t* copia, const char* origem, size_t bytes) {
+    for (size_t i = 0; i * sizeof(uint64_t) < bytes; i++) {
+        uint64_t palavra = 0;
+        size_t resto = bytes - i * sizeof(uint64_t);
+        memcpy(&palavra, origem + i * sizeof(uint64_t), resto < sizeof(uint64_t) ? resto : sizeof(uint64_t));
+        atomic_store_explicit(&copia[i], palavra, memory_order_relaxed);
+    }
+}
+
+static void ler_copia(_Atomic uint64_t* copia, char* destino, size_t bytes) {
+    for (size_t i = 0; i * sizeof(uint64_t) < bytes; i++) {
+        uint64_t palavra = atomic_load_explicit(&copia[i], memory_order_relaxed);
+        size_t resto = bytes - i * sizeof(uint64_t);
+        memcpy(destino + i * sizeof(uint64_t), &palavra, resto < sizeof(uint64_t) ? resto : sizeof(uint64_t));
+    }
+}
+
+void retrato_init(Seqlock* seq, _Atomic uint64_t* palavras, size_t bytes) {
+    atomic_init(&seq->versao, 0);
+    for (size_t i = 0; i < 2 * palavras_por_copia(bytes); i++) atomic_init(&palavras[i], 0);
+}
+
+void retrato_publicar(Seqlock* seq, _Atomic uint64_t* palavras, const void* origem, size_t bytes) {
+    size_t n = palavras_por_copia(bytes);
+    unsigned versao = atomic_load_explicit(&seq->versao, memory_order_relaxed);
+
+    /* Versao impar: leitores vao para a copia 1 enquanto a 0 muda */
+    atomic_store_explicit(&seq->versao, versao + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    escrever_copia(palavras, (const char*)origem, bytes);
+
+    /* Versao par: leitores voltam para a copia 0, ja nova, e a 1 muda */
+    atomic_store_explicit(&seq->versao, versao + 2, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    escrever_copia(palavras + n, (const char*)origem, bytes);
+}
+
+int retrato_ler(Seqlock* seq, _Atomic uint64_t* palavras, void* destino, size_t bytes) {
+    size_t n = palavras_por_copia(bytes);
+    for (int releituras = 0;; releituras++) {
+        if (releituras > 0 && releituras % RELEITURAS_ANTES_DE_CEDER == 0) sched_yield();
+
+        unsigned antes = atomic_load_explicit(&seq->versao, memory_order_acquire);
+        ler_copia(palavras + (antes & 1) * n, (char*)destino, bytes);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&seq->versao, memory_order_relaxed) == antes) return releituras;
+    }
+}
@@ -0,0 +1,412 @@
+/*
+ * simulacao.c - Partidas em tempo virtual (eventos discretos)
+ * Keep Solving and Nobody Explodes - Versao de Treino
+ */
+
+#include "../include/simulacao.h"
+#include "../include/jogo.h"
+#include "../include/modulos.h"
+#include "../include/chegadas.h"
+#include "../include/aleatorio.h"
+#include "../include/piloto.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NS_POR_SEGUNDO 1000000000LL
+#define NS_POR_MS 1000000LL
+
+/* ---- Heap de eventos por (instante, tipo, seq) ---- */
+
+static bool evento_antes(const EventoSimulacao* a, const EventoSimulacao* b) {
+    if (a->instante != b->instante) return a->instante < b->instante;
+    if (a->tipo != b->tipo) return a->tipo < b->tipo;
+    return a->seq < b->seq;
+}
+
+static void agendar(Simulacao* s, long long instante, TipoEventoSimulacao tipo, int tedax, int versao) {
+    /* Limite fixo (CAPACIDADE_EVENTOS_SIMULACAO): o heap nunca precisa crescer */
+    if (s->num_eventos >= s->capacidade_eventos) return;
+    EventoSimulacao ev = { instante, tipo, tedax, versao, s->seq++ };
+    int i = s->num_eventos++;
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (!evento_antes(&ev, &s->eventos[pai])) break;
+        s->eventos[i] = s->eventos[pai];
+        i = pai;
+    }
+    s->eventos[i] = ev;
+}
+
+static EventoSimulacao retirar_evento(Simulacao* s) {
+    EventoSimulacao topo = s->eventos[0];
+    EventoSimulacao ultimo = s->eventos[--s->num_eventos];
+    int i = 0;
+    for (;;) {
+        int menor = 2 * i + 1;
+        if (menor >= s->num_eventos) break;
+        if (menor + 1 < s->num_eventos && evento_antes(&s->eventos[menor + 1], &s->eventos[menor])) menor++;
+        if (!evento_antes(&s->eventos[menor], &ultimo)) break;
+        s->eventos[i] = s->eventos[menor];
+        i = menor;
+    }
+    if (s->num_eventos > 0) s->eventos[i] = ultimo;
+    return topo;
+}
+
+/* ---- Fila de pendentes ---- */
+
+static void pendente_inserir(Simulacao* s, int id, int tipo, int parametro) {
+    int dif = s->config.dificuldade;
+    PendenteSimulado* p = &s->pendentes[s->qtd_pendentes++];
+    if (tipo >= 0) gerar_modulo(&s->gerador, &p->modulo, id, dif, tipo, parametro);
+    else gerar_modulo_aleatorio(&s->gerador, &p->modulo, id, dif);
+    p->modulo.criado_em = (time_t)(s->agora / NS_POR_SEGUNDO);
+    p->prazo = modulo_prazo(&p->modulo);
+    s->stats.modulos_gerados++;
+}
+
+/* Retira o pendente da posicao 'escolhido' */
+static void pendente_remover(Simulacao* s, int escolhido, Modulo* modulo) {
+    *modulo = s->pendentes[escolhido].modulo;
+    s->qtd_pendentes--;
+    memmove(&s->pendentes[escolhido], &s->pendentes[escolhido + 1],
+            sizeof(PendenteSimulado) * (s->qtd_pendentes - escolhido));
+}
+
+/* Retira o proximo pela politica da fila (EDF empata pela ordem de chegada) */
+static void pendente_retirar(Simulacao* s, Modulo* modulo) {
+    int escolhido = 0;
+    if (s->config.politica_fila == FILA_EDF) {
+        for (int i = 1; i < s->qtd_pendentes; i++) {
+            if (s->pendentes[i].prazo < s->pendentes[escolhido].prazo) escolhido = i;
+        }
+    }
+    pendente_remover(s, escolhido, modulo);
+}
+
+/* Pendentes na regra de fim: a fila mais as designacoes na caixa, como jogo_modulos_pendentes */
+static int pendentes_total(Simulacao* s) {
+    int qtd = s->qtd_pendentes;
+    for (int i = 0; i < s->config.num_tedax; i++) qtd += s->tedax[i].designado;
+    return qtd;
+}
+
+/* ---- Tedax e bancadas ---- */
+
+/* Primeira bancada livre a partir da "sua", como tedax_tentar_bancada */
+static int bancada_livre(Simulacao* s, int tedax, int exceto) {
+    int n = s->config.num_bancadas;
+    for (int i = 0; i < n; i++) {
+        int b = (tedax + i) % n;
+        if (b != exceto && s->bancadas[b].dono < 0) return b;
+    }
+    return -1;
+}
+
+static void comecar_trabalho(Simulacao* s, int tedax, int bancada) {
+    TedaxSimulado* t = &s->tedax[tedax];
+    s->bancadas[bancada].dono = tedax;
+    t->estado = ESTADO_OCUPADO;
+    t->bancada = bancada;
+    t->bancada_espera = -1;
+    t->versao++;
+    agendar(s, s->agora + t->modulo.tempo_resolucao * NS_POR_SEGUNDO, EVENTO_FIM_TRABALHO, tedax, t->versao);
+}
+
+/* Poe o tedax no fim da fila da bancada, aguardando a entrega */
+static void entrar_fila(Simulacao* s, int tedax, int bancada) {
+    TedaxSimulado* t = &s->tedax[tedax];
+    BancadaSimulada* b = &s->bancadas[bancada];
+    t->prox_espera = -1;
+    if (b->fila_fim >= 0) s->tedax[b->fila_fim].prox_espera = tedax;
+    else b->fila_inicio = tedax;
+    b->fila_fim = tedax;
+    b->esperando++;
+    t->estado = ESTADO_AGUARDANDO_BANCADA;
+    t->bancada_espera = bancada;
+    t->versao++;
+}
+
+static void sair_fila(Simulacao* s, int tedax) {
+    BancadaSimulada* b = &s->bancadas[s->tedax[tedax].bancada_espera];
+    int anterior = -1;
+    for (int i = b->fila_inicio; i >= 0; anterior = i, i = s->tedax[i].prox_espera) {
+        if (i != tedax) continue;
+        if (anterior >= 0) s->tedax[anterior].prox_espera = s->tedax[i].prox_espera;
+        else b->fila_inicio = s->tedax[i].prox_espera;
+        if (b->fila_fim == i) b->fila_fim = anterior;
+        b->esperando--;
+        break;
+    }
+}
+
+/* Liberacao com entrega direta ao primeiro da fila, como bancada_liberar */
+static void liberar_bancada(Simulacao* s, int bancada) {
+    BancadaSimulada* b = &s->bancadas[bancada];
+    b->dono = -1;
+    if (b->fila_inicio < 0) return;
+    int proximo = b->fila_inicio;
+    sair_fila(s, proximo);
+    comecar_trabalho(s, proximo, bancada);
+}
+
+/* Sorteia a chegada seguinte, com prazo contado do anterior como no mural */
+static void sortear_chegada(Simulacao* s) {
+    Chegada c;
+    s->ha_chegada = chegadas_proxima(&s->chegadas, s->config.dificuldade, &c);
+    if (!s->ha_chegada) return;
+    s->proxima_chegada += (long long)(c.intervalo * 1e9);
+    s->tipo_proxima = c.tipo;
+    s->parametro_proxima = c.parametro;
+}
+
+/* Agenda a chegada sorteada; se o mural se atrasou esperando vaga, sai na hora */
+static void agendar_chegada(Simulacao* s) {
+    if (!s->ha_chegada) return;
+    long long instante = s->proxima_chegada > s->agora ? s->proxima_chegada : s->agora;
+    agendar(s, instante, EVENTO_CHEGADA, -1, 0);
+}
+
+/*
+ * Tedax comandado assume a designacao: a bancada designada, ou a fila
+ * dela, onde espera a entrega sem revisitar outras (bancada alvo).
+ */
+static void assumir_designacao(Simulacao* s, int tedax) {
+    TedaxSimulado* t = &s->tedax[tedax];
+    t->modulo = t->proximo;
+    t->designado = false;
+    int b = t->bancada_proxima;
+    if (s->bancadas[b].dono < 0) {
+        comecar_trabalho(s, tedax, b);
+        return;
+    }
+    entrar_fila(s, tedax, b);
+}
+
+/* Tedax livres assumem pendentes; o mural coloca o modulo que segurava */
+static void despachar(Simulacao* s) {
+    bool mudou = true;
+    while (mudou) {
+        mudou = false;
+        for (int i = 0; i < s->config.num_tedax; i++) {
+            TedaxSimulado* t = &s->tedax[i];
+            if (t->estado != ESTADO_LIVRE || !t->designado) continue;
+            assumir_designacao(s, i);
+            mudou = true;
+        }
+        for (int i = 0; i < s->config.num_tedax && s->config.tedax_autonomos; i++) {
+            TedaxSimulado* t = &s->tedax[i];
+            if (t->estado != ESTADO_LIVRE || s->qtd_pendentes == 0) continue;
+            pendente_retirar(s, &t->modulo);
+            mudou = true;
+
+            int b = bancada_livre(s, i, -1);
+            if (b >= 0) {
+                comecar_trabalho(s, i, b);
+                continue;
+            }
+            entrar_fila(s, i, i % s->config.num_bancadas);
+            agendar(s, s->agora + ESPERA_AUTONOMO_MS * NS_POR_MS, EVENTO_SONDAGEM, i, t->versao);
+        }
+
+        if (s->esperando_vaga && s->qtd_pendentes < s->config.capacidade_fila) {
+            pendente_inserir(s, s->id_espera, s->tipo_espera, s->parametro_espera);
+            s->esperando_vaga = false;
+            mudou = true;
+            agendar_chegada(s);
+        }
+    }
+}
+
+/* ---- Tratamento dos eventos ---- */
+
+static void tratar_chegada(Simulacao* s) {
+    int id = s->proximo_id++;
+
+    if (s->qtd_pendentes < s->config.capacidade_fila) {
+        pendente_inserir(s, id, s->tipo_proxima, s->parametro_proxima);
+    } else {
+        s->esperando_vaga = true;
+        s->id_espera = id;
+        s->tipo_espera = s->tipo_proxima;
+        s->parametro_espera = s->parametro_proxima;
+        s->versao_vaga++;
+        agendar(s, s->agora + ESPERA_VAGA_MURAL_MS * NS_POR_MS, EVENTO_VAGA_EXPIRADA, -1, s->versao_vaga);
+    }
+
+    sortear_chegada(s);
+    if (!s->esperando_vaga) agendar_chegada(s);
+}
+
+static void tratar_vaga_expirada(Simulacao* s, int versao) {
+    if (!s->esperando_vaga || versao != s->versao_vaga) return;
+    /* Como o mural real: segura a mesma chegada e o mesmo id e espera de novo */
+    agendar(s, s->agora + ESPERA_VAGA_MURAL_MS * NS_POR_MS, EVENTO_VAGA_EXPIRADA, -1, s->versao_vaga);
+}
+
+static void tratar_fim_trabalho(Simulacao* s, int tedax) {
+    TedaxSimulado* t = &s->tedax[tedax];
+    liberar_bancada(s, t->bancada);
+    t->bancada = -1;
+    t->estado = ESTADO_LIVRE;
+    t->desarmados++;
+    s->stats.modulos_desarmados++;
+}
+
+static void tratar_sondagem(Simulacao* s, int tedax) {
+    TedaxSimulado* t = &s->tedax[tedax];
+    int b = bancada_livre(s, tedax, t->bancada_espera);
+    if (b >= 0) {
+        sair_fila(s, tedax);
+        comecar_trabalho(s, tedax, b);
+        return;
+    }
+    agendar(s, s->agora + ESPERA_AUTONOMO_MS * NS_POR_MS, EVENTO_SONDAGEM, tedax, t->versao);
+}
+
+/* Rodada do piloto com as mesmas escolhas de piloto_rodada */
+static void tratar_piloto(Simulacao* s) {
+    agendar(s, s->agora + PERIODO_PILOTO_MS * NS_POR_MS, EVENTO_PILOTO, -1, 0);
+
+    int num_tedax = s->config.num_tedax;
+    int num_bancadas = s->config.num_bancadas;
+    RascunhoPiloto* r = &s->rascunho;
+    for (int i = 0; i < num_tedax; i++) {
+        r->estados[i] = s->tedax[i].estado;
+        r->com_designacao[i] = s->tedax[i].designado;
+    }
+    int* ordem = r->ordem;
+    int elegiveis = piloto_ordenar_tedax(r->estados, r->com_designacao, num_tedax, ordem);
+    if (elegiveis == 0 || s->qtd_pendentes == 0) return;
+
+    CandidatoPiloto* candidatos = r->candidatos;
+    int n = s->qtd_pendentes;
+    for (int i = 0; i < n; i++) {
+        candidatos[i].tempo_resolucao = s->pendentes[i].modulo.tempo_resolucao;
+        candidatos[i].prazo = s->pendentes[i].prazo;
+    }
+
+    int* carga = r->carga;
+    for (int b = 0; b < num_bancadas; b++) carga[b] = (s->bancadas[b].dono >= 0) + s->bancadas[b].esperando;
+    for (int i = 0; i < num_tedax; i++) {
+        if (s->tedax[i].designado) carga[s->tedax[i].bancada_proxima]++;
+    }
+
+    for (int k = 0; k < elegiveis && n > 0; k++) {
+        TedaxSimulado* t = &s->tedax[ordem[k]];
+        int escolhido = piloto_escolher_modulo(s->config.piloto, s->config.politica_fila, candidatos, n);
+        int bancada = piloto_escolher_bancada(s->config.piloto, ordem[k], carga, num_bancadas);
+        pendente_remover(s, escolhido, &t->proximo);
+        n--;
+        memmove(&candidatos[escolhido], &candidatos[escolhido + 1], sizeof(CandidatoPiloto) * (n - escolhido));
+        t->designado = true;
+        t->bancada_proxima = bancada;
+        carga[bancada]++;
+    }
+}
+
+static void tratar_segundo(Simulacao* s) {
+    s->segundos++;
+    if (s->stats.tempo_restante > 0) s->stats.tempo_restante--;
+
+    EstadoJogo novo = s->estado;
+    if (jogo_avaliar_fim(&s->config, &s->stats, pendentes_total(s), &novo, s->motivo, sizeof(s->motivo))) {
+        s->estado = novo;
+        return;
+    }
+    agendar(s, s->agora + NS_POR_SEGUNDO, EVENTO_SEGUNDO, -1, 0);
+}
+
+static void simulacao_liberar(Simulacao* s) {
+    chegadas_destroy(&s->chegadas);
+    piloto_rascunho_destroy(&s->rascunho);
+    free(s->pendentes);
+    free(s->eventos);
+    free(s->tedax);
+    free(s->bancadas);
+    free(s);
+}
+
+int simulacao_executar(const ConfigJogo* config, uint64_t semente, ResultadoSimulacao* resultado) {
+    if (!config || !resultado) return -1;
+
+    Simulacao* s = calloc(1, sizeof(Simulacao));
+    if (!s) return -1;
+    s->config = *config;
+    config_normalizar(&s->config);
+    if (semente == 0) semente = aleatorio_semente_relogio();
+
+    if (chegadas_init(&s->chegadas, &s->config, semente) != 0) {
+        free(s);
+        return -1;
+    }
+    aleatorio_semear(&s->gerador, semente, FLUXO_MURAL);
+
+    s->capacidade_pendentes = s->config.capacidade_fila;
+    s->capacidade_eventos = CAPACIDADE_EVENTOS_SIMULACAO(s->config.num_tedax);
+    s->pendentes = malloc(sizeof(PendenteSimulado) * s->capacidade_pendentes);
+    s->eventos = malloc(sizeof(EventoSimulacao) * s->capacidade_eventos);
+    s->tedax = calloc(s->config.num_tedax, sizeof(TedaxSimulado));
+    s->bancadas = calloc(s->config.num_bancadas, sizeof(BancadaSimulada));
+    if (!s->pendentes || !s->eventos || !s->tedax || !s->bancadas ||
+        piloto_rascunho_init(&s->rascunho, &s->config) != 0) {
+        simulacao_liberar(s);
+        return -1;
+    }
+
+    s->estado = JOGO_RODANDO;
+    s->stats.tempo_restante = s->config.tempo_partida;
+    s->proximo_id = 1;
+    for (int i = 0; i < s->config.num_tedax; i++) {
+        s->tedax[i].estado = ESTADO_LIVRE;
+        s->tedax[i].bancada = -1;
+        s->tedax[i].bancada_espera = -1;
+        s->tedax[i].prox_espera = -1;
+    }
+    for (int i = 0; i < s->config.num_bancadas; i++) {
+        s->bancadas[i].dono = -1;
+        s->bancadas[i].fila_inicio = -1;
+        s->bancadas[i].fila_fim = -1;
+    }
+
+    sortear_chegada(s);
+    agendar_chegada(s);
+    agendar(s, NS_POR_SEGUNDO + FASE_TIMER_MS * NS_POR_MS, EVENTO_SEGUNDO, -1, 0);
+    if (s->config.piloto != PILOTO_DESLIGADO) agendar(s, PERIODO_PILOTO_MS * NS_POR_MS, EVENTO_PILOTO, -1, 0);
+
+    /* O tique sempre esta agendado enquanto a partida roda, entao o heap nunca esvazia antes do fim */
+    while (s->estado == JOGO_RODANDO && s->num_eventos > 0) {
+        EventoSimulacao ev = retirar_evento(s);
+        s->agora = ev.instante;
+        s->processados++;
+
+        switch (ev.tipo) {
+            case EVENTO_CHEGADA: tratar_chegada(s); break;
+            case EVENTO_VAGA_EXPIRADA: tratar_vaga_expirada(s, ev.versao); break;
+            case EVENTO_PILOTO: tratar_piloto(s); break;
+            case EVENTO_FIM_TRABALHO:
+                if (ev.versao == s->tedax[ev.tedax].versao) tratar_fim_trabalho(s, ev.tedax);
+                break;
+            case EVENTO_SONDAGEM:
+                if (ev.versao == s->tedax[ev.tedax].versao &&
+                    s->tedax[ev.tedax].estado == ESTADO_AGUARDANDO_BANCADA) {
+                    tratar_sondagem(s, ev.tedax);
+                }
+                break;
+            case EVENTO_SEGUNDO: tratar_segundo(s); break;
+        }
+        if (s->estado == JOGO_RODANDO) despachar(s);
+    }
+
+    memset(resultado, 0, sizeof(ResultadoSimulacao));
+    resultado->semente = semente;
+    resultado->estado_final = s->estado;
+    memcpy(resultado->motivo, s->motivo, sizeof(resultado->motivo));
+    resultado->segundos = s->segundos;
+    resultado->stats = s->stats;
+    resultado->stats.modulos_pendentes = pendentes_total(s);
+    resultado->eventos = s->processados;
+
+    simulacao_liberar(s);
+    return 0;
+}
@@ -7,10 +7,15 @@
 #include "../include/bancada.h"
 #include "../include/modulos.h"
 #include "../include/jogo.h"
+#include "../include/pool_modulos.h"
+#include "../include/metricas.h"
+#include "../include/executor.h"
+#include "../include/afinidade.h"
+#include "../include/instrucao.h"
+#include "../include/retrato.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
 
 extern EstadoJogoCompleto* jogo;
 
@@ -18,16 +23,40 @@ void tedax_init(Tedax* tedax, int id) {
     if (!tedax) return;
     tedax->id = id;
     tedax->estado = ESTADO_LIVRE;
-    tedax->modulo_atual = NULL;
+    tedax->modulo_atual = MODULO_HANDLE_NULO;
     tedax->bancada_atual = NULL;
-    tedax->modulos_desarmados = 0;
-    tedax->modulos_falhados = 0;
+    atomic_init(&tedax->modulos_desarmados, 0);
+    atomic_init(&tedax->modulos_falhados, 0);
     tedax->ativo = false;
-    tedax->bancada_designada = -1;
-    tedax->tarefa_pendente = false;
-    memset(tedax->instrucao_recebida, 0, MAX_INSTRUCAO);
+    atomic_init(&tedax->caixa.escrita, 0);
+    atomic_init(&tedax->caixa.leitura, 0);
+    tedax->livre_desde_ns = 0;
+    tedax->ocioso_ns = 0;
+    tedax->trocas = 0;
+    tedax->deque_inicio = 0;
+    tedax->deque_qtd = 0;
+    tedax->modulos_puxados = 0;
+    tedax->modulos_roubados = 0;
+    histograma_zerar(&tedax->latencia_fila);
+    tedax->bancada_alvo = -1;
+    memset(&tedax->instrucao_atual, 0, sizeof(InstrucaoCodificada));
+    tedax->trabalho_restante_ns = 0;
+    tedax->trabalho_desde_ns = 0;
+    tedax->executor = NULL;
+    tedax->fase = FASE_BUSCAR;
+    tedax->bancada_espera = NULL;
+    memset(&tedax->espera_bancada, 0, sizeof(EsperaBancada));
     pthread_mutex_init(&tedax->mutex, NULL);
     pthread_cond_init(&tedax->cond_tarefa, NULL);
+    retrato_init(&tedax->seq_retrato, tedax->retrato, sizeof(RetratoTedax));
+    tedax_publicar(tedax);
+
+    /* Espera por bancada com timeout no relogio monotonico */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&tedax->espera_bancada.cond, &attr);
+    pthread_condattr_destroy(&attr);
 }
 
 void tedax_destroy(Tedax* tedax) {
@@ -35,54 +64,144 @@ void tedax_destroy(Tedax* tedax) {
     tedax_parar_thread(tedax);
     pthread_mutex_destroy(&tedax->mutex);
     pthread_cond_destroy(&tedax->cond_tarefa);
+    pthread_cond_destroy(&tedax->espera_bancada.cond);
 }
 
 int tedax_iniciar_thread(Tedax* tedax) {
     if (!tedax) return -1;
     tedax->ativo = true;
-    if (pthread_create(&tedax->thread, NULL, thread_tedax, tedax) != 0) {
+    if (afinidade_criar_thread(&tedax->thread, jogo ? &jogo->config : NULL, PAPEL_TEDAX, tedax->id + 1,
+                               thread_tedax, tedax) != 0) {
         tedax->ativo = false;
         return -1;
     }
     return 0;
 }
 
+static long long passo_tedax(void* arg);
+
+int tedax_iniciar_tarefa(Tedax* tedax, Executor* executor) {
+    if (!tedax || !executor) return -1;
+    tedax->ativo = true;
+    tedax->fase = FASE_BUSCAR;
+    tedax->executor = executor;
+    executor_submeter(executor, &tedax->tarefa, passo_tedax, tedax);
+    return 0;
+}
+
 void tedax_parar_thread(Tedax* tedax) {
     if (!tedax || !tedax->ativo) return;
     pthread_mutex_lock(&tedax->mutex);
     tedax->ativo = false;
     pthread_cond_signal(&tedax->cond_tarefa);
     pthread_mutex_unlock(&tedax->mutex);
-    pthread_join(tedax->thread, NULL);
+
+    if (tedax->executor) {
+        /* Modo pool: o proximo passo encerra a maquina de estados */
+        executor_acordar(tedax->executor, &tedax->tarefa);
+        executor_aguardar(tedax->executor, &tedax->tarefa);
+        tedax->executor = NULL;
+    } else {
+        /* Acorda a espera do trabalho em cond_estado */
+        if (jogo) {
+            pthread_mutex_lock(&jogo->mutex_estado);
+            pthread_cond_broadcast(&jogo->cond_estado);
+            pthread_mutex_unlock(&jogo->mutex_estado);
+        }
+        pthread_join(tedax->thread, NULL);
+    }
+}
+
+/* ==================== CAIXA DE TAREFAS ==================== */
+
+/*
+ * Anel SPSC: so o coordenador publica (escrita) e so o tedax retira
+ * (leitura, sob tedax->mutex para nao disputar com o reinicio da
+ * partida). A publicacao nao precisa do mutex; ele so protege o sinal.
+ */
+
+static unsigned caixa_quantidade(CaixaTarefas* caixa) {
+    unsigned leitura = atomic_load_explicit(&caixa->leitura, memory_order_acquire);
+    unsigned escrita = atomic_load_explicit(&caixa->escrita, memory_order_acquire);
+    return escrita - leitura;
+}
+
+/* Produtor: false se a caixa estiver cheia */
+static bool caixa_inserir(CaixaTarefas* caixa, const Designacao* designacao) {
+    unsigned escrita = atomic_load_explicit(&caixa->escrita, memory_order_relaxed);
+    unsigned leitura = atomic_load_explicit(&caixa->leitura, memory_order_acquire);
+    if (escrita - leitura >= CAPACIDADE_CAIXA_TEDAX) return false;
+    caixa->itens[escrita % CAPACIDADE_CAIXA_TEDAX] = *designacao;
+    atomic_store_explicit(&caixa->escrita, escrita + 1, memory_order_release);
+    return true;
+}
+
+/* Consumidor: retira a designacao mais antiga; false se vazia */
+static bool caixa_retirar(CaixaTarefas* caixa, Designacao* designacao) {
+    unsigned leitura = atomic_load_explicit(&caixa->leitura, memory_order_relaxed);
+    unsigned escrita = atomic_load_explicit(&caixa->escrita, memory_order_acquire);
+    if (leitura == escrita) return false;
+    *designacao = caixa->itens[leitura % CAPACIDADE_CAIXA_TEDAX];
+    atomic_store_explicit(&caixa->leitura, leitura + 1, memory_order_release);
+    return true;
+}
+
+int tedax_quantidade_caixa(Tedax* tedax) {
+    if (!tedax) return 0;
+    return (int)caixa_quantidade(&tedax->caixa);
+}
+
+void tedax_publicar(Tedax* tedax) {
+    RetratoTedax retrato = {
+        .estado = tedax->estado,
+        .desarmados = atomic_load_explicit(&tedax->modulos_desarmados, memory_order_relaxed),
+        .falhados = atomic_load_explicit(&tedax->modulos_falhados, memory_order_relaxed),
+    };
+    retrato_publicar(&tedax->seq_retrato, tedax->retrato, &retrato, sizeof(RetratoTedax));
+}
+
+int tedax_ler_retrato(Tedax* tedax, RetratoTedax* retrato) {
+    return retrato_ler(&tedax->seq_retrato, tedax->retrato, retrato, sizeof(RetratoTedax));
+}
+
+void tedax_somar_designacoes(Tedax* tedax, int* carga) {
+    if (!tedax || !carga) return;
+    /* Quem le e o produtor: os itens entre leitura e escrita nao mudam por baixo dele */
+    unsigned leitura = atomic_load_explicit(&tedax->caixa.leitura, memory_order_acquire);
+    unsigned escrita = atomic_load_explicit(&tedax->caixa.escrita, memory_order_relaxed);
+    for (unsigned i = leitura; i != escrita; i++) {
+        carga[tedax->caixa.itens[i % CAPACIDADE_CAIXA_TEDAX].bancada]++;
+    }
+}
+
+void tedax_esvaziar_caixa(Tedax* tedax) {
+    if (!tedax) return;
+    Designacao d;
+    pthread_mutex_lock(&tedax->mutex);
+    while (caixa_retirar(&tedax->caixa, &d)) pool_modulos_liberar(d.modulo);
+    pthread_mutex_unlock(&tedax->mutex);
 }
 
 bool tedax_disponivel(Tedax* tedax) {
     if (!tedax) return false;
     pthread_mutex_lock(&tedax->mutex);
-    bool disp = (tedax->estado == ESTADO_LIVRE && !tedax->tarefa_pendente);
+    bool disp = (tedax->estado == ESTADO_LIVRE && caixa_quantidade(&tedax->caixa) == 0);
     pthread_mutex_unlock(&tedax->mutex);
     return disp;
 }
 
-bool tedax_designar_modulo(Tedax* tedax, Modulo* modulo, int bancada_id, const char* instrucao) {
-    if (!tedax || !modulo || !instrucao) return false;
+bool tedax_designar_modulo(Tedax* tedax, ModuloHandle modulo, int bancada_id, const InstrucaoCodificada* instrucao) {
+    if (!tedax || modulo == MODULO_HANDLE_NULO || !instrucao) return false;
+    Designacao designacao = { .modulo = modulo, .bancada = bancada_id, .instrucao = *instrucao };
+    if (!caixa_inserir(&tedax->caixa, &designacao)) return false;
+
+    /* Sob o mutex: o tedax confere a caixa e dorme sem perder este sinal */
     pthread_mutex_lock(&tedax->mutex);
-    if (tedax->estado != ESTADO_LIVRE || tedax->tarefa_pendente) {
-        pthread_mutex_unlock(&tedax->mutex);
-        return false;
-    }
-    tedax->modulo_atual = malloc(sizeof(Modulo));
-    if (!tedax->modulo_atual) {
-        pthread_mutex_unlock(&tedax->mutex);
-        return false;
-    }
-    memcpy(tedax->modulo_atual, modulo, sizeof(Modulo));
-    tedax->bancada_designada = bancada_id;
-    strncpy(tedax->instrucao_recebida, instrucao, MAX_INSTRUCAO - 1);
-    tedax->instrucao_recebida[MAX_INSTRUCAO - 1] = '\0';
-    tedax->tarefa_pendente = true;
     pthread_cond_signal(&tedax->cond_tarefa);
+    Executor* executor = tedax->executor;
     pthread_mutex_unlock(&tedax->mutex);
+
+    if (executor) executor_acordar(executor, &tedax->tarefa);
     return true;
 }
 
@@ -99,12 +218,12 @@ const char* tedax_estado_str(Tedax* tedax) {
     }
 }
 
-bool verificar_instrucao(Modulo* modulo, const char* instrucao) {
+bool verificar_instrucao(Modulo* modulo, const InstrucaoCodificada* instrucao) {
     if (!modulo || !instrucao) return false;
-    return (strcmp(modulo->instrucao, instrucao) == 0);
+    return instrucao_conferir(&modulo->instrucao, instrucao);
 }
 
-bool tedax_resolver_modulo(Tedax* tedax, Modulo* modulo, const char* instrucao) {
+bool tedax_resolver_modulo(Tedax* tedax, Modulo* modulo, const InstrucaoCodificada* instrucao) {
     if (!tedax || !modulo || !instrucao) return false;
     bool sucesso = verificar_instrucao(modulo, instrucao);
     modulo->tentativas++;
@@ -112,122 +231,519 @@ bool tedax_resolver_modulo(Tedax* tedax, Modulo* modulo, const char* instrucao)
     return sucesso;
 }
 
-void* thread_tedax(void* arg) {
-    Tedax* tedax = (Tedax*)arg;
-    if (!tedax || !jogo) return NULL;
+/* Bancada de um modulo puxado pelo proprio tedax: a primeira que vagar */
+#define BANCADA_QUALQUER (-2)
 
-    while (tedax->ativo && jogo->executando) {
-        pthread_mutex_lock(&tedax->mutex);
-        while (!tedax->tarefa_pendente && tedax->ativo && jogo->executando) {
-            pthread_cond_wait(&tedax->cond_tarefa, &tedax->mutex);
-        }
-        if (!tedax->ativo || !jogo->executando) {
-            pthread_mutex_unlock(&tedax->mutex);
-            break;
-        }
-        
-        Modulo* modulo = tedax->modulo_atual;
-        int bancada_id = tedax->bancada_designada;
-        char instrucao[MAX_INSTRUCAO];
-        strncpy(instrucao, tedax->instrucao_recebida, MAX_INSTRUCAO);
-        
-        tedax->tarefa_pendente = false;
-        tedax->estado = ESTADO_AGUARDANDO_BANCADA;
+#define NS_POR_MS 1000000LL
+#define NS_POR_SEGUNDO 1000000000LL
+
+/*
+ * As etapas abaixo nao bloqueiam e sao compartilhadas pelos dois modos:
+ * a thread dedicada espera entre elas com cond vars, e a maquina de
+ * estados do modo pool devolve prazos ao executor.
+ */
+
+static bool partida_rodando(void) {
+    pthread_mutex_lock(&jogo->mutex_estado);
+    bool rodando = jogo->estado == JOGO_RODANDO;
+    pthread_mutex_unlock(&jogo->mutex_estado);
+    return rodando;
+}
+
+/* Retira o item mais antigo da deque (requer tedax->mutex) */
+static ModuloHandle deque_retirar(Tedax* tedax) {
+    if (tedax->deque_qtd == 0) return MODULO_HANDLE_NULO;
+    ModuloHandle h = tedax->deque[tedax->deque_inicio];
+    tedax->deque_inicio = (tedax->deque_inicio + 1) % CAPACIDADE_DEQUE_TEDAX;
+    tedax->deque_qtd--;
+    return h;
+}
+
+/* Devolve um item ao inicio da deque (requer tedax->mutex e espaco) */
+static void deque_devolver(Tedax* tedax, ModuloHandle h) {
+    tedax->deque_inicio = (tedax->deque_inicio + CAPACIDADE_DEQUE_TEDAX - 1) % CAPACIDADE_DEQUE_TEDAX;
+    tedax->deque[tedax->deque_inicio] = h;
+    tedax->deque_qtd++;
+}
+
+/* Coloca um item no fim da deque (requer tedax->mutex e espaco) */
+static void deque_inserir(Tedax* tedax, ModuloHandle h) {
+    int fim = (tedax->deque_inicio + tedax->deque_qtd) % CAPACIDADE_DEQUE_TEDAX;
+    tedax->deque[fim] = h;
+    tedax->deque_qtd++;
+}
+
+/* Soma a espera desde o fim da tarefa anterior (requer tedax->mutex) */
+static void registrar_ociosidade(Tedax* tedax) {
+    if (tedax->livre_desde_ns > 0) {
+        tedax->ocioso_ns += relogio_ns() - tedax->livre_desde_ns;
+        tedax->trocas++;
+    }
+    tedax->livre_desde_ns = 0;
+}
+
+/* Passa a designacao a trabalho atual (requer tedax->mutex) */
+static void assumir_designada(Tedax* tedax, const Designacao* designacao) {
+    tedax->modulo_atual = designacao->modulo;
+    tedax->bancada_alvo = designacao->bancada;
+    tedax->instrucao_atual = designacao->instrucao;
+    tedax->estado = ESTADO_AGUARDANDO_BANCADA;
+    registrar_ociosidade(tedax);
+    tedax_publicar(tedax);
+}
+
+/*
+ * Procura trabalho sem bloquear. A caixa de designacoes tem prioridade; no
+ * modo autonomo seguem a deque local, um lote de LOTE_PULL_TEDAX modulos
+ * da fila global (um e assumido, o resto vai para a deque, onde tedax
+ * ociosos podem rouba-lo) e o roubo do item mais antigo de outro tedax.
+ * Retorna true se assumiu um modulo (tedax->modulo_atual).
+ */
+static bool tedax_buscar_trabalho(Tedax* tedax) {
+    bool autonomo = jogo->config.tedax_autonomos;
+    Designacao designacao;
+
+    pthread_mutex_lock(&tedax->mutex);
+    if (caixa_retirar(&tedax->caixa, &designacao)) {
+        assumir_designada(tedax, &designacao);
         pthread_mutex_unlock(&tedax->mutex);
+        return true;
+    }
+    ModuloHandle handle = autonomo ? deque_retirar(tedax) : MODULO_HANDLE_NULO;
+    pthread_mutex_unlock(&tedax->mutex);
+    if (!autonomo) return false;
 
-        if (!modulo || bancada_id < 0 || bancada_id >= jogo->config.num_bancadas) {
+    bool roubado = false;
+    if (handle == MODULO_HANDLE_NULO) {
+        ModuloHandle lote[LOTE_PULL_TEDAX];
+        int n = fila_modulos_remover_lote(&jogo->fila_modulos, lote, LOTE_PULL_TEDAX);
+        if (n > 0) {
+            handle = lote[0];
             pthread_mutex_lock(&tedax->mutex);
-            tedax->estado = ESTADO_LIVRE;
-            /* SEGURO: Limpa ponteiro antes de liberar */
-            tedax->modulo_atual = NULL;
+            for (int i = 1; i < n; i++) deque_inserir(tedax, lote[i]);
+            tedax->modulos_puxados += n;
             pthread_mutex_unlock(&tedax->mutex);
-            if (modulo) free(modulo); 
-            continue;
         }
+    }
 
-        Bancada* bancada = &jogo->bancadas[bancada_id];
-        jogo_feedback(jogo, "Tedax %d aguardando bancada %d...", tedax->id + 1, bancada_id + 1);
+    if (handle == MODULO_HANDLE_NULO) {
+        for (int i = 1; i < jogo->config.num_tedax && handle == MODULO_HANDLE_NULO; i++) {
+            Tedax* vitima = &jogo->tedax[(tedax->id + i) % jogo->config.num_tedax];
+            pthread_mutex_lock(&vitima->mutex);
+            handle = deque_retirar(vitima);
+            pthread_mutex_unlock(&vitima->mutex);
+        }
+        roubado = handle != MODULO_HANDLE_NULO;
+    }
 
-        bool conseguiu_bancada = false;
-        while (!conseguiu_bancada && tedax->ativo && jogo->executando) {
-            if (bancada_ocupar(bancada, tedax->id, modulo)) {
-                conseguiu_bancada = true;
-            } else {
-                bancada_aguardar_livre(bancada, 500);
-                usleep(50000); /* Pausa para evitar starvation */
-            }
-            
-            pthread_mutex_lock(&jogo->mutex_estado);
-            EstadoJogo est = jogo->estado;
-            pthread_mutex_unlock(&jogo->mutex_estado);
-            if (est != JOGO_RODANDO) break;
+    if (handle == MODULO_HANDLE_NULO) return false;
+
+    Modulo* modulo = pool_modulos_obter(handle);
+    pthread_mutex_lock(&tedax->mutex);
+    if (roubado) tedax->modulos_roubados++;
+    if (caixa_retirar(&tedax->caixa, &designacao)) {
+        /* Designacao chegou durante a busca: ela vem primeiro */
+        deque_devolver(tedax, handle);
+        assumir_designada(tedax, &designacao);
+    } else {
+        tedax->modulo_atual = handle;
+        tedax->bancada_alvo = BANCADA_QUALQUER;
+        /* O autonomo le a instrucao do proprio modulo */
+        if (modulo) tedax->instrucao_atual = modulo->instrucao;
+        else memset(&tedax->instrucao_atual, 0, sizeof(InstrucaoCodificada));
+        tedax->estado = ESTADO_AGUARDANDO_BANCADA;
+        registrar_ociosidade(tedax);
+        tedax_publicar(tedax);
+    }
+    pthread_mutex_unlock(&tedax->mutex);
+    return true;
+}
+
+/* Valida o trabalho assumido; false se o modulo foi descartado */
+static bool tedax_preparar(Tedax* tedax) {
+    ModuloHandle handle = tedax->modulo_atual;
+    Modulo* modulo = pool_modulos_obter(handle);
+    int alvo = tedax->bancada_alvo;
+    bool valida = alvo == BANCADA_QUALQUER || (alvo >= 0 && alvo < jogo->config.num_bancadas);
+
+    if (!modulo || !valida) {
+        pthread_mutex_lock(&tedax->mutex);
+        tedax->estado = ESTADO_LIVRE;
+        /* SEGURO: Limpa handle antes de devolver ao pool */
+        tedax->modulo_atual = MODULO_HANDLE_NULO;
+        tedax_publicar(tedax);
+        pthread_mutex_unlock(&tedax->mutex);
+        pool_modulos_liberar(handle);
+        return false;
+    }
+
+    /* Latencia de fila: da entrada na fila ate um tedax assumir o modulo */
+    histograma_registrar(&tedax->latencia_fila, relogio_ns() - modulo->enfileirado_ns);
+
+    if (alvo >= 0) {
+        jogo_feedback(jogo, "Tedax %d aguardando bancada %d...", tedax->id + 1, alvo + 1);
+    }
+    return true;
+}
+
+/* Bancada em cuja fila o tedax espera: a alvo ou, no modo autonomo, a "sua" */
+static Bancada* bancada_de_espera(Tedax* tedax) {
+    if (tedax->bancada_alvo >= 0) return &jogo->bancadas[tedax->bancada_alvo];
+    return &jogo->bancadas[tedax->id % jogo->config.num_bancadas];
+}
+
+/* Bancada obtida: comeca o trabalho */
+static void tedax_comecar_trabalho(Tedax* tedax, Bancada* bancada) {
+    Modulo* modulo = pool_modulos_obter(tedax->modulo_atual);
+    pthread_mutex_lock(&tedax->mutex);
+    tedax->estado = ESTADO_OCUPADO;
+    tedax->bancada_atual = bancada;
+    tedax->trabalho_restante_ns = modulo->tempo_resolucao * NS_POR_SEGUNDO;
+    tedax->trabalho_desde_ns = 0;
+    tedax_publicar(tedax);
+    pthread_mutex_unlock(&tedax->mutex);
+
+    jogo_feedback(jogo, "Tedax %d desarmando %s na bancada %d...", tedax->id + 1, modulo->nome, bancada->id + 1);
+}
+
+/*
+ * Tenta ocupar sem esperar a bancada alvo ou, no modo autonomo, qualquer
+ * livre (comecando pela "sua" para espalhar os tedax). 'exceto' e pulada.
+ */
+static Bancada* tedax_tentar_bancada(Tedax* tedax, Bancada* exceto) {
+    ModuloHandle handle = tedax->modulo_atual;
+
+    if (tedax->bancada_alvo >= 0) {
+        Bancada* b = &jogo->bancadas[tedax->bancada_alvo];
+        return b != exceto && bancada_ocupar(b, tedax->id, handle) ? b : NULL;
+    }
+    int n = jogo->config.num_bancadas;
+    int id = mapa_bancadas_reservar(&jogo->mapa_bancadas, n, tedax->id % n, exceto ? exceto->id : -1, tedax->id,
+                                    handle);
+    return id >= 0 ? &jogo->bancadas[id] : NULL;
+}
+
+/* Entra na fila da bancada de espera; no modo pool a entrega acorda a tarefa */
+static void tedax_entrar_fila(Tedax* tedax) {
+    EsperaBancada* espera = &tedax->espera_bancada;
+    espera->tedax_id = tedax->id;
+    espera->modulo = tedax->modulo_atual;
+    espera->executor = tedax->executor;
+    espera->tarefa = tedax->executor ? &tedax->tarefa : NULL;
+    tedax->bancada_espera = bancada_de_espera(tedax);
+    bancada_entrar_fila(tedax->bancada_espera, espera);
+}
+
+/* Sai da fila; true se a bancada ja tinha sido entregue (o trabalho comeca) */
+static bool tedax_sair_fila(Tedax* tedax) {
+    Bancada* bancada = tedax->bancada_espera;
+    tedax->bancada_espera = NULL;
+    if (!bancada_sair_fila(bancada, &tedax->espera_bancada)) return false;
+    tedax_comecar_trabalho(tedax, bancada);
+    return true;
+}
+
+/*
+ * Modo autonomo, ainda na fila: se outra bancada vagou, fica com ela. Se a
+ * da fila foi entregue nesse meio tempo, ela segue para o proximo da fila.
+ */
+static bool tedax_trocar_de_bancada(Tedax* tedax) {
+    if (tedax->bancada_alvo >= 0) return false;
+    Bancada* outra = tedax_tentar_bancada(tedax, tedax->bancada_espera);
+    if (!outra) return false;
+
+    Bancada* da_fila = tedax->bancada_espera;
+    tedax->bancada_espera = NULL;
+    if (bancada_sair_fila(da_fila, &tedax->espera_bancada)) bancada_liberar(da_fila, tedax->id);
+    tedax_comecar_trabalho(tedax, outra);
+    return true;
+}
+
+/* Desiste do modulo sem trabalhar: ele volta para a fila */
+static void tedax_desistir(Tedax* tedax) {
+    ModuloHandle handle = tedax->modulo_atual;
+
+    pthread_mutex_lock(&tedax->mutex);
+    tedax->estado = ESTADO_LIVRE;
+    tedax->modulo_atual = MODULO_HANDLE_NULO;
+    tedax_publicar(tedax);
+    pthread_mutex_unlock(&tedax->mutex);
+
+    if (!fila_modulos_adicionar(&jogo->fila_modulos, handle)) {
+        pool_modulos_liberar(handle);
+    }
+}
+
+/* Resolve o modulo, libera a bancada e contabiliza */
+static void tedax_concluir(Tedax* tedax) {
+    ModuloHandle handle = tedax->modulo_atual;
+    Modulo* modulo = pool_modulos_obter(handle);
+    Bancada* bancada = tedax->bancada_atual;
+
+    bool sucesso = tedax_resolver_modulo(tedax, modulo, &tedax->instrucao_atual);
+
+    bancada_liberar(bancada, tedax->id);
+
+    pthread_mutex_lock(&tedax->mutex);
+    tedax->bancada_atual = NULL;
+    pthread_mutex_unlock(&tedax->mutex);
+
+    /* So este tedax escreve no slot: o total sai de jogo_somar_contadores */
+    atomic_fetch_add_explicit(sucesso ? &tedax->modulos_desarmados : &tedax->modulos_falhados, 1,
+                              memory_order_relaxed);
+    tedax_publicar(tedax);
+
+    /* Copia o nome: ao voltar para a fila, o modulo pode ser consumido */
+    char nome[MAX_NOME_MODULO];
+    strcpy(nome, modulo->nome);
+
+    /* SEGURANCA: Limpa handle ANTES de entrega-lo a fila ou ao pool */
+    pthread_mutex_lock(&tedax->mutex);
+    tedax->modulo_atual = MODULO_HANDLE_NULO;
+    pthread_mutex_unlock(&tedax->mutex);
+
+    if (sucesso) {
+        pool_modulos_liberar(handle);
+        jogo_feedback(jogo, "Tedax %d desarmou %s com sucesso!", tedax->id + 1, nome);
+    } else {
+        modulo->tentativas++;
+        if (!fila_modulos_adicionar(&jogo->fila_modulos, handle)) {
+            pool_modulos_liberar(handle);
         }
+        jogo_feedback(jogo, "Tedax %d FALHOU em %s! Instrucao errada.", tedax->id + 1, nome);
+    }
 
-        if (!conseguiu_bancada) {
-            fila_modulos_adicionar(&jogo->fila_modulos, modulo);
-            free(modulo);
-            
-            pthread_mutex_lock(&tedax->mutex);
-            tedax->estado = ESTADO_LIVRE;
-            tedax->modulo_atual = NULL;
-            pthread_mutex_unlock(&tedax->mutex);
+    pthread_mutex_lock(&tedax->mutex);
+    tedax->estado = ESTADO_LIVRE;
+    tedax->livre_desde_ns = relogio_ns();
+    tedax_publicar(tedax);
+    pthread_mutex_unlock(&tedax->mutex);
+}
+
+/*
+ * Fim do trabalho na bancada. So conta se o tempo de resolucao foi
+ * cumprido; cortado pelo fim da partida, a bancada e liberada e o modulo
+ * volta para a fila sem contar como desarmado nem como falha.
+ */
+static void tedax_encerrar_trabalho(Tedax* tedax) {
+    if (tedax->trabalho_restante_ns <= 0) {
+        tedax_concluir(tedax);
+        return;
+    }
+    bancada_liberar(tedax->bancada_atual, tedax->id);
+    pthread_mutex_lock(&tedax->mutex);
+    tedax->bancada_atual = NULL;
+    pthread_mutex_unlock(&tedax->mutex);
+    tedax_desistir(tedax);
+}
+
+/* Devolve a deque para a fila global (fim da partida) */
+static void tedax_esvaziar_deque(Tedax* tedax) {
+    pthread_mutex_lock(&tedax->mutex);
+    ModuloHandle restantes[CAPACIDADE_DEQUE_TEDAX];
+    int n = 0;
+    while (tedax->deque_qtd > 0) restantes[n++] = deque_retirar(tedax);
+    pthread_mutex_unlock(&tedax->mutex);
+
+    int devolvidos = fila_modulos_adicionar_lote(&jogo->fila_modulos, restantes, n);
+    for (int i = devolvidos; i < n; i++) pool_modulos_liberar(restantes[i]);
+}
+
+/* ==================== MODO THREAD ==================== */
+
+/*
+ * Espera o tempo de resolucao em cond_estado, que acorda na hora com
+ * pausa, retomada, fim de partida e parada. So o tempo com a partida
+ * rodando e descontado: a pausa congela o que falta.
+ */
+static void tedax_trabalhar(Tedax* tedax) {
+    pthread_mutex_lock(&jogo->mutex_estado);
+    while (tedax->trabalho_restante_ns > 0 && tedax->ativo && jogo->executando) {
+        if (jogo->estado == JOGO_PAUSADO) {
+            pthread_cond_wait(&jogo->cond_estado, &jogo->mutex_estado);
             continue;
         }
+        if (jogo->estado != JOGO_RODANDO) break;
 
-        pthread_mutex_lock(&tedax->mutex);
-        tedax->estado = ESTADO_OCUPADO;
-        tedax->bancada_atual = bancada;
-        pthread_mutex_unlock(&tedax->mutex);
+        long long inicio = relogio_ns();
+        struct timespec prazo = timespec_de_ns(inicio + tedax->trabalho_restante_ns);
+        pthread_cond_timedwait(&jogo->cond_estado, &jogo->mutex_estado, &prazo);
+        tedax->trabalho_restante_ns -= relogio_ns() - inicio;
+    }
+    pthread_mutex_unlock(&jogo->mutex_estado);
+}
 
-        jogo_feedback(jogo, "Tedax %d desarmando %s na bancada %d...", tedax->id + 1, modulo->nome, bancada_id + 1);
+/* Executa o trabalho assumido do inicio ao fim, bloqueando nas esperas */
+static void tedax_executar(Tedax* tedax) {
+    if (!tedax_preparar(tedax)) return;
 
-        int tempo_resolucao = modulo->tempo_resolucao;
-        for (int i = 0; i < tempo_resolucao * 10 && tedax->ativo && jogo->executando; i++) {
-            usleep(100000); 
-            pthread_mutex_lock(&jogo->mutex_estado);
-            EstadoJogo est = jogo->estado;
-            pthread_mutex_unlock(&jogo->mutex_estado);
-            if (est != JOGO_RODANDO) break;
+    /* Sem bancada livre: fila FIFO com entrega direta na liberacao */
+    Bancada* bancada = tedax_tentar_bancada(tedax, NULL);
+    bool conseguiu_bancada = bancada != NULL;
+    if (conseguiu_bancada) tedax_comecar_trabalho(tedax, bancada);
+    else tedax_entrar_fila(tedax);
+
+    int timeout_ms = tedax->bancada_alvo >= 0 ? 500 : ESPERA_AUTONOMO_MS;
+    while (!conseguiu_bancada) {
+        bool vez = bancada_aguardar_vez(tedax->bancada_espera, &tedax->espera_bancada, timeout_ms);
+        bool continuar = tedax->ativo && jogo->executando && partida_rodando();
+        if (vez || !continuar) {
+            conseguiu_bancada = tedax_sair_fila(tedax);
+            break;
         }
+        conseguiu_bancada = tedax_trocar_de_bancada(tedax);
+    }
 
-        bool sucesso = tedax_resolver_modulo(tedax, modulo, instrucao);
+    if (!conseguiu_bancada) {
+        tedax_desistir(tedax);
+        return;
+    }
 
-        bancada_liberar(bancada, tedax->id);
+    tedax_trabalhar(tedax);
+    tedax_encerrar_trabalho(tedax);
+}
 
+/* Loop de um tedax comandado pelo coordenador (tarefas designadas) */
+static void tedax_loop_designado(Tedax* tedax) {
+    while (tedax->ativo && jogo->executando) {
         pthread_mutex_lock(&tedax->mutex);
-        tedax->bancada_atual = NULL;
+        while (caixa_quantidade(&tedax->caixa) == 0 && tedax->ativo && jogo->executando) {
+            pthread_cond_wait(&tedax->cond_tarefa, &tedax->mutex);
+        }
         pthread_mutex_unlock(&tedax->mutex);
+        if (!tedax->ativo || !jogo->executando) break;
 
+        if (tedax_buscar_trabalho(tedax)) tedax_executar(tedax);
+    }
+}
+
+/* Loop de um tedax autonomo; sem trabalho, espera a fila com timeout para rever as deques vizinhas */
+static void tedax_loop_autonomo(Tedax* tedax) {
+    while (tedax->ativo && jogo->executando) {
+        /* Pausado ou fora de partida: espera o estado mudar */
         pthread_mutex_lock(&jogo->mutex_estado);
-        if (sucesso) {
-            tedax->modulos_desarmados++;
-            jogo->stats.modulos_desarmados++;
-        } else {
-            tedax->modulos_falhados++;
-            jogo->stats.modulos_falhados++;
+        while (jogo->estado != JOGO_RODANDO && tedax->ativo && jogo->executando) {
+            pthread_cond_wait(&jogo->cond_estado, &jogo->mutex_estado);
         }
         pthread_mutex_unlock(&jogo->mutex_estado);
+        if (!tedax->ativo || !jogo->executando) break;
 
-        int qtd_pendentes = fila_modulos_quantidade(&jogo->fila_modulos);
-        pthread_mutex_lock(&jogo->mutex_estado);
-        jogo->stats.modulos_pendentes = qtd_pendentes;
-        pthread_mutex_unlock(&jogo->mutex_estado);
+        if (tedax_buscar_trabalho(tedax)) tedax_executar(tedax);
+        else fila_modulos_aguardar_item(&jogo->fila_modulos, ESPERA_AUTONOMO_MS);
+    }
+    tedax_esvaziar_deque(tedax);
+}
+
+void* thread_tedax(void* arg) {
+    Tedax* tedax = (Tedax*)arg;
+    if (!tedax || !jogo) return NULL;
+
+    if (jogo->config.tedax_autonomos) tedax_loop_autonomo(tedax);
+    else tedax_loop_designado(tedax);
+
+    pool_modulos_devolver_cache();
+    return NULL;
+}
+
+/* ==================== MODO POOL ==================== */
+
+/*
+ * Um passo da maquina de estados do tedax no executor. Cada espera da
+ * thread dedicada vira um prazo: ociosidade no modo autonomo, nova
+ * tentativa de bancada e o fim do trabalho. No modo designado o tedax
+ * ocioso estaciona ate tedax_designar_modulo acorda-lo; pausado, estaciona
+ * ate jogo_pausar acorda-lo na retomada.
+ */
+static long long passo_tedax(void* arg) {
+    Tedax* tedax = (Tedax*)arg;
+    long long agora = relogio_ns();
 
-        if (sucesso) {
-            jogo_feedback(jogo, "Tedax %d desarmou %s com sucesso!", tedax->id + 1, modulo->nome);
-        } else {
-            modulo->tentativas++;
-            fila_modulos_adicionar(&jogo->fila_modulos, modulo);
-            jogo_feedback(jogo, "Tedax %d FALHOU em %s! Instrucao errada.", tedax->id + 1, modulo->nome);
+    if (!tedax->ativo || !jogo->executando) {
+        /* Encerra como a thread dedicada: largar a bancada ou concluir o trabalho */
+        if (tedax->fase == FASE_BANCADA) {
+            if (tedax->bancada_espera && tedax_sair_fila(tedax)) tedax_encerrar_trabalho(tedax);
+            else tedax_desistir(tedax);
+        } else if (tedax->fase == FASE_TRABALHO) {
+            if (tedax->trabalho_desde_ns > 0) {
+                tedax->trabalho_restante_ns -= agora - tedax->trabalho_desde_ns;
+            }
+            tedax_encerrar_trabalho(tedax);
         }
+        tedax->fase = FASE_BUSCAR;
+        if (jogo->config.tedax_autonomos) tedax_esvaziar_deque(tedax);
+        return EXECUTOR_CONCLUIDA;
+    }
 
-        /* SEGURANÇA: Limpa ponteiro ANTES de liberar memoria */
-        pthread_mutex_lock(&tedax->mutex);
-        tedax->modulo_atual = NULL;
-        tedax->estado = ESTADO_LIVRE;
-        pthread_mutex_unlock(&tedax->mutex);
+    switch (tedax->fase) {
+        case FASE_BUSCAR:
+            if (jogo->config.tedax_autonomos) {
+                if (!partida_rodando()) return EXECUTOR_ESTACIONAR;
+                if (!tedax_buscar_trabalho(tedax)) return agora + ESPERA_AUTONOMO_MS * NS_POR_MS;
+            } else if (!tedax_buscar_trabalho(tedax)) {
+                return EXECUTOR_ESTACIONAR;
+            }
+            if (!tedax_preparar(tedax)) return agora;
+            tedax->fase = FASE_BANCADA;
+            /* fall through */
 
-        free(modulo);
+        case FASE_BANCADA:
+            if (!tedax->bancada_espera) {
+                Bancada* bancada = tedax_tentar_bancada(tedax, NULL);
+                if (bancada) tedax_comecar_trabalho(tedax, bancada);
+                else tedax_entrar_fila(tedax);
+            }
+            if (tedax->bancada_espera) {
+                /* Acordado pela entrega, ou pelo prazo para rever pausa e outras bancadas */
+                bool continuar = partida_rodando();
+                bool obteve;
+                if (bancada_vez_concedida(tedax->bancada_espera, &tedax->espera_bancada) || !continuar) {
+                    obteve = tedax_sair_fila(tedax);
+                } else {
+                    obteve = tedax_trocar_de_bancada(tedax);
+                    if (!obteve) {
+                        int espera_ms = tedax->bancada_alvo >= 0 ? 500 : ESPERA_AUTONOMO_MS;
+                        return agora + espera_ms * NS_POR_MS;
+                    }
+                }
+                if (!obteve) {
+                    tedax_desistir(tedax);
+                    tedax->fase = FASE_BUSCAR;
+                    return agora;
+                }
+            }
+            tedax->fase = FASE_TRABALHO;
+            /* fall through */
+
+        case FASE_TRABALHO: {
+            /* Desconta o trecho rodado; pausado, estaciona com o restante congelado */
+            pthread_mutex_lock(&jogo->mutex_estado);
+            EstadoJogo est = jogo->estado;
+            if (tedax->trabalho_desde_ns > 0) {
+                tedax->trabalho_restante_ns -= agora - tedax->trabalho_desde_ns;
+                tedax->trabalho_desde_ns = 0;
+            }
+            bool terminou = tedax->trabalho_restante_ns <= 0 ||
+                            (est != JOGO_RODANDO && est != JOGO_PAUSADO);
+            long long prazo = EXECUTOR_ESTACIONAR;
+            if (!terminou && est == JOGO_RODANDO) {
+                tedax->trabalho_desde_ns = agora;
+                prazo = agora + tedax->trabalho_restante_ns;
+            }
+            pthread_mutex_unlock(&jogo->mutex_estado);
+            if (!terminou) return prazo;
+
+            tedax_encerrar_trabalho(tedax);
+            tedax->fase = FASE_BUSCAR;
+            return agora;
+        }
     }
-    return NULL;
-}
\ No newline at end of file
+    return agora;
+}
+
+int tedax_quantidade_deque(Tedax* tedax) {
+    if (!tedax) return 0;
+    pthread_mutex_lock(&tedax->mutex);
+    int qtd = tedax->deque_qtd;
+    pthread_mutex_unlock(&tedax->mutex);
+    return qtd;
+}